@@ -0,0 +1,336 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_pack.h"
+#include "atlas.h"
+#include "list.h"
+
+/**
+ * Bakes asset files into one pack for asset_cache_mount_pack:
+ *
+ *   bin/bake_assets <pack> <asset files...>
+ *
+ * Images are decoded to the pixel format the renderer prefers, so the game can
+ * upload them without converting; small ones are shelf-packed onto shared
+ * atlas pages. WAV sounds are converted to the game's mixer format. Fonts are
+ * stored as is. Other files (e.g. .ogg) are skipped.
+ */
+
+// images with both sides at most this size go on an atlas page
+const int SPRITE_MAX_SIZE = 768;
+const int BAKED_PAGE_SIZE = 2048;
+// baked when no renderer can be created, e.g. on a headless build machine
+const Uint32 FALLBACK_PIXEL_FORMAT = SDL_PIXELFORMAT_RGBA32;
+// must match the Mix_OpenAudio call of the engine
+const int BAKED_AUDIO_FREQ = 48000;
+const SDL_AudioFormat BAKED_AUDIO_FORMAT = AUDIO_S16LSB;
+const Uint8 BAKED_AUDIO_CHANNELS = 2;
+const size_t INITIAL_CAPACITY = 16;
+
+typedef struct baked_sprite {
+  pack_entry_t *entry;
+  SDL_Surface *surface;
+} baked_sprite_t;
+
+static FILE *OUT;
+static uint64_t OUT_OFFSET;
+static Uint32 PIXEL_FORMAT;
+
+/**
+ * Finds the first 32-bit format with alpha that a renderer like the game's
+ * takes without converting. The game still converts (through SDL) if its
+ * renderer prefers another one.
+ */
+static Uint32 renderer_pixel_format(void) {
+  Uint32 format = FALLBACK_PIXEL_FORMAT;
+  if (SDL_Init(SDL_INIT_VIDEO) != 0) {
+    return format;
+  }
+  SDL_Window *window = SDL_CreateWindow("", 0, 0, 1, 1, SDL_WINDOW_HIDDEN);
+  SDL_Renderer *renderer =
+      window ? SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED) : NULL;
+  SDL_RendererInfo info;
+  if (renderer && SDL_GetRendererInfo(renderer, &info) == 0) {
+    for (Uint32 i = 0; i < info.num_texture_formats; i++) {
+      Uint32 candidate = info.texture_formats[i];
+      if (!SDL_ISPIXELFORMAT_FOURCC(candidate) &&
+          SDL_BITSPERPIXEL(candidate) == 32 &&
+          SDL_ISPIXELFORMAT_ALPHA(candidate)) {
+        format = candidate;
+        break;
+      }
+    }
+  }
+  if (renderer) {
+    SDL_DestroyRenderer(renderer);
+  }
+  if (window) {
+    SDL_DestroyWindow(window);
+  }
+  SDL_Quit();
+  return format;
+}
+
+/**
+ * Pads the pack with zeros up to the next PACK_ALIGNMENT boundary.
+ */
+static void write_padding(void) {
+  static const uint8_t ZEROS[PACK_ALIGNMENT] = {0};
+  size_t padding = (PACK_ALIGNMENT - OUT_OFFSET % PACK_ALIGNMENT) %
+                   PACK_ALIGNMENT;
+  fwrite(ZEROS, 1, padding, OUT);
+  OUT_OFFSET += padding;
+}
+
+/**
+ * Writes a blob to the pack, starting on a PACK_ALIGNMENT boundary.
+ */
+static void write_blob(pack_entry_t *entry, const void *data, size_t size) {
+  write_padding();
+  entry->offset = OUT_OFFSET;
+  entry->size = size;
+  fwrite(data, 1, size, OUT);
+  OUT_OFFSET += size;
+}
+
+static pack_entry_t *entry_init(const char *path, pack_entry_type_t type) {
+  pack_entry_t *entry = calloc(1, sizeof(pack_entry_t));
+  assert(entry);
+  assert(strlen(path) < PACK_PATH_LEN);
+  strcpy(entry->path, path);
+  entry->type = type;
+  return entry;
+}
+
+/**
+ * Writes the pixels of a surface as the data of an image or page entry.
+ * Only the first `height` rows are written.
+ */
+static void write_pixels(pack_entry_t *entry, SDL_Surface *surface,
+                         int height) {
+  entry->format = surface->format->format;
+  entry->width = surface->w;
+  entry->height = height;
+  entry->pitch = surface->pitch;
+  SDL_LockSurface(surface);
+  write_blob(entry, surface->pixels, (size_t)surface->pitch * height);
+  SDL_UnlockSurface(surface);
+}
+
+static bool bake_image(const char *path, list_t *entries, list_t *sprites) {
+  SDL_Surface *decoded = IMG_Load(path);
+  if (decoded == NULL) {
+    return false;
+  }
+  SDL_Surface *surface =
+      SDL_ConvertSurfaceFormat(decoded, PIXEL_FORMAT, 0);
+  SDL_FreeSurface(decoded);
+  if (surface == NULL) {
+    return false;
+  }
+  if (surface->w <= SPRITE_MAX_SIZE && surface->h <= SPRITE_MAX_SIZE) {
+    // placed on a page once every image has been decoded
+    baked_sprite_t *sprite = malloc(sizeof(baked_sprite_t));
+    assert(sprite);
+    sprite->entry = entry_init(path, PACK_SPRITE);
+    sprite->surface = surface;
+    list_add(entries, sprite->entry);
+    list_add(sprites, sprite);
+    return true;
+  }
+  pack_entry_t *entry = entry_init(path, PACK_IMAGE);
+  write_pixels(entry, surface, surface->h);
+  SDL_FreeSurface(surface);
+  list_add(entries, entry);
+  return true;
+}
+
+static bool bake_sound(const char *path, list_t *entries) {
+  SDL_AudioSpec spec;
+  Uint8 *samples;
+  Uint32 num_bytes;
+  if (SDL_LoadWAV(path, &spec, &samples, &num_bytes) == NULL) {
+    return false;
+  }
+  SDL_AudioCVT cvt;
+  if (SDL_BuildAudioCVT(&cvt, spec.format, spec.channels, spec.freq,
+                        BAKED_AUDIO_FORMAT, BAKED_AUDIO_CHANNELS,
+                        BAKED_AUDIO_FREQ) < 0) {
+    SDL_FreeWAV(samples);
+    return false;
+  }
+  cvt.len = num_bytes;
+  cvt.buf = malloc((size_t)num_bytes * cvt.len_mult);
+  assert(cvt.buf);
+  memcpy(cvt.buf, samples, num_bytes);
+  SDL_FreeWAV(samples);
+  if (cvt.needed && SDL_ConvertAudio(&cvt) != 0) {
+    free(cvt.buf);
+    return false;
+  }
+  pack_entry_t *entry = entry_init(path, PACK_SOUND);
+  entry->format = BAKED_AUDIO_FORMAT;
+  entry->freq = BAKED_AUDIO_FREQ;
+  entry->channels = BAKED_AUDIO_CHANNELS;
+  write_blob(entry, cvt.buf, cvt.needed ? cvt.len_cvt : cvt.len);
+  free(cvt.buf);
+  list_add(entries, entry);
+  return true;
+}
+
+static bool bake_font(const char *path, list_t *entries) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  size_t size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  void *data = malloc(size);
+  assert(data);
+  bool read = fread(data, 1, size, file) == size;
+  fclose(file);
+  if (read) {
+    pack_entry_t *entry = entry_init(path, PACK_FONT);
+    write_blob(entry, data, size);
+    list_add(entries, entry);
+  }
+  free(data);
+  return read;
+}
+
+static int sprite_compare(const void *a, const void *b) {
+  const baked_sprite_t *sprite_a = *(baked_sprite_t *const *)a;
+  const baked_sprite_t *sprite_b = *(baked_sprite_t *const *)b;
+  return sprite_b->surface->h - sprite_a->surface->h;
+}
+
+/**
+ * Shelf-packs all sprites onto as few pages as possible, tallest first, and
+ * writes each page cropped to the rows it uses.
+ */
+static void bake_pages(list_t *sprites, list_t *entries) {
+  size_t num_sprites = list_size(sprites);
+  baked_sprite_t **sorted =
+      malloc(sizeof(baked_sprite_t *) * (num_sprites + 1));
+  assert(sorted);
+  for (size_t i = 0; i < num_sprites; i++) {
+    sorted[i] = list_get(sprites, i);
+  }
+  qsort(sorted, num_sprites, sizeof(baked_sprite_t *), sprite_compare);
+
+  size_t num_placed = 0;
+  uint32_t page_num = 0;
+  while (num_placed < num_sprites) {
+    SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(
+        0, BAKED_PAGE_SIZE, BAKED_PAGE_SIZE, 32, PIXEL_FORMAT);
+    assert(page);
+    atlas_shelf_t shelf;
+    atlas_shelf_init(&shelf, BAKED_PAGE_SIZE);
+    for (size_t i = 0; i < num_sprites; i++) {
+      baked_sprite_t *sprite = sorted[i];
+      SDL_Rect src;
+      if (sprite->surface == NULL ||
+          !atlas_shelf_place(&shelf, sprite->surface->w, sprite->surface->h,
+                             &src)) {
+        continue;
+      }
+      SDL_SetSurfaceBlendMode(sprite->surface, SDL_BLENDMODE_NONE);
+      SDL_BlitSurface(sprite->surface, NULL, page, &src);
+      SDL_FreeSurface(sprite->surface);
+      sprite->surface = NULL;
+      sprite->entry->width = src.w;
+      sprite->entry->height = src.h;
+      sprite->entry->page = page_num;
+      sprite->entry->x = src.x;
+      sprite->entry->y = src.y;
+      num_placed++;
+    }
+    char name[PACK_PATH_LEN];
+    asset_pack_page_name(name, page_num);
+    pack_entry_t *entry = entry_init(name, PACK_ATLAS_PAGE);
+    write_pixels(entry, page, atlas_shelf_used_height(&shelf));
+    list_add(entries, entry);
+    SDL_FreeSurface(page);
+    page_num++;
+  }
+  free(sorted);
+}
+
+static int entry_compare(const void *a, const void *b) {
+  return strncmp(((const pack_entry_t *)a)->path,
+                 ((const pack_entry_t *)b)->path, PACK_PATH_LEN);
+}
+
+static bool has_extension(const char *path, const char *extension) {
+  size_t path_len = strlen(path);
+  size_t ext_len = strlen(extension);
+  return path_len >= ext_len &&
+         strcmp(path + path_len - ext_len, extension) == 0;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <pack> <asset files...>\n", argv[0]);
+    return 1;
+  }
+  OUT = fopen(argv[1], "wb");
+  if (OUT == NULL) {
+    fprintf(stderr, "could not open %s\n", argv[1]);
+    return 1;
+  }
+  pack_header_t header = {.version = PACK_VERSION};
+  memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+  fwrite(&header, sizeof(header), 1, OUT);
+  OUT_OFFSET = sizeof(header);
+  PIXEL_FORMAT = renderer_pixel_format();
+  printf("baking images as %s\n", SDL_GetPixelFormatName(PIXEL_FORMAT));
+
+  list_t *entries = list_init(INITIAL_CAPACITY, free);
+  list_t *sprites = list_init(INITIAL_CAPACITY, free);
+  for (int i = 2; i < argc; i++) {
+    const char *path = argv[i];
+    bool baked;
+    if (has_extension(path, ".png") || has_extension(path, ".jpeg") ||
+        has_extension(path, ".jpg")) {
+      baked = bake_image(path, entries, sprites);
+    } else if (has_extension(path, ".wav")) {
+      baked = bake_sound(path, entries);
+    } else if (has_extension(path, ".ttf")) {
+      baked = bake_font(path, entries);
+    } else {
+      printf("skipping %s\n", path);
+      continue;
+    }
+    if (!baked) {
+      fprintf(stderr, "could not bake %s: %s\n", path, SDL_GetError());
+    }
+  }
+  bake_pages(sprites, entries);
+  list_free(sprites);
+
+  // the index is sorted so the game can binary search it
+  size_t num_entries = list_size(entries);
+  pack_entry_t *index = malloc(sizeof(pack_entry_t) * (num_entries + 1));
+  assert(index);
+  for (size_t i = 0; i < num_entries; i++) {
+    index[i] = *(pack_entry_t *)list_get(entries, i);
+  }
+  qsort(index, num_entries, sizeof(pack_entry_t), entry_compare);
+  write_padding();
+  header.num_entries = num_entries;
+  header.index_offset = OUT_OFFSET;
+  fwrite(index, sizeof(pack_entry_t), num_entries, OUT);
+  fseek(OUT, 0, SEEK_SET);
+  fwrite(&header, sizeof(header), 1, OUT);
+  fclose(OUT);
+  printf("baked %zu entries into %s\n", num_entries, argv[1]);
+
+  free(index);
+  list_free(entries);
+  return 0;
+}
@@ -0,0 +1,197 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine.h"
+#include "game.h"
+#include "profile.h"
+#include "rng.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
+/**
+ * Plays many headless games at once, one per core at a time, with bots at
+ * the keys, and reports how many frames they simulated per second:
+ *
+ *   bin/batch_sim [games] [max ticks per game] [seed]
+ *
+ * Odd numbered games are two player games. A game ends at its game over
+ * screen or after the maximum number of ticks.
+ */
+
+const vector_t BATCH_MIN = {0, 0};
+const vector_t BATCH_MAX = {1000, 500};
+const double BATCH_DT = 1.0 / 60;
+const size_t DEFAULT_NUM_GAMES = 64;
+const size_t DEFAULT_MAX_TICKS = 20000;
+const uint64_t DEFAULT_SEED = 1;
+// written in profiling builds
+const char *BATCH_TRACE_PATH = "batch_sim.json";
+// how many ticks a bot keeps doing what it chose
+const size_t BOT_DECISION_TICKS = 15;
+// a bot either lets go of the keys, or holds its left or right key
+#define NUM_BOT_MOVES 3
+#define MAX_BOTS 2
+const char BOT_KEYS[MAX_BOTS][NUM_BOT_MOVES] = {{'\0', LEFT_ARROW, RIGHT_ARROW},
+                                                {'\0', 'a', 'd'}};
+
+/**
+ * A random walk over the keys of one player.
+ */
+typedef struct bot {
+  rng_t rng;
+  size_t player;
+  // the key held, or '\0' for none
+  char key;
+  size_t held_ticks;
+} bot_t;
+
+/**
+ * The games of the batch, which the workers take one at a time.
+ */
+typedef struct batch {
+  size_t num_games;
+  size_t max_ticks;
+  uint64_t seed;
+  SDL_atomic_t next_game;
+} batch_t;
+
+typedef struct worker {
+  batch_t *batch;
+  SDL_Thread *thread;
+  size_t games;
+  size_t games_over;
+  uint64_t ticks;
+  int64_t score;
+} worker_t;
+
+static void bot_init(bot_t *bot, size_t player, uint64_t seed) {
+  rng_seed(&bot->rng, seed, player + 1);
+  bot->player = player;
+  bot->key = '\0';
+  bot->held_ticks = 0;
+}
+
+/**
+ * Presses the bot's key for this tick, choosing a new one every
+ * BOT_DECISION_TICKS ticks.
+ */
+static void bot_tick(bot_t *bot, state_t *state, size_t tick) {
+  if (tick % BOT_DECISION_TICKS == 0) {
+    char key = BOT_KEYS[bot->player][rng_below(&bot->rng, NUM_BOT_MOVES)];
+    if (key != bot->key) {
+      if (bot->key != '\0') {
+        game_key(state, bot->key, KEY_RELEASED, bot->held_ticks * BATCH_DT);
+      }
+      bot->key = key;
+      bot->held_ticks = 0;
+    }
+  }
+  if (bot->key != '\0') {
+    game_key(state, bot->key, KEY_PRESSED, bot->held_ticks * BATCH_DT);
+    bot->held_ticks++;
+  }
+}
+
+/**
+ * Plays one game to its end on a fresh headless engine.
+ */
+static void play_game(worker_t *worker, size_t game) {
+  PROFILE_FUNCTION();
+  batch_t *batch = worker->batch;
+  uint64_t seed = batch->seed + game;
+  engine_t *engine = engine_init_headless(BATCH_MIN, BATCH_MAX, BATCH_DT);
+  state_t *state = game_init(engine, seed);
+  size_t num_bots = game % 2 == 1 ? 2 : 1;
+  game_start(state, num_bots == 2);
+  // starting the game is setup too
+  ALLOC_FRAME_RESET();
+  bot_t bots[MAX_BOTS];
+  for (size_t b = 0; b < num_bots; b++) {
+    bot_init(&bots[b], b, seed);
+  }
+
+  size_t tick = 0;
+  while (tick < batch->max_ticks && !game_is_over(state)) {
+    for (size_t b = 0; b < num_bots; b++) {
+      bot_tick(&bots[b], state, tick);
+    }
+    emscripten_main(state);
+    tick++;
+  }
+
+  worker->games++;
+  worker->games_over += game_is_over(state);
+  worker->ticks += tick;
+  worker->score += game_get_score(state);
+  game_free(state);
+  engine_free(engine);
+}
+
+static int worker_run(void *aux) {
+  worker_t *worker = aux;
+  size_t game;
+  while ((game = (size_t)SDL_AtomicAdd(&worker->batch->next_game, 1)) <
+         worker->batch->num_games) {
+    play_game(worker, game);
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  batch_t batch = {.num_games = DEFAULT_NUM_GAMES,
+                   .max_ticks = DEFAULT_MAX_TICKS,
+                   .seed = DEFAULT_SEED};
+  if (argc > 1) {
+    batch.num_games = strtoul(argv[1], NULL, 10);
+  }
+  if (argc > 2) {
+    batch.max_ticks = strtoul(argv[2], NULL, 10);
+  }
+  if (argc > 3) {
+    batch.seed = strtoull(argv[3], NULL, 10);
+  }
+  if (argc > 4 || batch.num_games == 0 || batch.max_ticks == 0) {
+    fprintf(stderr, "usage: %s [games] [max ticks per game] [seed]\n",
+            argv[0]);
+    return 1;
+  }
+  SDL_AtomicSet(&batch.next_game, 0);
+
+  size_t num_workers = SDL_GetCPUCount();
+  if (num_workers > batch.num_games) {
+    num_workers = batch.num_games;
+  }
+  worker_t *workers = calloc(num_workers, sizeof(worker_t));
+  assert(workers);
+  Uint64 start = SDL_GetPerformanceCounter();
+  for (size_t i = 0; i < num_workers; i++) {
+    workers[i].batch = &batch;
+    workers[i].thread = SDL_CreateThread(worker_run, "batch_sim", &workers[i]);
+    assert(workers[i].thread != NULL);
+  }
+
+  worker_t total = {0};
+  for (size_t i = 0; i < num_workers; i++) {
+    SDL_WaitThread(workers[i].thread, NULL);
+    total.games += workers[i].games;
+    total.games_over += workers[i].games_over;
+    total.ticks += workers[i].ticks;
+    total.score += workers[i].score;
+  }
+  double seconds = (double)(SDL_GetPerformanceCounter() - start) /
+                   SDL_GetPerformanceFrequency();
+  free(workers);
+
+  printf("%zu games on %zu threads: %zu over, %zu hit the tick limit\n",
+         total.games, num_workers, total.games_over,
+         total.games - total.games_over);
+  printf("%llu ticks in %.3f s: %.0f ticks/s\n",
+         (unsigned long long)total.ticks, seconds, total.ticks / seconds);
+  printf("mean score %.1f\n", (double)total.score / total.games);
+  PROFILE_WRITE(BATCH_TRACE_PATH);
+  ALLOC_REPORT(stdout);
+  return 0;
+}
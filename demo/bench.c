@@ -0,0 +1,675 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "asset_cache.h"
+#include "body.h"
+#include "collision.h"
+#include "engine.h"
+#include "forces.h"
+#include "list.h"
+#include "polygon.h"
+#include "rng.h"
+#include "scene.h"
+#include "vector.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
+#ifndef ALLOC_TRACK
+#error "bench reports allocations per op; build it with -DALLOC_TRACK"
+#endif
+
+/**
+ * Times the engine's hot paths and writes how long each op took and how many
+ * allocations it made as JSON:
+ *
+ *   bin/bench [results] [baseline]
+ *
+ * The results go to bench.json unless given. If a baseline (results saved
+ * from an earlier run) is given, any benchmark that got more than
+ * BENCH_TIME_TOLERANCE slower or allocates more than before is flagged, and
+ * the exit status is 1. Setting BENCH_FILTER runs only the benchmarks whose
+ * names contain it.
+ */
+
+const char *BENCH_DEFAULT_RESULTS = "bench.json";
+const char *BENCH_FILTER_ENV = "BENCH_FILTER";
+// how long each benchmark runs for, after it is calibrated
+const double BENCH_MIN_SECONDS = 0.2;
+// how much slower than the baseline a benchmark may get unflagged
+const double BENCH_TIME_TOLERANCE = 0.1;
+// how many more allocations per op than the baseline a benchmark may make
+const double BENCH_ALLOC_TOLERANCE = 1e-3;
+const double BENCH_NS_PER_S = 1e9;
+#define BENCH_NAME_SIZE 64
+#define BENCH_LINE_SIZE 256
+
+// the items a list is filled with before starting over
+const size_t BENCH_LIST_CHUNK = 1 << 16;
+// the vectors the vector ops cycle through, a power of two
+#define BENCH_NUM_VECTORS 1024
+const uint64_t BENCH_SEED = 1;
+
+// the shapes of the game, at the sizes it uses
+const double BENCH_TILE_WIDTH = 100;
+const double BENCH_TILE_HEIGHT = 30;
+const double BENCH_OVAL_RADIUS = 50;
+const size_t BENCH_OVAL_POINTS = 200;
+const double BENCH_BULLET_RADIUS = 10;
+const size_t BENCH_BULLET_POINTS = 16;
+const double BENCH_ROTATE_ANGLE = 1e-3;
+
+const double BENCH_DT = 1.0 / 60;
+const double BENCH_DRAG = 0.1;
+const double BENCH_BODY_SPACING = 20;
+const double BENCH_BODY_SPEED = 100;
+const double BENCH_BODY_MASS = 1;
+const rgb_color_t BENCH_COLOR = {0, 0, 1};
+
+const vector_t BENCH_MIN = {0, 0};
+const vector_t BENCH_MAX = {1000, 500};
+// every image of the game, looked up by path as the renderer does
+const char *BENCH_ASSET_PATHS[] = {
+    "assets/background.png", "assets/beaver.png",       "assets/beaver_1.png",
+    "assets/beaver_2.png",   "assets/bullet.png",       "assets/button_1.png",
+    "assets/button_2.png",   "assets/invader.png",      "assets/rocket.png",
+    "assets/score_window.png", "assets/shield_image.png",
+    "assets/shield_window.png", "assets/tile-break.png", "assets/tile-move.png",
+    "assets/tile-rocket.png", "assets/tile-spring.png", "assets/tile.png"};
+const size_t BENCH_NUM_ASSETS =
+    sizeof(BENCH_ASSET_PATHS) / sizeof(*BENCH_ASSET_PATHS);
+
+/**
+ * One benchmark. `run` does `ops` ops on what `setup` made; only the time
+ * and allocations between bench_start and bench_stop count.
+ */
+typedef struct bench {
+  const char *name;
+  // may be NULL, in which case run gets `param` cast to a pointer
+  void *(*setup)(size_t param);
+  void (*run)(void *aux, size_t ops);
+  // may be NULL
+  void (*teardown)(void *aux);
+  size_t param;
+} bench_t;
+
+typedef struct bench_result {
+  char name[BENCH_NAME_SIZE];
+  size_t ops;
+  double ns_per_op;
+  double allocs_per_op;
+} bench_result_t;
+
+// keeps the compiler from dropping results nobody reads
+static volatile double BENCH_SINK;
+
+// what the list benchmarks fill their lists with, since lists hold no NULLs
+static int BENCH_ITEM;
+
+static uint64_t TIMER_START;
+static uint64_t TIMER_TICKS;
+static size_t TIMER_START_ALLOCS;
+static size_t TIMER_ALLOCS;
+
+/**
+ * Starts counting time and allocations toward the running benchmark.
+ */
+static void bench_start(void) {
+  TIMER_START_ALLOCS = alloc_track_frame_allocs();
+  TIMER_START = SDL_GetPerformanceCounter();
+}
+
+/**
+ * Stops counting, e.g. while a benchmark refills what it works on.
+ */
+static void bench_stop(void) {
+  TIMER_TICKS += SDL_GetPerformanceCounter() - TIMER_START;
+  TIMER_ALLOCS += alloc_track_frame_allocs() - TIMER_START_ALLOCS;
+}
+
+static list_t *bench_tile(vector_t center, double width, double height) {
+  list_t *points = list_init(4, free);
+  vector_t corners[4] = {{center.x - width / 2, center.y - height / 2},
+                         {center.x + width / 2, center.y - height / 2},
+                         {center.x + width / 2, center.y + height / 2},
+                         {center.x - width / 2, center.y + height / 2}};
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *point = malloc(sizeof(vector_t));
+    assert(point);
+    *point = corners[i];
+    list_add(points, point);
+  }
+  return points;
+}
+
+static list_t *bench_circle(vector_t center, double radius,
+                            size_t num_points) {
+  list_t *points = list_init(num_points, free);
+  for (size_t i = 0; i < num_points; i++) {
+    double angle = 2 * M_PI * i / num_points;
+    vector_t *point = malloc(sizeof(vector_t));
+    assert(point);
+    *point = (vector_t){center.x + radius * cos(angle),
+                        center.y + radius * sin(angle)};
+    list_add(points, point);
+  }
+  return points;
+}
+
+static void bench_list_add(void *aux, size_t ops) {
+  for (size_t done = 0; done < ops; done += BENCH_LIST_CHUNK) {
+    size_t chunk = ops - done < BENCH_LIST_CHUNK ? ops - done : BENCH_LIST_CHUNK;
+    list_t *list = list_init(1, NULL);
+    for (size_t i = 0; i < chunk; i++) {
+      list_add(list, &BENCH_ITEM);
+    }
+    list_free(list);
+  }
+}
+
+static void bench_list_remove(void *aux, size_t ops) {
+  list_t *list = list_init(BENCH_LIST_CHUNK, NULL);
+  for (size_t done = 0; done < ops; done += BENCH_LIST_CHUNK) {
+    size_t chunk = ops - done < BENCH_LIST_CHUNK ? ops - done : BENCH_LIST_CHUNK;
+    bench_stop();
+    for (size_t i = 0; i < chunk; i++) {
+      list_add(list, &BENCH_ITEM);
+    }
+    bench_start();
+    while (list_size(list) > 0) {
+      list_remove(list, list_size(list) - 1);
+    }
+  }
+  list_free(list);
+}
+
+static void *bench_vectors_init(size_t param) {
+  vector_t *vectors = malloc(sizeof(vector_t) * BENCH_NUM_VECTORS);
+  assert(vectors);
+  rng_t rng;
+  rng_seed(&rng, BENCH_SEED, 0);
+  for (size_t i = 0; i < BENCH_NUM_VECTORS; i++) {
+    vectors[i] = (vector_t){rng_double(&rng) - 0.5, rng_double(&rng) - 0.5};
+  }
+  return vectors;
+}
+
+static void bench_vec_add(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < ops; i++) {
+    sum = vec_add(sum, vectors[i % BENCH_NUM_VECTORS]);
+  }
+  BENCH_SINK = sum.x + sum.y;
+}
+
+static void bench_vec_subtract(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < ops; i++) {
+    sum = vec_subtract(sum, vectors[i % BENCH_NUM_VECTORS]);
+  }
+  BENCH_SINK = sum.x + sum.y;
+}
+
+static void bench_vec_multiply(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < ops; i++) {
+    sum = vec_add(sum, vec_multiply(0.5, vectors[i % BENCH_NUM_VECTORS]));
+  }
+  BENCH_SINK = sum.x + sum.y;
+}
+
+static void bench_vec_dot(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  double sum = 0;
+  for (size_t i = 0; i < ops; i++) {
+    sum += vec_dot(vectors[i % BENCH_NUM_VECTORS],
+                   vectors[(i + 1) % BENCH_NUM_VECTORS]);
+  }
+  BENCH_SINK = sum;
+}
+
+static void bench_vec_cross(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  double sum = 0;
+  for (size_t i = 0; i < ops; i++) {
+    sum += vec_cross(vectors[i % BENCH_NUM_VECTORS],
+                     vectors[(i + 1) % BENCH_NUM_VECTORS]);
+  }
+  BENCH_SINK = sum;
+}
+
+static void bench_vec_rotate(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  vector_t sum = VEC_ZERO;
+  for (size_t i = 0; i < ops; i++) {
+    sum = vec_add(sum, vec_rotate(vectors[i % BENCH_NUM_VECTORS],
+                                  BENCH_ROTATE_ANGLE * i));
+  }
+  BENCH_SINK = sum.x + sum.y;
+}
+
+static void bench_vec_get_length(void *aux, size_t ops) {
+  vector_t *vectors = aux;
+  double sum = 0;
+  for (size_t i = 0; i < ops; i++) {
+    sum += vec_get_length(vectors[i % BENCH_NUM_VECTORS]);
+  }
+  BENCH_SINK = sum;
+}
+
+/**
+ * @param param the number of points: 4 makes a tile, more make a circle
+ */
+static void *bench_polygon_init(size_t param) {
+  list_t *points = param == 4
+                       ? bench_tile(VEC_ZERO, BENCH_TILE_WIDTH,
+                                    BENCH_TILE_HEIGHT)
+                       : bench_circle(VEC_ZERO, BENCH_OVAL_RADIUS, param);
+  return polygon_init(points, VEC_ZERO, 0, BENCH_COLOR.r, BENCH_COLOR.g,
+                      BENCH_COLOR.b);
+}
+
+static void bench_polygon_centroid(void *aux, size_t ops) {
+  double sum = 0;
+  for (size_t i = 0; i < ops; i++) {
+    vector_t centroid = polygon_centroid(aux);
+    sum += centroid.x + centroid.y;
+  }
+  BENCH_SINK = sum;
+}
+
+static void bench_polygon_rotate(void *aux, size_t ops) {
+  for (size_t i = 0; i < ops; i++) {
+    polygon_rotate(aux, BENCH_ROTATE_ANGLE, VEC_ZERO);
+  }
+}
+
+typedef enum { BENCH_TILE, BENCH_OVAL, BENCH_BULLET } bench_shape_t;
+
+/**
+ * Two bodies whose collision is checked.
+ */
+typedef struct bench_pair {
+  body_t *body1;
+  body_t *body2;
+} bench_pair_t;
+
+static body_t *bench_body(bench_shape_t shape, vector_t center) {
+  list_t *points;
+  switch (shape) {
+  case BENCH_TILE:
+    points = bench_tile(center, BENCH_TILE_WIDTH, BENCH_TILE_HEIGHT);
+    break;
+  case BENCH_OVAL:
+    points = bench_circle(center, BENCH_OVAL_RADIUS, BENCH_OVAL_POINTS);
+    break;
+  default:
+    points = bench_circle(center, BENCH_BULLET_RADIUS, BENCH_BULLET_POINTS);
+    break;
+  }
+  return body_init(points, BENCH_BODY_MASS, BENCH_COLOR);
+}
+
+// the pairs whose collision is checked; all but the last overlap
+enum {
+  BENCH_TILE_OVAL,
+  BENCH_TILE_BULLET,
+  BENCH_OVAL_BULLET,
+  BENCH_TILE_OVAL_APART
+};
+
+/**
+ * @param param which pair to make; the second body sits on top of the first
+ */
+static void *bench_pair_init(size_t param) {
+  bench_pair_t *pair = malloc(sizeof(bench_pair_t));
+  assert(pair);
+  switch (param) {
+  case BENCH_TILE_OVAL:
+    pair->body1 = bench_body(BENCH_TILE, VEC_ZERO);
+    pair->body2 = bench_body(BENCH_OVAL, (vector_t){0, BENCH_OVAL_RADIUS});
+    break;
+  case BENCH_TILE_BULLET:
+    pair->body1 = bench_body(BENCH_TILE, VEC_ZERO);
+    pair->body2 = bench_body(BENCH_BULLET, (vector_t){0, BENCH_BULLET_RADIUS});
+    break;
+  case BENCH_OVAL_BULLET:
+    pair->body1 = bench_body(BENCH_OVAL, VEC_ZERO);
+    pair->body2 = bench_body(BENCH_BULLET, (vector_t){0, BENCH_OVAL_RADIUS});
+    break;
+  default:
+    pair->body1 = bench_body(BENCH_TILE, VEC_ZERO);
+    pair->body2 = bench_body(BENCH_OVAL, (vector_t){0, 4 * BENCH_OVAL_RADIUS});
+    break;
+  }
+  return pair;
+}
+
+static void bench_pair_free(bench_pair_t *pair) {
+  body_free(pair->body1);
+  body_free(pair->body2);
+  free(pair);
+}
+
+static void bench_find_collision(void *aux, size_t ops) {
+  bench_pair_t *pair = aux;
+  size_t collided = 0;
+  for (size_t i = 0; i < ops; i++) {
+    collided += find_collision(pair->body1, pair->body2).collided;
+  }
+  BENCH_SINK = collided;
+}
+
+/**
+ * A scene of moving bodies on a grid, each slowed by a drag force creator.
+ *
+ * @param param the number of bodies
+ */
+static void *bench_scene_init(size_t param) {
+  scene_t *scene = scene_init();
+  size_t columns = ceil(sqrt(param));
+  rng_t rng;
+  rng_seed(&rng, BENCH_SEED, 0);
+  for (size_t i = 0; i < param; i++) {
+    vector_t center = {(i % columns) * BENCH_BODY_SPACING,
+                       (i / columns) * BENCH_BODY_SPACING};
+    body_t *body = bench_body(BENCH_BULLET, center);
+    double angle = 2 * M_PI * rng_double(&rng);
+    body_set_velocity(body, vec_multiply(BENCH_BODY_SPEED,
+                                         (vector_t){cos(angle), sin(angle)}));
+    scene_add_body(scene, body);
+    create_drag(scene, BENCH_DRAG, body);
+  }
+  return scene;
+}
+
+static void bench_scene_tick(void *aux, size_t ops) {
+  for (size_t i = 0; i < ops; i++) {
+    scene_tick(aux, BENCH_DT);
+  }
+}
+
+// started by the first asset benchmark and left running, since the engine
+// can't be started twice
+static engine_t *BENCH_ENGINE = NULL;
+
+/**
+ * Starts a windowed engine on SDL's dummy drivers and loads every image, so
+ * lookups find them resident.
+ */
+static void *bench_assets_init(size_t param) {
+  if (BENCH_ENGINE == NULL) {
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    BENCH_ENGINE = engine_init(BENCH_MIN, BENCH_MAX);
+    for (size_t i = 0; i < BENCH_NUM_ASSETS; i++) {
+      asset_cache_obj_get_or_create(ASSET_IMAGE, BENCH_ASSET_PATHS[i]);
+    }
+  }
+  return BENCH_ENGINE;
+}
+
+static void bench_asset_lookup_first(void *aux, size_t ops) {
+  for (size_t i = 0; i < ops; i++) {
+    BENCH_SINK = (size_t)asset_cache_obj_get_or_create(ASSET_IMAGE,
+                                                       BENCH_ASSET_PATHS[0]);
+  }
+}
+
+static void bench_asset_lookup_last(void *aux, size_t ops) {
+  const char *path = BENCH_ASSET_PATHS[BENCH_NUM_ASSETS - 1];
+  for (size_t i = 0; i < ops; i++) {
+    BENCH_SINK = (size_t)asset_cache_obj_get_or_create(ASSET_IMAGE, path);
+  }
+}
+
+static void bench_asset_acquire_release(void *aux, size_t ops) {
+  for (size_t i = 0; i < ops; i++) {
+    asset_cache_release_sprite(
+        asset_cache_acquire_sprite(BENCH_ASSET_PATHS[i % BENCH_NUM_ASSETS]));
+  }
+}
+
+const bench_t BENCHES[] = {
+    {"list_add", NULL, bench_list_add, NULL, 0},
+    {"list_remove", NULL, bench_list_remove, NULL, 0},
+    {"vec_add", bench_vectors_init, bench_vec_add, free, 0},
+    {"vec_subtract", bench_vectors_init, bench_vec_subtract, free, 0},
+    {"vec_multiply", bench_vectors_init, bench_vec_multiply, free, 0},
+    {"vec_dot", bench_vectors_init, bench_vec_dot, free, 0},
+    {"vec_cross", bench_vectors_init, bench_vec_cross, free, 0},
+    {"vec_rotate", bench_vectors_init, bench_vec_rotate, free, 0},
+    {"vec_get_length", bench_vectors_init, bench_vec_get_length, free, 0},
+    {"polygon_centroid/tile", bench_polygon_init, bench_polygon_centroid,
+     (void (*)(void *))polygon_free, 4},
+    {"polygon_centroid/oval", bench_polygon_init, bench_polygon_centroid,
+     (void (*)(void *))polygon_free, 200},
+    {"polygon_rotate/tile", bench_polygon_init, bench_polygon_rotate,
+     (void (*)(void *))polygon_free, 4},
+    {"polygon_rotate/oval", bench_polygon_init, bench_polygon_rotate,
+     (void (*)(void *))polygon_free, 200},
+    {"find_collision/tile_oval", bench_pair_init, bench_find_collision,
+     (void (*)(void *))bench_pair_free, BENCH_TILE_OVAL},
+    {"find_collision/tile_bullet", bench_pair_init, bench_find_collision,
+     (void (*)(void *))bench_pair_free, BENCH_TILE_BULLET},
+    {"find_collision/oval_bullet", bench_pair_init, bench_find_collision,
+     (void (*)(void *))bench_pair_free, BENCH_OVAL_BULLET},
+    {"find_collision/tile_oval_apart", bench_pair_init, bench_find_collision,
+     (void (*)(void *))bench_pair_free, BENCH_TILE_OVAL_APART},
+    {"scene_tick/10", bench_scene_init, bench_scene_tick,
+     (void (*)(void *))scene_free, 10},
+    {"scene_tick/100", bench_scene_init, bench_scene_tick,
+     (void (*)(void *))scene_free, 100},
+    {"scene_tick/1000", bench_scene_init, bench_scene_tick,
+     (void (*)(void *))scene_free, 1000},
+    {"scene_tick/10000", bench_scene_init, bench_scene_tick,
+     (void (*)(void *))scene_free, 10000},
+    {"scene_tick/100000", bench_scene_init, bench_scene_tick,
+     (void (*)(void *))scene_free, 100000},
+    // last, since they leave the engine running
+    {"asset_lookup/first", bench_assets_init, bench_asset_lookup_first, NULL,
+     0},
+    {"asset_lookup/last", bench_assets_init, bench_asset_lookup_last, NULL, 0},
+    {"asset_acquire_release", bench_assets_init, bench_asset_acquire_release,
+     NULL, 0}};
+const size_t NUM_BENCHES = sizeof(BENCHES) / sizeof(*BENCHES);
+
+/**
+ * Runs `ops` ops of a benchmark.
+ *
+ * @return the seconds they took
+ */
+static double bench_run_ops(const bench_t *bench, void *aux, size_t ops) {
+  TIMER_TICKS = 0;
+  TIMER_ALLOCS = 0;
+  bench_start();
+  bench->run(aux, ops);
+  bench_stop();
+  return (double)TIMER_TICKS / SDL_GetPerformanceFrequency();
+}
+
+/**
+ * Runs a benchmark with more and more ops until it takes at least
+ * BENCH_MIN_SECONDS.
+ */
+static bench_result_t bench_run(const bench_t *bench) {
+  void *aux = bench->setup != NULL ? bench->setup(bench->param)
+                                   : (void *)bench->param;
+  size_t ops = 1;
+  double seconds = bench_run_ops(bench, aux, ops);
+  while (seconds < BENCH_MIN_SECONDS) {
+    // aim a bit past the target, but grow at most 100x per round
+    double scale = seconds > 0 ? 1.2 * BENCH_MIN_SECONDS / seconds : 100;
+    size_t next = ops * (scale < 100 ? scale : 100);
+    ops = next > ops ? next : ops + 1;
+    seconds = bench_run_ops(bench, aux, ops);
+  }
+  if (bench->teardown != NULL) {
+    bench->teardown(aux);
+  }
+
+  bench_result_t result = {.ops = ops,
+                           .ns_per_op = seconds * BENCH_NS_PER_S / ops,
+                           .allocs_per_op = (double)TIMER_ALLOCS / ops};
+  snprintf(result.name, BENCH_NAME_SIZE, "%s", bench->name);
+  return result;
+}
+
+static bool bench_write(const char *path, bench_result_t *results,
+                        size_t num_results) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return false;
+  }
+  fprintf(file, "{\"benchmarks\": [");
+  for (size_t i = 0; i < num_results; i++) {
+    // one benchmark per line, which bench_read relies on
+    fprintf(file,
+            "%s\n  {\"name\": \"%s\", \"ops\": %zu, \"ns_per_op\": %.4f, "
+            "\"allocs_per_op\": %.6f}",
+            i == 0 ? "" : ",", results[i].name, results[i].ops,
+            results[i].ns_per_op, results[i].allocs_per_op);
+  }
+  fprintf(file, "\n]}\n");
+  return fclose(file) == 0;
+}
+
+/**
+ * Reads the number after `"key": ` in a line of results.
+ *
+ * @return whether the line had the key
+ */
+static bool bench_read_number(const char *line, const char *key,
+                              double *value) {
+  char pattern[BENCH_NAME_SIZE];
+  snprintf(pattern, BENCH_NAME_SIZE, "\"%s\": ", key);
+  const char *found = strstr(line, pattern);
+  if (found == NULL) {
+    return false;
+  }
+  *value = strtod(found + strlen(pattern), NULL);
+  return true;
+}
+
+/**
+ * Reads results written by bench_write.
+ *
+ * @return the results, or NULL if the file could not be read; the caller
+ *   frees the list
+ */
+static list_t *bench_read(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return NULL;
+  }
+  list_t *results = list_init(NUM_BENCHES, free);
+  char line[BENCH_LINE_SIZE];
+  while (fgets(line, BENCH_LINE_SIZE, file) != NULL) {
+    const char *name = strstr(line, "\"name\": \"");
+    if (name == NULL) {
+      continue;
+    }
+    name += strlen("\"name\": \"");
+    const char *name_end = strchr(name, '"');
+    bench_result_t *result = malloc(sizeof(bench_result_t));
+    assert(result);
+    if (name_end == NULL || name_end - name >= BENCH_NAME_SIZE ||
+        !bench_read_number(line, "ns_per_op", &result->ns_per_op) ||
+        !bench_read_number(line, "allocs_per_op", &result->allocs_per_op)) {
+      free(result);
+      continue;
+    }
+    snprintf(result->name, BENCH_NAME_SIZE, "%.*s", (int)(name_end - name),
+             name);
+    result->ops = 0;
+    list_add(results, result);
+  }
+  fclose(file);
+  return results;
+}
+
+/**
+ * Prints how each result compares to the same benchmark in the baseline.
+ *
+ * @return the number of regressions
+ */
+static size_t bench_compare(bench_result_t *results, size_t num_results,
+                            list_t *baseline) {
+  size_t regressions = 0;
+  for (size_t i = 0; i < num_results; i++) {
+    bench_result_t *result = &results[i];
+    bench_result_t *base = NULL;
+    for (size_t j = 0; j < list_size(baseline); j++) {
+      bench_result_t *candidate = list_get(baseline, j);
+      if (strcmp(candidate->name, result->name) == 0) {
+        base = candidate;
+        break;
+      }
+    }
+    if (base == NULL) {
+      printf("%-32s new\n", result->name);
+      continue;
+    }
+    double change = base->ns_per_op > 0
+                        ? result->ns_per_op / base->ns_per_op - 1
+                        : 0;
+    bool slower = change > BENCH_TIME_TOLERANCE;
+    bool allocates = result->allocs_per_op >
+                     base->allocs_per_op + BENCH_ALLOC_TOLERANCE;
+    printf("%-32s %+7.1f%% time, %.4f -> %.4f allocs/op%s%s\n", result->name,
+           100 * change, base->allocs_per_op, result->allocs_per_op,
+           slower ? "  SLOWER" : "", allocates ? "  MORE ALLOCATIONS" : "");
+    regressions += slower || allocates;
+  }
+  return regressions;
+}
+
+int main(int argc, char *argv[]) {
+  const char *results_path = argc > 1 ? argv[1] : BENCH_DEFAULT_RESULTS;
+  const char *baseline_path = argc > 2 ? argv[2] : NULL;
+  const char *filter = getenv(BENCH_FILTER_ENV);
+
+  bench_result_t *results = malloc(sizeof(bench_result_t) * NUM_BENCHES);
+  assert(results);
+  size_t num_results = 0;
+  for (size_t i = 0; i < NUM_BENCHES; i++) {
+    if (filter != NULL && strstr(BENCHES[i].name, filter) == NULL) {
+      continue;
+    }
+    results[num_results] = bench_run(&BENCHES[i]);
+    printf("%-32s %12.2f ns/op %10.4f allocs/op\n", results[num_results].name,
+           results[num_results].ns_per_op, results[num_results].allocs_per_op);
+    fflush(stdout);
+    num_results++;
+  }
+  if (!bench_write(results_path, results, num_results)) {
+    fprintf(stderr, "could not write %s\n", results_path);
+    free(results);
+    return 1;
+  }
+
+  size_t regressions = 0;
+  if (baseline_path != NULL) {
+    list_t *baseline = bench_read(baseline_path);
+    if (baseline == NULL) {
+      fprintf(stderr, "could not read %s\n", baseline_path);
+      free(results);
+      return 1;
+    }
+    printf("\ncompared to %s:\n", baseline_path);
+    regressions = bench_compare(results, num_results, baseline);
+    list_free(baseline);
+    if (regressions > 0) {
+      printf("%zu regressions\n", regressions);
+    }
+  }
+  free(results);
+  return regressions > 0 ? 1 : 0;
+}
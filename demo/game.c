@@ -7,14 +7,33 @@
 #include <SDL2/SDL_ttf.h>
 #include <SDL2/SDL_ttf.h>
 
+#include "alias_table.h"
 #include "asset.h"
 #include "asset_cache.h"
+#include "camera.h"
 #include "collision.h"
+#include "ecs.h"
+#include "engine.h"
+#include "entity.h"
+#include "flow_field.h"
 #include "forces.h"
+#include "game.h"
+#include "generator.h"
+#include "profile.h"
+#include "projectile_pool.h"
+#include "replay.h"
+#include "rng.h"
+#include "row_index.h"
 #include "sdl_wrapper.h"
+#include "spatial_hash.h"
+#include "ui.h"
+#include "voice.h"
 #include "body.h"
 #include "SDL2/SDL_mixer.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
 const vector_t MIN = {0, 0};
 const vector_t MAX = {1000, 500};
 const vector_t USER_1_CENTER = {450, 0};
@@ -26,7 +45,7 @@ const SDL_Rect SHIELD_BOX_1 = {.x = 500, .y = 20, .w = 100, .h = 50};
 const SDL_Rect SHIELD_BOX_2 = {.x = 500, .y = 80, .w = 100, .h = 50};
 const size_t ROW_SEPARATION = 85;
 const size_t MIN_TILES_PER_ROW = 3;
-const size_t MAX_TILES_PER_ROW = 5;
+#define MAX_TILES_PER_ROW 5
 const size_t INITIAL_NUM_ROWS = 4;
 const size_t HEIGHT_TO_SCORE_RATIO = 2;
 const size_t BEAVER_MASS = 1;
@@ -43,15 +62,71 @@ const size_t TILE_HEIGHT = 30;
 const size_t SPRING_TILE_HEIGHT = 60;
 
 const size_t DEFAULT_TILE_X = 0;
-const size_t BREAK_TILES_PROBABILITY = 5;
-const size_t BREAK_TILES_SELECT = 1;
-const size_t SPRING_TILES_PROBABILITY = 5;
-const size_t SPRING_TILES_SELECT = 1;
-const size_t MOVE_TILES_PROBABILITY = 5;
-const size_t MOVE_TILES_SELECT = 1;
+// one row in MOVE_ROW_ODDS is made of moving tiles
+const uint32_t MOVE_ROW_ODDS = 5;
 const size_t MOVE_TILES_PER_ROW = 1;
-const size_t SPECIAL_TILES_PROBABILITY = 5;
-const size_t SPECIAL_TILES_SELECT = 1;
+// row slots made up front; enough for every row on screen, so scrolling
+// reuses them instead of making new tiles
+const size_t ROW_RING_SIZE = 8;
+// where the tiles a row doesn't use wait: left of where the players wrap
+// around, and far below them
+const vector_t PARKED_TILE_POSITION = {.x = -1000, .y = -1000};
+// how many rows the row generator lays out ahead of the players
+const size_t ROW_QUEUE_CAPACITY = 16;
+// the random stream of the rows, apart from the rest of the game's
+const uint64_t ROW_STREAM = 1;
+
+/**
+ * The kinds of tile rows are made of.
+ */
+typedef enum {
+  TILE_KIND_REGULAR,
+  TILE_KIND_BREAK,
+  TILE_KIND_SPRING,
+  TILE_KIND_ROCKET,
+  TILE_KIND_SHIELD,
+  TILE_KIND_MOVE,
+  NUM_TILE_KINDS
+} tile_kind_t;
+
+// relative odds of each kind of tile in a row without moving tiles, out of
+// 625: a break tile is 1 in 5, then spring, rocket and shield tiles each take
+// 1 in 5 of what is left
+const double TILE_KIND_WEIGHTS[NUM_TILE_KINDS] = {
+    [TILE_KIND_REGULAR] = 256, [TILE_KIND_BREAK] = 125,
+    [TILE_KIND_SPRING] = 100,  [TILE_KIND_ROCKET] = 80,
+    [TILE_KIND_SHIELD] = 64,   [TILE_KIND_MOVE] = 0};
+
+// the entity each kind of tile is made as
+const entity_kind_t TILE_KIND_ENTITIES[NUM_TILE_KINDS] = {
+    [TILE_KIND_REGULAR] = ENTITY_TILE,
+    [TILE_KIND_BREAK] = ENTITY_TILE_BREAK,
+    [TILE_KIND_SPRING] = ENTITY_TILE_SPRING,
+    [TILE_KIND_ROCKET] = ENTITY_TILE_ROCKET,
+    [TILE_KIND_SHIELD] = ENTITY_TILE_SHIELD,
+    [TILE_KIND_MOVE] = ENTITY_TILE_MOVE};
+
+/**
+ * A row laid out ahead of time by the row generator, for spawn_row to move
+ * the tiles of a slot to.
+ */
+typedef struct row_plan {
+  size_t height;
+  size_t num_tiles;
+  tile_kind_t kinds[MAX_TILES_PER_ROW];
+  vector_t positions[MAX_TILES_PER_ROW];
+  vector_t velocities[MAX_TILES_PER_ROW];
+} row_plan_t;
+
+/**
+ * What the row generator lays out rows with. Only its thread uses it.
+ */
+typedef struct row_planner {
+  rng_t rng;
+  // never changed while the generator runs
+  alias_table_t *tile_kinds;
+  size_t next_height;
+} row_planner_t;
 
 const size_t MAX_TILE_X_VELOCITY = 300;
 const size_t MIN_TILE_X_VELOCITY = 200;
@@ -67,21 +142,40 @@ const double PLAYER_SAFE_RADIUS = BEAVER_SIZE * 2;
 const double invader_velocity = 100;
 const vector_t INVADER_BULLET_VEL = {0, -200};
 const double INVADER_SIZE = 50;
-const size_t CIRC_NPOINTS = 4;
-const double BULLET_MASS = 10;
 const double BULLET_RADIUS = 10;
+const size_t BULLET_CAPACITY = 64;
+// the bits of the players in a bullet's targets
+const uint32_t PLAYER_1_TARGET = 1 << 0;
+const uint32_t PLAYER_2_TARGET = 1 << 1;
+// set in the environment to have the invaders flood the screen with bullets
+// that hit nobody, reporting the frame time as they pile up
+const char *STRESS_ENV = "PROJECTILE_STRESS";
+const size_t STRESS_BULLET_CAPACITY = 8192;
+// in all, from random invaders
+const size_t STRESS_SHOTS_PER_FRAME = 64;
+const size_t STRESS_INVADERS = 400;
+const uint32_t STRESS_SPREAD = 400;
+const size_t STRESS_REPORT_FRAMES = 120;
 const double SCORE_TILL_INVADER = 1000;
+const size_t INVADERS_PER_PLAYER = 1;
+// the invaders steer through a grid over the part of the world around the
+// camera, and keep apart from the ones within the separation radius
+const size_t FLOW_FIELD_COLS = 10;
+const size_t FLOW_FIELD_ROWS = 20;
+const double SWARM_SEPARATION_RADIUS = 60;
+const double SWARM_SEPARATION_WEIGHT = 2;
+const size_t SWARM_HASH_BUCKETS = 1024;
+const size_t SWARM_INITIAL_INVADERS = 16;
+#define NUM_PLAYERS 2
+#define MAX_SWARM_NEIGHBORS 8
 const size_t SPAWN_TIME = 1000;
 const rgb_color_t PLAYER_COLOR = (rgb_color_t){1, 1, 1};
 const rgb_color_t TILE_COLOR = (rgb_color_t){0, 0, 1};
 const rgb_color_t TEXT_COLOR = (rgb_color_t){1, 0, 0};
-const rgb_color_t INVADER_COLOR = (rgb_color_t){1, 0, 0};
 
 const size_t SHIELDING_TIME = 200;
 const size_t CIRCLE_POINTS = 200;
 
-// Initial number of assets
-size_t INITAL_NUM_ASSETS = 10;
 // filepath for the beavers
 const char *BEAVER_FILEPATH = "assets/beaver.png";
 const char *TILE_FILEPATH = "assets/tile.png";
@@ -90,29 +184,32 @@ const char *TILE_BREAK_FILEPATH = "assets/tile-break.png";
 const char *TILE_MOVE_FILEPATH = "assets/tile-move.png";
 const char *TILE_SPRING_FILEPATH = "assets/tile-spring.png";
 const char *TILE_ROCKET_FILEPATH = "assets/tile-rocket.png";
+const char *TILE_SHIELD_FILEPATH = "assets/shield_image.png";
 
 const char *FONT_PATH = "assets/DoodleJump.ttf";
 const char *INVADER_FILEPATH = "assets/invader.png";
-const char *BULLET__INFO = "bullet";
 const char *BULLET_FILEPATH = "assets/bullet.png";
+// in profiling builds, pressing the key or quitting writes the trace
+const char PROFILE_TRACE_KEY = 'p';
+const char *PROFILE_TRACE_PATH = "profile.json";
+// in allocation tracking builds, the most allocations a frame may make
+const char *ALLOC_BUDGET_ENV = "ALLOC_BUDGET";
+// if set, the windowed game records its inputs to this file for bin/replayer
+const char *REPLAY_RECORD_ENV = "REPLAY_RECORD";
 const double WALL_DIM = 1;
 
-const char *TILE = "tile";
-const char *TILE_SPRING = "tile-spring";
-const char *TILE_MOVE = "tile-move";
-const char *TILE_BREAK = "tile-break";
-const char *TILE_ROCKET = "tile-rocket";
-const char *TILE_SHIELD = "tile-shield";
-const char *INVADER_INFO = "invader";
-const char *BULLET_INFO = "bullet";
-const char *PLAYER_1_INFO = "player 1";
-const char *PLAYER_2_INFO = "player 2";
-char *DOUBLE_PLAYER_STATE = "2";
-char *SINGLE_PLAYER_STATE = "1";
-char *OVER_STATE = "OVER";
-char *HOME_STATE = "HOME";
-
-int16_t tile_index = 1;
+/**
+ * The screens of the game. Each frame, emscripten_main runs the update of the
+ * current one.
+ */
+typedef enum {
+  GAME_HOME,
+  GAME_SINGLE_PLAYER,
+  GAME_DOUBLE_PLAYER,
+  GAME_OVER,
+  // the number of states, not a state itself
+  NUM_GAME_STATES
+} game_state_t;
 
 const char *HOME_PATH = "assets/home-screen.jpeg";
 const char *GAME_OVER_PATH = "assets/game-over.jpeg";
@@ -123,13 +220,14 @@ const size_t NUM_BUTTONS = 2;
 
 const char *BOING_AUDIOPATH = "assets/boing_yay.wav";
 const char *GAME_OVER_AUDIOPATH = "assets/game_over.wav";
+// bounces may overlap a little, but never drown out the game over sound
+const voice_params_t BOING_VOICE = {.priority = 0, .max_instances = 2};
+const voice_params_t GAME_OVER_VOICE = {.priority = 10, .max_instances = 1};
 
-const char *TILE_SHIELD_FILEPATH = "assets/shield_image.png";
 const double SHIELD_HEIGHT = 30;
 const char *ACTIVATED_MSG_1 = "Activated Shield Player 1";
 const char *ACTIVATED_MSG_2 = "Activated Shield Player 2";
-const size_t SHIELD_MSG_LEN = 50;
-const size_t SCORE_STR_LEN = 50;
+const double PERCENT = 100;
 const size_t BEAVER_FALLING_FRAMES = 50;
 
 const SDL_Rect BUTTON_1_BOX = {.x = 600, .y = 200, .w = 300, .h = 70};
@@ -145,12 +243,6 @@ typedef struct button_info {
   button_handler_t handler;
 } button_info_t;
 
-typedef struct body_info {
-  bool is_tile;
-  char *name;
-  size_t index;
-} body_info_t;
-
 void play_state_1(state_t *state);
 void play_state_2(state_t *state);
 
@@ -170,44 +262,170 @@ button_info_t button_templates[] = {
      .text = " ",
      .handler = (void *)play_state_2}};
 
+/**
+ * The components of the game's entities, stored by state->world.
+ */
+typedef enum {
+  // transform_t
+  COMPONENT_TRANSFORM,
+  // body_t *, simulated by the scene
+  COMPONENT_BODY,
+  // asset_t *, the image drawn over the body
+  COMPONENT_SPRITE,
+  // tile_t
+  COMPONENT_TILE,
+  // player_input_t
+  COMPONENT_PLAYER,
+  // invader_t
+  COMPONENT_INVADER,
+  // the number of components, not a component itself
+  NUM_COMPONENTS
+} component_t;
+
+typedef struct invader {
+  // the player it chased last frame: 0 for player 1, 1 for player 2
+  size_t goal;
+} invader_t;
+
+/**
+ * Where a body was when its frame was last synced, so culling and despawning
+ * don't chase body pointers.
+ */
+typedef struct transform {
+  vector_t centroid;
+  aabb_t bounds;
+} transform_t;
+
+typedef struct tile {
+  // the spawn index of the tile, as in its body_info_t
+  size_t index;
+  // the entity_flag_t's of the tile's kind
+  uint32_t flags;
+} tile_t;
+
+typedef struct player_input {
+  char left_key;
+  char right_key;
+} player_input_t;
+
+const player_input_t PLAYER_1_KEYS = {.left_key = LEFT_ARROW,
+                                      .right_key = RIGHT_ARROW};
+const player_input_t PLAYER_2_KEYS = {.left_key = 'a', .right_key = 'd'};
+
+// every body of the game has these, whatever else it has
+const component_mask_t BODY_ENTITY = COMPONENT_BIT(COMPONENT_TRANSFORM) |
+                                     COMPONENT_BIT(COMPONENT_BODY) |
+                                     COMPONENT_BIT(COMPONENT_SPRITE);
+
+/**
+ * Removing an entity removes its body from the scene.
+ */
+static void body_component_free(body_t **body) { body_remove(*body); }
+
+/**
+ * Headless games have no sprites.
+ */
+static void sprite_component_free(asset_t **sprite) {
+  if (*sprite != NULL) {
+    asset_destroy(*sprite);
+  }
+}
+
+const ecs_component_info_t COMPONENTS[NUM_COMPONENTS] = {
+    [COMPONENT_TRANSFORM] = {.size = sizeof(transform_t)},
+    [COMPONENT_BODY] = {.size = sizeof(body_t *),
+                        .freer = (free_func_t)body_component_free},
+    [COMPONENT_SPRITE] = {.size = sizeof(asset_t *),
+                          .freer = (free_func_t)sprite_component_free},
+    [COMPONENT_TILE] = {.size = sizeof(tile_t)},
+    [COMPONENT_PLAYER] = {.size = sizeof(player_input_t)},
+    [COMPONENT_INVADER] = {.size = sizeof(invader_t)}};
+
+/**
+ * A slot of the ring of rows. Its tiles are made once and reused by every
+ * row laid out in the slot; the ones a row doesn't use are parked.
+ */
+typedef struct row_slot {
+  // MAX_TILES_PER_ROW tile entities
+  ecs_entity_t *tiles;
+  size_t num_tiles;
+  double height;
+  // false once the row scrolled off, until the slot is reused
+  bool active;
+} row_slot_t;
+
 struct state {
-  list_t *body_assets;
+  // what the game runs on; a headless game only simulates
+  engine_t *engine;
+  bool headless;
+  // every body of the scene, with what is drawn for it and how it behaves
+  ecs_t *world;
   scene_t *scene;
   body_t *player_1;
   body_t *player_2;
+  ecs_entity_t player_2_entity;
   list_t *button_assets;
   int32_t score;
   bool invaders_activated;
-  body_t *invader_1;
-  body_t *invader_2;
+  // the invaders' positions, gathered each frame to steer them as a swarm
+  vector_t *invader_positions;
+  size_t num_invaders;
+  size_t invaders_capacity;
+  flow_field_t *invader_field;
+  spatial_hash_t *invader_hash;
   size_t frames;
   double max_cam_height;
   size_t highest_row;
-  size_t current_tile_index;
-  char *game_state;
+  // row_slot_t's
+  list_t *rows;
+  // the tiles of the active rows, for the players to land on
+  row_index_t *tile_index;
+  // the spawn index of the next tile made
+  int16_t next_tile_index;
+  game_state_t game_state;
   bool game_over;
   size_t frames_at_end;
   asset_t *bgd;
   bool bgd_changed;
-  Mix_Chunk *boing_audio;
-  Mix_Chunk *game_over_audio;
   bool player_bounced;
   bool beaver_fallen;
   size_t time_shield_1;
   size_t time_shield_2;
   bool render_shield_p_1;
   bool render_shield_p_2;
+  list_t *button_parts;
+  asset_scope_t *home_scope;
+  asset_scope_t *play_scope;
+  asset_scope_t *over_scope;
+  // whether the game over sound was tried for good; it may still be
+  // preloading at first
+  bool over_sound_played;
+  // retained UI of each screen, built once
+  ui_node_t *home_ui;
+  ui_node_t *loading_label;
+  ui_node_t *hud_ui;
+  ui_node_t *score_label;
+  ui_node_t *shield_label_1;
+  ui_node_t *shield_label_2;
+  ui_node_t *over_ui;
+  // the random streams of this game and its rows, so a seed replays the
+  // same game
+  uint64_t seed;
+  rng_t rng;
+  // lays out the rows on a background thread, ahead of the players
+  row_planner_t row_planner;
+  generator_t *row_generator;
+  // the invaders' bullets, drawn with one shared sprite
+  projectile_pool_t *bullets;
+  asset_t *bullet_sprite;
+  bool stress;
+  double stress_time;
+  // frames run since game_init, counting every screen
+  size_t ticks;
+  // where the inputs are recorded, or NULL
+  replay_writer_t *recording;
 };
 
-body_info_t *body_info_init(bool is_tile, char *name, size_t index) {
-  body_info_t *body_info = malloc(sizeof(body_info_t));
-  assert(body_info);
-  body_info->is_tile = is_tile;
-  body_info->name = strdup(name);
-  body_info->index = index;
-  return body_info;
-}
-
 /*
  * Creating a oval to overlay the Beaver asset on
  */
@@ -227,182 +445,247 @@ list_t *make_oval(double outer_radius, double inner_radius) {
   return c;
 }
 
+/**
+ * Copies where a body is into its transform.
+ */
+static void transform_sync(transform_t *transform, body_t *body) {
+  transform->centroid = body_get_centroid(body);
+  transform->bounds = body_get_aabb(body);
+}
+
+/**
+ * Adds an entity for a body of the scene.
+ *
+ * @param body the body, owned by the scene
+ * @param filepath the image drawn over the body
+ * @param components the components the entity has besides BODY_ENTITY, left
+ *   zeroed for the caller to fill in
+ * @return the new entity
+ */
+ecs_entity_t spawn_body_entity(state_t *state, body_t *body,
+                               const char *filepath,
+                               component_mask_t components) {
+  ecs_entity_t entity = ecs_spawn(state->world, BODY_ENTITY | components);
+  *(body_t **)ecs_get(state->world, entity, COMPONENT_BODY) = body;
+  *(asset_t **)ecs_get(state->world, entity, COMPONENT_SPRITE) =
+      state->headless ? NULL
+                      : asset_make_image_with_body(
+                            filepath, sdl_get_bounding_box(body), body);
+  transform_sync(ecs_get(state->world, entity, COMPONENT_TRANSFORM), body);
+  return entity;
+}
+
 /*
  * Puts the the invader at a random x top of the screen
  */
-static void reset_invader_loc(body_t *player, body_t *invader) {
-  double invader_x = (rand() % (size_t)floor(MAX.x));
+static void reset_invader_loc(rng_t *rng, body_t *invader) {
+  double invader_x = rng_below(rng, floor(MAX.x));
   vector_t invader_loc = (vector_t){.x = invader_x, .y = MAX.y};
   body_set_centroid(invader, invader_loc);
 }
 
 /*
- * Initializes an invader body at a random location for the given player
+ * Adds a wave of invaders at random locations
  */
-body_t *initialize_invader(state_t *state, body_t *player) {
-  body_info_t *body_info = body_info_init(false, "invader", 0);
-  body_t *invader = body_init_with_info(make_oval(INVADER_SIZE, INVADER_SIZE), INFINITY, TILE_COLOR, body_info, NULL);
-  asset_t *asset_invader = asset_make_image_with_body(INVADER_FILEPATH, sdl_get_bounding_box(invader), invader);
-  list_add(state->body_assets, asset_invader);
-  reset_invader_loc(player, invader);
-  return invader;
+void spawn_invaders(state_t *state, size_t count) {
+  for (size_t i = 0; i < count; i++) {
+    body_info_t *body_info = body_info_init(ENTITY_INVADER, 0);
+    body_t *invader = body_init_with_info(make_oval(INVADER_SIZE, INVADER_SIZE), INFINITY, TILE_COLOR, body_info, free);
+    reset_invader_loc(&state->rng, invader);
+    scene_add_body(state->scene, invader);
+    spawn_body_entity(state, invader, INVADER_FILEPATH,
+                      COMPONENT_BIT(COMPONENT_INVADER));
+  }
+}
+
+/**
+ * Gets the players the invaders chase, indexed by their goal.
+ *
+ * @return the number of players
+ */
+size_t invader_goals(state_t *state, body_t *players[NUM_PLAYERS]) {
+  players[0] = state->player_1;
+  if (state->game_state != GAME_DOUBLE_PLAYER) {
+    return 1;
+  }
+  players[1] = state->player_2;
+  return NUM_PLAYERS;
 }
 
 /*
- * AI Enemy: Updates the Invader to move towards the player it is assigned to.
- * Platers have a safe radius, which if enchroached, the invader received an impulse in
- * the opposite direction
+ * AI Enemy: Moves an invader along the flow field toward the nearest player,
+ * away from the invaders crowding it. Players have a safe radius, which if
+ * enchroached, the invader received an impulse in the opposite direction
+ *
+ * @param k the invader's index in state->invader_positions
+ * @param goal the position of the player it chases
  */
-void update_invader(body_t *player, body_t *invader)
-{
-  vector_t player_loc = body_get_centroid(player);
-  vector_t invader_loc = body_get_centroid(invader);
-  double dx = player_loc.x - invader_loc.x;
-  double dy = player_loc.y - invader_loc.y;
+void steer_invader(state_t *state, body_t *invader, size_t k, vector_t goal) {
+  vector_t invader_loc = state->invader_positions[k];
+  double dx = goal.x - invader_loc.x;
+  double dy = goal.y - invader_loc.y;
   if (dy > VEC_ZERO.y) {
     body_add_impulse(invader, REPULSE);
   }
   if (fabs(dx) > PLAYER_SAFE_RADIUS || fabs(dy) > PLAYER_SAFE_RADIUS) {
-    // Compute the direction vector from invader to player
-    vector_t direction = (vector_t){.x = dx, .y = dy};
-    // Normalize the direction vector
-    double norm_x = direction.x / vec_get_length(direction);
-    double norm_y = direction.y / vec_get_length(direction);
-    // Scale by invader velocity
-    double vx = invader_velocity * norm_x;
-    double vy = invader_velocity * norm_y;
-    // Set the invader's velocity
-    body_set_velocity(invader, (vector_t){.x = vx, .y = vy});
+    vector_t heading = flow_field_direction(state->invader_field, invader_loc);
+    size_t neighbors[MAX_SWARM_NEIGHBORS];
+    size_t num_neighbors =
+        spatial_hash_query(state->invader_hash, invader_loc,
+                           SWARM_SEPARATION_RADIUS, neighbors,
+                           MAX_SWARM_NEIGHBORS);
+    for (size_t n = 0; n < num_neighbors; n++) {
+      vector_t away =
+          vec_subtract(invader_loc, state->invader_positions[neighbors[n]]);
+      double distance = vec_get_length(away);
+      if (neighbors[n] != k && distance > 0) {
+        // pushes harder the closer the neighbor is
+        double push = SWARM_SEPARATION_WEIGHT *
+                      (1 - distance / SWARM_SEPARATION_RADIUS) / distance;
+        heading = vec_add(heading, vec_multiply(push, away));
+      }
+    }
+    double length = vec_get_length(heading);
+    vector_t velocity = VEC_ZERO;
+    if (length > 0) {
+      velocity = vec_multiply(invader_velocity / length, heading);
+    }
+    body_set_velocity(invader, velocity);
   }
   else {
     body_add_impulse(invader, INV_IMPULSE);
   }
 }
 
-/*
- * Makes the invader bullet object
+/**
+ * Steers every invader. Builds a flow field toward the players and a spatial
+ * hash of the invaders once, so each invader only needs a lookup in each.
  */
-body_t *make_bullet(vector_t center, double radius, double mass,
-                    rgb_color_t color, void *info) {
-  list_t *c = list_init(CIRC_NPOINTS, free);
-  for (size_t i = 0; i < CIRC_NPOINTS; i++)
-  {
-    double angle = 2 * M_PI * i / CIRC_NPOINTS;
-    vector_t *v = malloc(sizeof(*v));
-    *v = (vector_t){center.x + radius * cos(angle),
-                    center.y + radius * sin(angle)};
-    list_add(c, v);
+void steer_invaders(state_t *state) {
+  PROFILE_FUNCTION();
+  body_t *players[NUM_PLAYERS];
+  vector_t goals[NUM_PLAYERS];
+  size_t num_goals = invader_goals(state, players);
+  for (size_t g = 0; g < num_goals; g++) {
+    goals[g] = body_get_centroid(players[g]);
+  }
+
+  state->num_invaders = 0;
+  component_mask_t mask =
+      COMPONENT_BIT(COMPONENT_INVADER) | COMPONENT_BIT(COMPONENT_BODY);
+  ecs_query_t query = ecs_query(state->world, mask);
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      if (state->num_invaders == state->invaders_capacity) {
+        state->invaders_capacity *= 2;
+        state->invader_positions =
+            realloc(state->invader_positions,
+                    sizeof(vector_t) * state->invaders_capacity);
+        assert(state->invader_positions);
+      }
+      state->invader_positions[state->num_invaders++] =
+          body_get_centroid(bodies[i]);
+    }
+  }
+  if (state->num_invaders == 0) {
+    return;
+  }
+
+  // the invaders wait above the screen and chase players below it
+  aabb_t area = {.min = {MIN.x, state->max_cam_height - MAX.y},
+                 .max = {MAX.x, state->max_cam_height + 2 * MAX.y}};
+  flow_field_build(state->invader_field, area, goals, num_goals);
+  spatial_hash_build(state->invader_hash, state->invader_positions,
+                     state->num_invaders);
+
+  // the same tables in the same order, so the k-th row is the k-th position
+  size_t k = 0;
+  query = ecs_query(state->world, mask);
+  while ((table = ecs_query_next(&query)) != NULL) {
+    invader_t *invaders = ecs_table_column(table, COMPONENT_INVADER);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++, k++) {
+      invaders[i].goal = flow_field_goal(state->invader_field,
+                                         state->invader_positions[k]);
+      steer_invader(state, bodies[i], k, goals[invaders[i].goal]);
+    }
+  }
+}
+
+/**
+ * Sends the invaders chasing a player that are below it back above the
+ * screen.
+ */
+void lift_invaders_below(state_t *state, body_t *player, size_t goal) {
+  double player_y = body_get_centroid(player).y;
+  ecs_query_t query = ecs_query(state->world, COMPONENT_BIT(COMPONENT_INVADER) |
+                                                  COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    invader_t *invaders = ecs_table_column(table, COMPONENT_INVADER);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      vector_t invader_loc = body_get_centroid(bodies[i]);
+      if (invaders[i].goal == goal && invader_loc.y < player_y) {
+        body_set_centroid(bodies[i], (vector_t){.x = invader_loc.x,
+                            .y = state->max_cam_height + MAX.y});
+      }
+    }
   }
-  body_info_t *body_info = body_info_init(false, info, 0);
-  return body_init_with_info(c, mass, color, body_info, NULL);
+}
+
+/**
+ * Gets the corners of a tile centered at `center`.
+ */
+void tile_corners(vector_t center, double width, double height,
+                  vector_t corners[4]) {
+  corners[0] = (vector_t){center.x - width / 2, center.y - height / 2};
+  corners[1] = (vector_t){center.x + width / 2, center.y - height / 2};
+  corners[2] = (vector_t){center.x + width / 2, center.y + height / 2};
+  corners[3] = (vector_t){center.x - width / 2, center.y + height / 2};
 }
 
 /*
  * Makes the list of points for tiles
  */
 list_t *make_tile(vector_t center, double width, double height) {
+  vector_t corners[4];
+  tile_corners(center, width, height, corners);
   list_t *points = list_init(4, free);
-  vector_t *p1 = malloc(sizeof(vector_t));
-  *p1 = (vector_t){center.x - width / 2, center.y - height / 2};
-  vector_t *p2 = malloc(sizeof(vector_t));
-  *p2 = (vector_t){center.x + width / 2, center.y - height / 2};
-
-  vector_t *p3 = malloc(sizeof(vector_t));
-  *p3 = (vector_t){center.x + width / 2, center.y + height / 2};
-
-  vector_t *p4 = malloc(sizeof(vector_t));
-  *p4 = (vector_t){center.x - width / 2, center.y + height / 2};
-
-  list_add(points, p1);
-  list_add(points, p2);
-  list_add(points, p3);
-  list_add(points, p4);
+  for (size_t i = 0; i < 4; i++) {
+    vector_t *p = malloc(sizeof(vector_t));
+    assert(p);
+    *p = corners[i];
+    list_add(points, p);
+  }
   return points;
 }
 
-list_t *generate_random_row(size_t height) {
-  size_t max_tiles = MAX.x / (2 * TILE_WIDTH);
-  size_t num_tiles = floor(rand() % max_tiles);
-  // bound the number of tiles per row
-  if (num_tiles < MIN_TILES_PER_ROW) {
-    num_tiles = MIN_TILES_PER_ROW;
-  }
-  if (num_tiles > MAX_TILES_PER_ROW) {
-    num_tiles = MAX_TILES_PER_ROW;
+double tile_kind_height(tile_kind_t kind) {
+  switch (kind) {
+  case TILE_KIND_SPRING:
+  case TILE_KIND_ROCKET:
+    return SPRING_TILE_HEIGHT;
+  case TILE_KIND_SHIELD:
+    return SHIELD_HEIGHT;
+  default:
+    return TILE_HEIGHT;
   }
-  // case for a moving tiles row
-  size_t move_tile = floor(rand() % MOVE_TILES_PROBABILITY);
-  if (move_tile == MOVE_TILES_SELECT) {
-    num_tiles = MOVE_TILES_PER_ROW;
-  }
-  list_t *all_tiles = list_init(num_tiles, (void *) body_free);
-  size_t x_dist = floor(MAX.x / num_tiles);
-
-  for (size_t i = 0; i < num_tiles; i++) {
-    vector_t tile_pos = {DEFAULT_TILE_X, height};
-    size_t rand_pos = floor(rand() % x_dist);
-    // avoid overlapping tiles
-    if (rand_pos < TILE_WIDTH / 2) {
-      rand_pos = TILE_WIDTH / 2;
-    } 
-    if (rand_pos > x_dist - (TILE_WIDTH / 2)) {
-      rand_pos = x_dist - (TILE_WIDTH / 2);
-    }
-    // case for a moving tiles row
-    if (move_tile == MOVE_TILES_SELECT) {
-      body_info_t *tile_info = body_info_init(true, (char *)TILE_MOVE, tile_index);
-      body_t *tile = body_init_with_info(make_tile(tile_pos, TILE_WIDTH, TILE_HEIGHT),
-                                         INFINITY, PLAYER_COLOR, tile_info, NULL);
-      tile_index++;
-      list_add(all_tiles, tile);
-    } else {
-      // adding break tiles to rows randomly
-      size_t break_tile = floor(rand() % BREAK_TILES_PROBABILITY);
-      size_t spring_tile = floor(rand() % SPRING_TILES_PROBABILITY);
-      size_t rocket_tile = floor(rand() % SPECIAL_TILES_PROBABILITY);
-      size_t shield_tile = floor(rand() % SPECIAL_TILES_PROBABILITY);
+}
 
-      tile_pos.x = (i * x_dist) + rand_pos;
-      if (break_tile == BREAK_TILES_SELECT) {
-        body_info_t *tile_info = body_info_init(true, (char *)TILE_BREAK, tile_index);
-        body_t *tile = body_init_with_info(make_tile(tile_pos, TILE_WIDTH, TILE_HEIGHT),
-                                           INFINITY, PLAYER_COLOR, tile_info, NULL);
-        tile_index++;
-        list_add(all_tiles, tile);
-      } else if (spring_tile == SPRING_TILES_SELECT) { 
-        // adding spring tiles to rows randomly
-        body_info_t *tile_info = body_info_init(true, (char *)TILE_SPRING, tile_index);
-        body_t *tile = body_init_with_info (
-                              make_tile(tile_pos, TILE_WIDTH, SPRING_TILE_HEIGHT),
-                              INFINITY, PLAYER_COLOR, tile_info, NULL);
-        tile_index++;
-        list_add(all_tiles, tile);
-      } else if (rocket_tile == SPECIAL_TILES_SELECT) {
-        body_info_t *tile_info = body_info_init(true, (char *)TILE_ROCKET, tile_index);
-        body_t *tile = body_init_with_info(
-                              make_tile(tile_pos, TILE_WIDTH, SPRING_TILE_HEIGHT),
-                              INFINITY, PLAYER_COLOR, tile_info, NULL);
-        tile_index++;
-        list_add(all_tiles, tile);
-      }
-      else if (shield_tile == SPECIAL_TILES_SELECT) {
-        body_info_t *tile_info = body_info_init(true, (char *)TILE_SHIELD, tile_index);
-        body_t *tile = body_init_with_info(
-                              make_tile(tile_pos, TILE_WIDTH, SHIELD_HEIGHT),
-                              INFINITY, PLAYER_COLOR, tile_info, NULL);
-        tile_index++;
-        list_add(all_tiles, tile);
-      } else {
-        body_info_t *tile_info = body_info_init(true, "tile", tile_index);
-        body_t *tile = body_init_with_info(
-                              make_tile(tile_pos, TILE_WIDTH, TILE_HEIGHT),
-                              INFINITY, PLAYER_COLOR, tile_info, NULL);
-        tile_index++;
-        list_add(all_tiles, tile);
-      }
-    }
-  }
-  return all_tiles;
+/**
+ * Makes a tile of the given kind centered at `position`.
+ */
+body_t *make_tile_of_kind(state_t *state, tile_kind_t kind,
+                          vector_t position) {
+  body_info_t *tile_info =
+      body_info_init(TILE_KIND_ENTITIES[kind], state->next_tile_index);
+  state->next_tile_index++;
+  return body_init_with_info(
+      make_tile(position, TILE_WIDTH, tile_kind_height(kind)), INFINITY,
+      PLAYER_COLOR, tile_info, free);
 }
 
 /**
@@ -421,41 +704,39 @@ void user_wrap_edges(body_t *body)
 }
 
 /*
- * Key handler for moving the Beavers
+ * Key handler for moving the Beavers that take input
  */
 void on_key(char key, key_event_type_t type, double held_time, state_t *state) {
-  double vy1 = body_get_velocity(state->player_1).y;
-  vector_t velocity_right_1 = (vector_t){.x = resting_speed + ACCEL * held_time, 
-                                          .y = vy1};
-  vector_t velocity_left_1 = (vector_t){.x = - resting_speed - ACCEL * held_time, 
-                                          .y = vy1};
-  // Moving Beaver 1
-  if (type == KEY_PRESSED) {
-    if (key == LEFT_ARROW) {
-      body_set_velocity(state->player_1, velocity_left_1);
-    }
-    else if (key == RIGHT_ARROW) {
-      body_set_velocity(state->player_1, velocity_right_1);
-    }
-  } else {
-    body_set_velocity(state->player_1, (vector_t){.x = VEC_ZERO.x, .y = vy1});
-  }
-  // Moving Beaver 2
-  if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0) {
-    double vy2 = body_get_velocity(state->player_2).y;
-    vector_t velocity_right_2 = (vector_t){.x = resting_speed + ACCEL * held_time,
-                                            .y = vy2};
-    vector_t velocity_left_2 = (vector_t){.x = -resting_speed - ACCEL * held_time, 
-                                            .y = vy2};
-    if (type == KEY_PRESSED) {
-      if (key == 'a' && (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0)) {
-        body_set_velocity(state->player_2, velocity_left_2);
-      }
-      else if (key == 'd' && (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0)) {
-        body_set_velocity(state->player_2, velocity_right_2);
+  if (state->recording != NULL) {
+    replay_writer_add(state->recording,
+                      (replay_event_t){.type = REPLAY_KEY,
+                                       .tick = state->ticks,
+                                       .key = key,
+                                       .key_type = type,
+                                       .held_time = held_time});
+  }
+  if (key == PROFILE_TRACE_KEY && type == KEY_PRESSED) {
+    PROFILE_WRITE(PROFILE_TRACE_PATH);
+  }
+  double speed = resting_speed + ACCEL * held_time;
+  ecs_query_t query = ecs_query(state->world, COMPONENT_BIT(COMPONENT_PLAYER) |
+                                                  COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    player_input_t *inputs = ecs_table_column(table, COMPONENT_PLAYER);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      vector_t velocity = body_get_velocity(bodies[i]);
+      if (type != KEY_PRESSED) {
+        velocity.x = VEC_ZERO.x;
+      } else if (key == inputs[i].left_key) {
+        velocity.x = -speed;
+      } else if (key == inputs[i].right_key) {
+        velocity.x = speed;
+      } else {
+        continue;
       }
-    } else {
-      body_set_velocity(state->player_2, (vector_t){.x = VEC_ZERO.x, .y = vy2});
+      body_set_velocity(bodies[i], velocity);
     }
   }
 }
@@ -473,12 +754,17 @@ asset_t *create_button_from_info(state_t *state, button_info_t info) {
   asset_t *image_asset = asset_make_image(info.image_path, info.image_box);
   asset_t *text_asset = NULL;
   if (info.font_path != NULL) {
-    text_asset = asset_make_text(info.font_path, info.text_box, info.text,
-                                 info.text_color);
+    text_asset = asset_make_static_text(info.font_path, info.text_box,
+                                        info.text, info.text_color);
   }
   asset_t *button_asset =
       asset_make_button(info.image_box, image_asset, text_asset, info.handler);
   asset_cache_register_button(button_asset);
+  // buttons don't own their image and text, so keep them to free later
+  list_add(state->button_parts, image_asset);
+  if (text_asset != NULL) {
+    list_add(state->button_parts, text_asset);
+  }
   return button_asset;
 }
 
@@ -490,6 +776,20 @@ void create_buttons(state_t *state) {
   }
 }
 
+/**
+ * Replaces the background. Headless games have none.
+ */
+void set_background(state_t *state, const char *filepath) {
+  if (state->headless) {
+    return;
+  }
+  SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
+  if (state->bgd != NULL) {
+    asset_destroy(state->bgd);
+  }
+  state->bgd = asset_make_image(filepath, background_box);
+}
+
 void beaver_collision_handler(body_t *player, body_t *tile, vector_t axis,
                               void *aux, double force_const) {
   state_t *state = (state_t *)aux;
@@ -498,40 +798,32 @@ void beaver_collision_handler(body_t *player, body_t *tile, vector_t axis,
     double val = REG_TILE_VEL;
     vector_t new_axis = (vector_t){.x = VEC_ZERO.x, .y = axis.y};
     body_info_t *body_info = (body_info_t *)body_get_info(tile);
-    if (strcmp(body_info->name, TILE_SPRING) == 0) {
+    switch (body_info->kind) {
+    case ENTITY_TILE_SPRING:
       val = SPRING_TILE_VEL;
-    } else if (strcmp(body_info->name, TILE_ROCKET) == 0) {
+      break;
+    case ENTITY_TILE_ROCKET:
       val = ROCKET_TILE_VEL;
+      break;
+    default:
+      break;
     }
     physics_collision_handler(player, tile, new_axis, &val, force_const);
 
-    body_info_t *info = (body_info_t *)(body_get_info(player));
-    if (strcmp(info->name, PLAYER_1_INFO) == 0) {
-      vector_t invader_loc = body_get_centroid(state->invader_1);
-      if (invader_loc.y < body_get_centroid(state->player_1).y) {
-        body_set_centroid(state->invader_1, (vector_t){.x = invader_loc.x, 
-                            .y = state->max_cam_height + MAX.y});
-      }
-    } else {
-      vector_t invader_loc = body_get_centroid(state->invader_2);
-      if (invader_loc.y < body_get_centroid(state->player_2).y) {
-        body_set_centroid(state->invader_2, (vector_t){.x = invader_loc.x, 
-                            .y = state->max_cam_height + MAX.y});
-      }
-    }
-    if (strcmp(body_info->name, TILE_BREAK) == 0) {
+    body_info_t *player_info = (body_info_t *)body_get_info(player);
+    lift_invaders_below(state, player,
+                        player_info->kind == ENTITY_PLAYER_1 ? 0 : 1);
+    if (body_info->flags & ENTITY_BREAKS) {
       vector_t under_floor = {MAX.x, MIN.y - TILE_HEIGHT};
       body_set_centroid(tile, under_floor);
     }
-    if (!state->bgd_changed && strcmp(body_info->name, TILE_ROCKET) == 0) {
+    if (!state->bgd_changed && (body_info->flags & ENTITY_LAUNCHES)) {
       state->bgd_changed = true;
-      SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
-      state->bgd = asset_make_image(ROCKET_BGD_FILEPATH, background_box);
+      set_background(state, ROCKET_BGD_FILEPATH);
     }
-    if (strcmp(body_info->name, TILE_SHIELD) == 0) {
-      body_info_t *player_info = (body_info_t *)body_get_info(player);
-      if ((strcmp(player_info->name, PLAYER_1_INFO) == 0) && 
-                      strcmp(state->game_state, SINGLE_PLAYER_STATE) == 0) {
+    if (body_info->flags & ENTITY_SHIELDS) {
+      if (player_info->kind == ENTITY_PLAYER_1 &&
+          state->game_state == GAME_SINGLE_PLAYER) {
         state->render_shield_p_1 = true; 
         state->time_shield_1 = state->frames;
       } else {
@@ -542,105 +834,363 @@ void beaver_collision_handler(body_t *player, body_t *tile, vector_t axis,
   }
 }
 
-void bullet_collision_handler(body_t *player, body_t *bullet, vector_t axis,
-                              void *aux, double force_const) {
-  state_t *state = (state_t *)aux;
-  state->game_state = OVER_STATE;
+void create_beaver_collision(scene_t *scene, body_t *player,
+                             double elasticity, state_t *state) {
+  create_row_collision(scene, player, state->tile_index,
+                       beaver_collision_handler, (void *)state, elasticity);
 }
 
-void create_beaver_collision(scene_t *scene, body_t *player, body_t *tile, 
-                            double elasticity, state_t *state) {
-  create_collision(scene, player, tile, beaver_collision_handler, (void *)state, elasticity);
+/**
+ * Fires a bullet down from an invader at a player, which can't hit the
+ * player if it was shielded when it was fired.
+ */
+void invader_shoot_bullet(state_t *state, body_t *invader, uint32_t target,
+                          bool shield) {
+  projectile_pool_fire(state->bullets, body_get_centroid(invader),
+                       INVADER_BULLET_VEL, shield ? 0 : target);
 }
 
-// invader shoot bullet
-void invader_shoot_bullet(scene_t *scene, body_t *player, body_t *invader, 
-                          state_t *state, bool shield) {
-  srand(time(NULL));
-  body_t *bullet = make_bullet(body_get_centroid(invader), BULLET_RADIUS,
-                               BULLET_MASS, INVADER_COLOR, (void *) BULLET_INFO);
-  scene_add_body(state->scene, bullet);
-  asset_t *bullet_asset = asset_make_image_with_body(BULLET_FILEPATH, sdl_get_bounding_box(bullet), bullet);
-  list_add(state->body_assets, bullet_asset);
-  body_set_velocity(bullet, INVADER_BULLET_VEL);
-  if (!shield) {
-    create_collision(scene, player, bullet, bullet_collision_handler, state, ELASTICITY);
+/**
+ * Has every invader fire at the player it chases.
+ */
+void invaders_shoot(state_t *state) {
+  ecs_query_t query = ecs_query(state->world, COMPONENT_BIT(COMPONENT_INVADER) |
+                                                  COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    invader_t *invaders = ecs_table_column(table, COMPONENT_INVADER);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      if (invaders[i].goal == 0) {
+        invader_shoot_bullet(state, bodies[i], PLAYER_1_TARGET,
+                             state->render_shield_p_1);
+      } else {
+        invader_shoot_bullet(state, bodies[i], PLAYER_2_TARGET,
+                             state->render_shield_p_2);
+      }
+    }
   }
 }
 
-void add_force_creators(state_t *state) {
-  for (size_t i = 0; i < list_size(state->body_assets); i++) {
-    asset_t *asset = list_get(state->body_assets, i);
-    body_t *tile = get_image_asset_body(asset);
-    body_info_t *body_info = (body_info_t *)body_get_info(tile);
-    if (asset_is_tile(asset)) {
-      if (body_info->index > state->current_tile_index) {
-        create_beaver_collision(state->scene, state->player_1, tile, ELASTICITY, state);
-        if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0 || 
-              strcmp(state->game_state, "HOME") == 0) {
-          create_beaver_collision(state->scene, state->player_2, tile, ELASTICITY, state);
-        }
-        state->current_tile_index++;
-      }
+/**
+ * Fires a spread of harmless bullets from random invaders, in stress mode.
+ */
+void invaders_stress_fire(state_t *state) {
+  if (state->num_invaders == 0) {
+    return;
+  }
+  for (size_t i = 0; i < STRESS_SHOTS_PER_FRAME; i++) {
+    size_t k = rng_below(&state->rng, state->num_invaders);
+    double vx = (double)rng_below(&state->rng, 2 * STRESS_SPREAD) -
+                STRESS_SPREAD;
+    vector_t velocity = {vx, INVADER_BULLET_VEL.y};
+    projectile_pool_fire(state->bullets, state->invader_positions[k],
+                         velocity, 0);
+  }
+}
+
+/**
+ * Ends the game if a bullet hits a player, then moves the bullets and drops
+ * the ones that fell below the camera.
+ */
+void tick_bullets(state_t *state, double dt) {
+  PROFILE_FUNCTION();
+  if (state->game_state == GAME_SINGLE_PLAYER ||
+      state->game_state == GAME_DOUBLE_PLAYER) {
+    // players are make_oval(BEAVER_SIZE, BEAVER_SIZE): circles of this radius
+    double radius = BEAVER_SIZE;
+    size_t hits = projectile_pool_hit(state->bullets,
+                                      body_get_centroid(state->player_1),
+                                      radius, PLAYER_1_TARGET);
+    if (state->game_state == GAME_DOUBLE_PLAYER) {
+      hits += projectile_pool_hit(state->bullets,
+                                  body_get_centroid(state->player_2), radius,
+                                  PLAYER_2_TARGET);
+    }
+    if (hits > 0) {
+      state->game_state = GAME_OVER;
+    }
+  }
+  projectile_pool_tick(state->bullets, dt);
+  projectile_pool_cull_below(state->bullets,
+                             camera_get_view(engine_get_camera(state->engine)).min.y);
+
+  if (state->stress) {
+    state->stress_time += dt;
+    if (state->frames % STRESS_REPORT_FRAMES == 0 && state->frames > 0) {
+      printf("%zu bullets, %.3f ms/frame\n",
+             projectile_pool_size(state->bullets),
+             state->stress_time * 1000 / STRESS_REPORT_FRAMES);
+      state->stress_time = 0;
     }
   }
 }
 
-asset_t *create_tile_type(char *tile_type, body_t *tile) {
-  if (strcmp(tile_type, TILE_BREAK) == 0) {
-    return asset_make_image_with_body(TILE_BREAK_FILEPATH, sdl_get_bounding_box(tile), tile);
-  } if (strcmp(tile_type, TILE_MOVE) == 0) {
-    return asset_make_image_with_body(TILE_MOVE_FILEPATH, sdl_get_bounding_box(tile), tile);
-  } if (strcmp(tile_type, TILE_SPRING) == 0) {
-    return asset_make_image_with_body(TILE_SPRING_FILEPATH, sdl_get_bounding_box(tile), tile);
-  } if (strcmp(tile_type, TILE_ROCKET) == 0) {
-    return asset_make_image_with_body(TILE_ROCKET_FILEPATH, sdl_get_bounding_box(tile), tile);
-  } if (strcmp(tile_type, "tile-shield") == 0) {
-    return asset_make_image_with_body(TILE_SHIELD_FILEPATH, sdl_get_bounding_box(tile), tile);
+const char *tile_filepath(entity_kind_t tile_type) {
+  const char *filepath = TILE_FILEPATH;
+  switch (tile_type) {
+  case ENTITY_TILE_BREAK:
+    filepath = TILE_BREAK_FILEPATH;
+    break;
+  case ENTITY_TILE_MOVE:
+    filepath = TILE_MOVE_FILEPATH;
+    break;
+  case ENTITY_TILE_SPRING:
+    filepath = TILE_SPRING_FILEPATH;
+    break;
+  case ENTITY_TILE_ROCKET:
+    filepath = TILE_ROCKET_FILEPATH;
+    break;
+  case ENTITY_TILE_SHIELD:
+    filepath = TILE_SHIELD_FILEPATH;
+    break;
+  default:
+    break;
   }
-  return asset_make_image_with_body(TILE_FILEPATH, sdl_get_bounding_box(tile), tile);
+  return filepath;
 }
 
-void spawn_row(size_t height, state_t *state) {
-  list_t *row_tiles = generate_random_row(height);
-  for (size_t i = 0; i < list_size(row_tiles); i++) {
-    body_t *tile = (body_t *)list_get(row_tiles, i);
+/**
+ * Moves a tile of a row slot out of the players' reach until it is used
+ * again.
+ */
+void tile_park(state_t *state, ecs_entity_t tile) {
+  body_t *body = *(body_t **)ecs_get(state->world, tile, COMPONENT_BODY);
+  body_set_centroid(body, PARKED_TILE_POSITION);
+  body_set_velocity(body, VEC_ZERO);
+  // a parked tile does nothing, not even wrap around
+  ((tile_t *)ecs_get(state->world, tile, COMPONENT_TILE))->flags = 0;
+  transform_sync(ecs_get(state->world, tile, COMPONENT_TRANSFORM), body);
+}
+
+/**
+ * Turns a tile of a row slot into a tile of the given kind centered at
+ * `position` and moving at `velocity`, keeping its body, sprite and
+ * collisions.
+ */
+void tile_reset(state_t *state, ecs_entity_t tile, tile_kind_t kind,
+                vector_t position, vector_t velocity) {
+  body_t *body = *(body_t **)ecs_get(state->world, tile, COMPONENT_BODY);
+  body_info_t *body_info = (body_info_t *)body_get_info(body);
+  entity_kind_t entity_kind = TILE_KIND_ENTITIES[kind];
+  if (body_info->kind != entity_kind) {
+    body_info->kind = entity_kind;
+    body_info->flags = entity_kind_flags(entity_kind);
+    asset_t *sprite =
+        *(asset_t **)ecs_get(state->world, tile, COMPONENT_SPRITE);
+    if (sprite != NULL) {
+      asset_set_image(sprite, tile_filepath(entity_kind));
+    }
+  }
+  ((tile_t *)ecs_get(state->world, tile, COMPONENT_TILE))->flags =
+      body_info->flags;
+  vector_t corners[4];
+  tile_corners(position, TILE_WIDTH, tile_kind_height(kind), corners);
+  body_set_shape(body, corners, 4);
+  body_set_velocity(body, velocity);
+  transform_sync(ecs_get(state->world, tile, COMPONENT_TRANSFORM), body);
+}
+
+/**
+ * Adds a slot to the ring of rows, with parked tiles.
+ */
+row_slot_t *row_slot_init(state_t *state) {
+  row_slot_t *row = malloc(sizeof(row_slot_t));
+  assert(row);
+  row->tiles = malloc(sizeof(ecs_entity_t) * MAX_TILES_PER_ROW);
+  assert(row->tiles);
+  row->num_tiles = 0;
+  row->height = 0;
+  row->active = false;
+  for (size_t i = 0; i < MAX_TILES_PER_ROW; i++) {
+    body_t *tile =
+        make_tile_of_kind(state, TILE_KIND_REGULAR, PARKED_TILE_POSITION);
     scene_add_body(state->scene, tile);
     body_info_t *body_info = (body_info_t *)body_get_info(tile);
-    asset_t *tile_asset = create_tile_type(body_info->name, tile);
-    if (strcmp(body_info->name, TILE_MOVE) == 0) {
-      size_t rand_vel_x = rand() % MAX_TILE_X_VELOCITY;
+    row->tiles[i] = spawn_body_entity(state, tile,
+                                      tile_filepath(body_info->kind),
+                                      COMPONENT_BIT(COMPONENT_TILE));
+    *(tile_t *)ecs_get(state->world, row->tiles[i], COMPONENT_TILE) =
+        (tile_t){.index = body_info->index, .flags = 0};
+  }
+  list_add(state->rows, row);
+  return row;
+}
+
+void row_slot_free(row_slot_t *row) {
+  // the tiles themselves belong to the world
+  free(row->tiles);
+  free(row);
+}
+
+/**
+ * Lays out the next random row, ROW_SEPARATION above the last one. Runs on
+ * the row generator's thread.
+ */
+void plan_row(row_planner_t *planner, row_plan_t *plan) {
+  PROFILE_FUNCTION();
+  rng_t *rng = &planner->rng;
+  size_t max_tiles = MAX.x / (2 * TILE_WIDTH);
+  size_t num_tiles = rng_below(rng, max_tiles);
+  // bound the number of tiles per row
+  if (num_tiles < MIN_TILES_PER_ROW) {
+    num_tiles = MIN_TILES_PER_ROW;
+  }
+  if (num_tiles > MAX_TILES_PER_ROW) {
+    num_tiles = MAX_TILES_PER_ROW;
+  }
+  // case for a moving tiles row
+  bool move_row = rng_below(rng, MOVE_ROW_ODDS) == 0;
+  if (move_row) {
+    num_tiles = MOVE_TILES_PER_ROW;
+  }
+  size_t x_dist = floor(MAX.x / num_tiles);
+
+  plan->height = planner->next_height;
+  plan->num_tiles = num_tiles;
+  for (size_t i = 0; i < num_tiles; i++) {
+    vector_t tile_pos = {DEFAULT_TILE_X, plan->height};
+    size_t rand_pos = rng_below(rng, x_dist);
+    // avoid overlapping tiles
+    if (rand_pos < TILE_WIDTH / 2) {
+      rand_pos = TILE_WIDTH / 2;
+    } 
+    if (rand_pos > x_dist - (TILE_WIDTH / 2)) {
+      rand_pos = x_dist - (TILE_WIDTH / 2);
+    }
+    tile_kind_t kind = TILE_KIND_MOVE;
+    vector_t tile_vel = VEC_ZERO;
+    if (!move_row) {
+      // moving tiles start at the left edge and wrap around
+      tile_pos.x = (i * x_dist) + rand_pos;
+      kind = alias_table_sample(planner->tile_kinds, rng);
+    } else {
+      size_t rand_vel_x = rng_below(rng, MAX_TILE_X_VELOCITY);
       if (rand_vel_x < MIN_TILE_X_VELOCITY) {
         rand_vel_x = MIN_TILE_X_VELOCITY;
       }
-      vector_t tile_vel = {rand_vel_x, TILE_Y_VELOCITY};
-      body_set_velocity(tile, tile_vel);
+      tile_vel = (vector_t){rand_vel_x, TILE_Y_VELOCITY};
     }
-    list_add(state->body_assets, tile_asset);
+    plan->kinds[i] = kind;
+    plan->positions[i] = tile_pos;
+    plan->velocities[i] = tile_vel;
   }
+  planner->next_height += ROW_SEPARATION;
 }
 
-void play_state_1(state_t *state) {
-  for (size_t i = 0; i < list_size(state->button_assets); i++) {
-    asset_t *asset = list_get(state->button_assets, i);
-    list_remove(state->button_assets, i);
-    free(asset);
+/**
+ * Puts the next row laid out by the row generator in a free slot of the
+ * ring, adding a slot only if every one is in use.
+ */
+void spawn_row(state_t *state) {
+  row_plan_t plan;
+  generator_next(state->row_generator, &plan);
+  row_slot_t *row = NULL;
+  for (size_t i = 0; i < list_size(state->rows) && row == NULL; i++) {
+    row_slot_t *slot = list_get(state->rows, i);
+    if (!slot->active) {
+      row = slot;
+    }
+  }
+  if (row == NULL) {
+    row = row_slot_init(state);
+  }
+
+  for (size_t i = 0; i < plan.num_tiles; i++) {
+    tile_reset(state, row->tiles[i], plan.kinds[i], plan.positions[i],
+               plan.velocities[i]);
+    row_index_add(state->tile_index,
+                  *(body_t **)ecs_get(state->world, row->tiles[i],
+                                      COMPONENT_BODY),
+                  plan.height);
   }
-  state->game_state = (char *) SINGLE_PLAYER_STATE;
+  for (size_t i = plan.num_tiles; i < MAX_TILES_PER_ROW; i++) {
+    tile_park(state, row->tiles[i]);
+  }
+  row->num_tiles = plan.num_tiles;
+  row->height = plan.height;
+  row->active = true;
+  state->highest_row = plan.height;
+}
+
+/**
+ * Parks the rows that scrolled below the camera, then puts a row in every
+ * gap the players climbed past, however far they went in one frame.
+ */
+void scroll_rows(state_t *state) {
+  PROFILE_FUNCTION();
+  double view_bottom = state->max_cam_height - MAX.y / 2;
+  for (size_t i = 0; i < list_size(state->rows); i++) {
+    row_slot_t *row = list_get(state->rows, i);
+    if (row->active && row->height + TILE_HEIGHT / 2 < view_bottom) {
+      for (size_t j = 0; j < row->num_tiles; j++) {
+        row_index_remove(state->tile_index,
+                         *(body_t **)ecs_get(state->world, row->tiles[j],
+                                             COMPONENT_BODY),
+                         row->height);
+        tile_park(state, row->tiles[j]);
+      }
+      row->active = false;
+    }
+  }
+  while (state->highest_row < state->max_cam_height) {
+    spawn_row(state);
+  }
+}
+
+/*
+ * Frees everything only the home screen uses, so its textures can be evicted
+ */
+void leave_home_screen(state_t *state) {
+  // the buttons themselves are owned by the asset cache
+  while (list_size(state->button_assets) > 0) {
+    list_remove(state->button_assets, 0);
+  }
+  if (state->home_ui != NULL) {
+    ui_free(state->home_ui);
+    state->home_ui = NULL;
+    state->loading_label = NULL;
+  }
+  while (list_size(state->button_parts) > 0) {
+    asset_destroy(list_remove(state->button_parts, 0));
+  }
+  if (state->home_scope != NULL) {
+    asset_scope_free(state->home_scope);
+    state->home_scope = NULL;
+  }
+}
+
+/**
+ * Records a game starting, if the inputs are being recorded.
+ */
+static void record_start(state_t *state, bool two_players) {
+  if (state->recording != NULL) {
+    replay_writer_add(state->recording,
+                      (replay_event_t){.type = REPLAY_START,
+                                       .tick = state->ticks,
+                                       .two_players = two_players});
+  }
+}
+
+void play_state_1(state_t *state) {
+  record_start(state, false);
+  leave_home_screen(state);
+  state->game_state = GAME_SINGLE_PLAYER;
   body_set_centroid(state->player_2, (vector_t){.x = MAX.x / 2, .y = state->max_cam_height - MAX.y/2});
 }
 
 void play_state_2(state_t *state) {
-  for (size_t i = 0; i < list_size(state->button_assets); i++) {
-    asset_t *asset = list_get(state->button_assets, i);
-    list_remove(state->button_assets, i);
-    free(asset);
-  }
-  state->game_state = (char *) DOUBLE_PLAYER_STATE;
+  record_start(state, true);
+  leave_home_screen(state);
+  state->game_state = GAME_DOUBLE_PLAYER;
+  // player 2 only takes input in two player games
+  player_input_t *input = ecs_add_component(
+      state->world, state->player_2_entity, COMPONENT_PLAYER);
+  *input = PLAYER_2_KEYS;
 }
 
 void create_gravity(state_t *state) {
-  if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0) {
+  if (state->game_state == GAME_DOUBLE_PLAYER) {
     body_set_velocity(state->player_1, 
                         (vector_t){.x = body_get_velocity(state->player_1).x,
                                     .y = body_get_velocity(state->player_1).y - GRAVITY});
@@ -654,41 +1204,259 @@ void create_gravity(state_t *state) {
   }
 }
 
-state_t *emscripten_init() {
-  asset_cache_init();
-  TTF_Init();
-  sdl_init(MIN, MAX);
+/**
+ * Builds the home screen: the background, the buttons and the loading label.
+ */
+void build_home_ui(state_t *state) {
+  SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
+  state->home_ui = ui_group_init();
+  ui_node_t *background =
+      ui_asset_init(asset_make_image(HOME_PATH, background_box), true);
+  ui_set_layer(background, LAYER_BACKGROUND);
+  ui_add_child(state->home_ui, background);
+  for (size_t i = 0; i < list_size(state->button_assets); i++) {
+    ui_add_child(state->home_ui,
+                 ui_asset_init(list_get(state->button_assets, i), false));
+  }
+  state->loading_label = ui_label_init(FONT_PATH, text_box, TEXT_COLOR, false);
+  ui_add_child(state->home_ui, state->loading_label);
+}
+
+/**
+ * Builds the in-game HUD: the score and the shield messages.
+ */
+void build_hud_ui(state_t *state) {
+  state->hud_ui = ui_group_init();
+  state->score_label = ui_label_init(FONT_PATH, text_box, TEXT_COLOR, false);
+  ui_add_child(state->hud_ui, state->score_label);
+  state->shield_label_1 =
+      ui_label_init(FONT_PATH, SHIELD_BOX_1, TEXT_COLOR, true);
+  ui_label_set_text(state->shield_label_1, ACTIVATED_MSG_1);
+  ui_set_visible(state->shield_label_1, false);
+  ui_add_child(state->hud_ui, state->shield_label_1);
+  state->shield_label_2 =
+      ui_label_init(FONT_PATH, SHIELD_BOX_2, TEXT_COLOR, true);
+  ui_label_set_text(state->shield_label_2, ACTIVATED_MSG_2);
+  ui_set_visible(state->shield_label_2, false);
+  ui_add_child(state->hud_ui, state->shield_label_2);
+}
+
+/**
+ * Builds the game over screen, showing the final score.
+ */
+void build_over_ui(state_t *state) {
+  SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
+  state->over_ui = ui_group_init();
+  ui_node_t *background =
+      ui_asset_init(asset_make_image(GAME_OVER_PATH, background_box), true);
+  ui_set_layer(background, LAYER_BACKGROUND);
+  ui_add_child(state->over_ui, background);
+  ui_node_t *final_score = ui_label_init(FONT_PATH, text_box, TEXT_COLOR, true);
+  char score_str[UI_LABEL_LEN];
+  snprintf(score_str, UI_LABEL_LEN, "FINAL SCORE: %d", state->score);
+  ui_label_set_text(final_score, score_str);
+  ui_add_child(state->over_ui, final_score);
+}
+
+/**
+ * Updates the HUD for this frame and renders it.
+ */
+void render_hud(state_t *state) {
+  char score_str[UI_LABEL_LEN];
+  snprintf(score_str, UI_LABEL_LEN, "%d", state->score);
+  ui_label_set_text(state->score_label, score_str);
+  ui_set_visible(state->shield_label_1, state->render_shield_p_1);
+  // player 2's shield only shows in two player games
+  ui_set_visible(state->shield_label_2,
+                 state->render_shield_p_2 &&
+                     state->game_state == GAME_DOUBLE_PLAYER);
+  ui_render(state->hud_ui);
+}
+
+/**
+ * Copies where every body is into its transform.
+ */
+void sync_transforms(state_t *state) {
+  PROFILE_FUNCTION();
+  ecs_query_t query =
+      ecs_query(state->world, COMPONENT_BIT(COMPONENT_TRANSFORM) |
+                                  COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    transform_t *transforms = ecs_table_column(table, COMPONENT_TRANSFORM);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      transform_sync(&transforms[i], bodies[i]);
+    }
+  }
+}
+
+/**
+ * Wraps the moving tiles around the screen edges.
+ */
+void wrap_moving_tiles(state_t *state) {
+  ecs_query_t query = ecs_query(state->world, COMPONENT_BIT(COMPONENT_TILE) |
+                                                  COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    tile_t *tiles = ecs_table_column(table, COMPONENT_TILE);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      if (tiles[i].flags & ENTITY_WRAPS) {
+        user_wrap_edges(bodies[i]);
+      }
+    }
+  }
+}
+
+/**
+ * Moves the camera to the given height.
+ *
+ * @param cam_height the height of the bottom of the view while moving up
+ * @param up whether the camera is moving up; while falling the view starts
+ *   at -cam_height instead
+ */
+void move_camera(state_t *state, double cam_height, bool up) {
+  double view_bottom = up ? cam_height : -cam_height;
+  camera_move_to(engine_get_camera(state->engine),
+                 (vector_t){.x = MIN.x, .y = view_bottom});
+}
+
+/**
+ * Renders the sprites and bullets the camera can see, skipping the rest.
+ */
+void render_visible_assets(state_t *state) {
+  camera_t *camera = engine_get_camera(state->engine);
+  ecs_query_t query =
+      ecs_query(state->world, COMPONENT_BIT(COMPONENT_TRANSFORM) |
+                                  COMPONENT_BIT(COMPONENT_SPRITE));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    transform_t *transforms = ecs_table_column(table, COMPONENT_TRANSFORM);
+    asset_t **sprites = ecs_table_column(table, COMPONENT_SPRITE);
+    for (size_t i = 0; i < ecs_table_size(table); i++) {
+      if (camera_can_see(camera, transforms[i].bounds)) {
+        asset_render(sprites[i]);
+      }
+    }
+  }
+  for (size_t i = 0; i < projectile_pool_size(state->bullets); i++) {
+    aabb_t bounds = projectile_pool_get_bounds(state->bullets, i);
+    if (camera_can_see(camera, bounds)) {
+      asset_render_in(state->bullet_sprite, bounds);
+    }
+  }
+}
+
+/**
+ * Renders a frame of play: the background, what the camera sees and the
+ * HUD. Headless games skip it.
+ */
+void render_play(state_t *state) {
+  if (state->headless) {
+    return;
+  }
+  PROFILE_FUNCTION();
+  sdl_set_layer(LAYER_BACKGROUND);
+  asset_render(state->bgd);
+  sdl_set_layer(LAYER_SPRITES);
+  render_visible_assets(state);
+  render_hud(state);
+}
+
+/**
+ * Packs the sprites into atlases, starts streaming in the assets the home
+ * screen doesn't need, and keeps the home screen's own ones resident.
+ */
+void load_assets(state_t *state) {
+  // pack the small, frequently drawn sprites into shared atlas pages
+  // (decoded in the background, like the preloads below)
+  const char *atlas_sprites[] = {
+      TILE_FILEPATH,        TILE_BREAK_FILEPATH,  TILE_MOVE_FILEPATH,
+      TILE_SPRING_FILEPATH, TILE_ROCKET_FILEPATH, TILE_SHIELD_FILEPATH,
+      BEAVER_FILEPATH,      INVADER_FILEPATH,     BULLET_FILEPATH};
+  asset_cache_pack_atlas(atlas_sprites,
+                         sizeof(atlas_sprites) / sizeof(atlas_sprites[0]));
+
+  // keep each game state's textures and sounds resident while it's active
+  state->home_scope = asset_scope_init();
+  asset_scope_retain(state->home_scope, ASSET_IMAGE, HOME_PATH);
+  asset_scope_retain(state->home_scope, ASSET_IMAGE, BUTTON_1_PATH);
+  asset_scope_retain(state->home_scope, ASSET_IMAGE, BUTTON_2_PATH);
+
+  // everything not needed by the home screen streams in while it is shown
+  const char *preload_sounds[] = {BOING_AUDIOPATH, GAME_OVER_AUDIOPATH};
+  asset_cache_preload(ASSET_SOUND, preload_sounds,
+                      sizeof(preload_sounds) / sizeof(preload_sounds[0]));
+  const char *preload_images[] = {BACKGROUND_PATH, GAME_OVER_PATH,
+                                  ROCKET_BGD_FILEPATH};
+  asset_cache_preload(ASSET_IMAGE, preload_images,
+                      sizeof(preload_images) / sizeof(preload_images[0]));
+  state->play_scope = asset_scope_init();
+  asset_scope_retain(state->play_scope, ASSET_IMAGE, BACKGROUND_PATH);
+  asset_scope_retain(state->play_scope, ASSET_IMAGE, ROCKET_BGD_FILEPATH);
+  asset_scope_retain(state->play_scope, ASSET_SOUND, BOING_AUDIOPATH);
+  // not used until the game ends, but it should be ready when it does
+  asset_scope_retain(state->play_scope, ASSET_IMAGE, GAME_OVER_PATH);
+  asset_scope_retain(state->play_scope, ASSET_SOUND, GAME_OVER_AUDIOPATH);
+}
+
+state_t *game_init(engine_t *engine, uint64_t seed) {
   state_t *state = malloc(sizeof(state_t));
   assert(state);
+  state->engine = engine;
+  state->headless = engine_is_headless(engine);
   state->scene = scene_init();
-  state->game_state = HOME_STATE;
+  state->world = ecs_init(COMPONENTS, NUM_COMPONENTS);
+  state->game_state = GAME_HOME;
   state->score = 0;
   state->invaders_activated = false;
-  srand(time(NULL));
+  state->num_invaders = 0;
+  state->invaders_capacity = SWARM_INITIAL_INVADERS;
+  state->invader_positions =
+      malloc(sizeof(vector_t) * state->invaders_capacity);
+  assert(state->invader_positions);
+  state->invader_field = flow_field_init(FLOW_FIELD_COLS, FLOW_FIELD_ROWS);
+  state->invader_hash =
+      spatial_hash_init(SWARM_SEPARATION_RADIUS, SWARM_HASH_BUCKETS);
+  state->seed = seed;
+  rng_seed(&state->rng, state->seed, 0);
+  rng_seed(&state->row_planner.rng, state->seed, ROW_STREAM);
+  state->row_planner.tile_kinds =
+      alias_table_init(TILE_KIND_WEIGHTS, NUM_TILE_KINDS);
+  state->row_planner.next_height = INITIAL_LOWEST_ROW;
+  state->row_generator =
+      generator_init(sizeof(row_plan_t), ROW_QUEUE_CAPACITY,
+                     (generator_func_t)plan_row, &state->row_planner);
+  state->stress = getenv(STRESS_ENV) != NULL;
+  state->stress_time = 0;
+  state->bullets = projectile_pool_init(
+      state->stress ? STRESS_BULLET_CAPACITY : BULLET_CAPACITY, BULLET_RADIUS);
   state->max_cam_height = 0;
-  state->current_tile_index = 0;
   state->bgd_changed = false;
   state->frames = 0;
+  state->ticks = 0;
+  state->recording = NULL;
   state->player_bounced = false;
   state->beaver_fallen = false;
   state->render_shield_p_1 = false;
   state->render_shield_p_2 = false;
 
-  if (Mix_OpenAudio(48000, MIX_DEFAULT_FORMAT, 2, 1024) < 0) {
-    printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n", Mix_GetError());
+  state->home_scope = NULL;
+  state->play_scope = NULL;
+  state->over_scope = NULL;
+  state->over_sound_played = false;
+  if (!state->headless) {
+    load_assets(state);
   }
-  Mix_Chunk *sound = Mix_LoadWAV(BOING_AUDIOPATH);
-  Mix_Chunk *game_over = Mix_LoadWAV(GAME_OVER_AUDIOPATH);
-  state->boing_audio = sound;
-  state->game_over_audio = game_over;
 
   //Iniitalizing the Beavers
-  body_info_t *body_info_player_1 = body_info_init(false, (char *)PLAYER_1_INFO, 0);
-  body_info_t *body_info_player_2 = body_info_init(false, (char *)PLAYER_2_INFO, 0);
+  body_info_t *body_info_player_1 = body_info_init(ENTITY_PLAYER_1, 0);
+  body_info_t *body_info_player_2 = body_info_init(ENTITY_PLAYER_2, 0);
   state->player_1 = body_init_with_info(make_oval(BEAVER_SIZE, BEAVER_SIZE), BEAVER_MASS, 
-                            PLAYER_COLOR, body_info_player_1, NULL);
+                            PLAYER_COLOR, body_info_player_1, free);
   state->player_2 = body_init_with_info(make_oval(BEAVER_SIZE, BEAVER_SIZE), BEAVER_MASS,
-                             PLAYER_COLOR, body_info_player_2, NULL);
+                             PLAYER_COLOR, body_info_player_2, free);
   scene_add_body(state->scene, state->player_1);
   scene_add_body(state->scene, state->player_2);
   body_set_centroid(state->player_1, USER_1_CENTER);
@@ -696,299 +1464,381 @@ state_t *emscripten_init() {
   body_set_velocity(state->player_1, (vector_t){.x = VEC_ZERO.x, INITIAL_Y_VEL});
   body_set_velocity(state->player_2, (vector_t){.x = VEC_ZERO.x, INITIAL_Y_VEL});
 
-  //Creates assets list  
-  state->body_assets = list_init(INITAL_NUM_ASSETS, (void *)asset_destroy);
-  SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
-  asset_t *asset_bgd = asset_make_image(BACKGROUND_PATH, background_box);
-  state->bgd = asset_bgd;
-  state->bgd = asset_bgd;
-  asset_t *asset_beaver_1 = asset_make_image_with_body(
-      BEAVER_FILEPATH, sdl_get_bounding_box(state->player_1), state->player_1);
-  asset_t *asset_beaver_2 = asset_make_image_with_body(
-      BEAVER_FILEPATH, sdl_get_bounding_box(state->player_2), state->player_2);
-  list_add(state->body_assets, asset_beaver_1);
-  list_add(state->body_assets, asset_beaver_2);
-
+  state->bgd = NULL;
+  set_background(state, BACKGROUND_PATH);
+  state->bullet_sprite =
+      state->headless ? NULL
+                      : asset_make_image(BULLET_FILEPATH, (SDL_Rect){0});
+  ecs_entity_t player_1_entity =
+      spawn_body_entity(state, state->player_1, BEAVER_FILEPATH,
+                        COMPONENT_BIT(COMPONENT_PLAYER));
+  *(player_input_t *)ecs_get(state->world, player_1_entity,
+                             COMPONENT_PLAYER) = PLAYER_1_KEYS;
+  state->player_2_entity =
+      spawn_body_entity(state, state->player_2, BEAVER_FILEPATH, 0);
+
+  state->rows = list_init(ROW_RING_SIZE, (free_func_t)row_slot_free);
+  state->next_tile_index = 1;
+  state->tile_index =
+      row_index_init(ROW_SEPARATION, SPRING_TILE_HEIGHT / 2.0);
+  for (size_t i = 0; i < ROW_RING_SIZE; i++) {
+    row_slot_init(state);
+  }
   for (size_t j = 0; j < INITIAL_NUM_ROWS; j++) {
-    spawn_row(INITIAL_LOWEST_ROW + ROW_SEPARATION * j, state);
-    state->highest_row = INITIAL_LOWEST_ROW + ROW_SEPARATION * j;
+    spawn_row(state);
   }
   state->score = 0;
 
-  state->button_assets = list_init(NUM_BUTTONS, (free_func_t)asset_destroy);
-  asset_t *home_bg = asset_make_image(HOME_PATH, background_box);
+  // buttons are owned by the asset cache
+  state->button_assets = list_init(NUM_BUTTONS, NULL);
+  state->button_parts = list_init(NUM_BUTTONS, (free_func_t)asset_destroy);
   state->game_over = false;
 
-  list_add(state->button_assets, home_bg);
-  add_force_creators(state);
-  create_buttons(state);
+  create_beaver_collision(state->scene, state->player_1, ELASTICITY, state);
+  create_beaver_collision(state->scene, state->player_2, ELASTICITY, state);
+  state->home_ui = NULL;
+  state->loading_label = NULL;
+  state->hud_ui = NULL;
+  state->over_ui = NULL;
+  if (!state->headless) {
+    create_buttons(state);
+    build_home_ui(state);
+    build_hud_ui(state);
+  }
+  const char *alloc_budget = getenv(ALLOC_BUDGET_ENV);
+  if (alloc_budget != NULL) {
+    ALLOC_SET_BUDGET(strtoull(alloc_budget, NULL, 10));
+  }
+  // setup is allowed to allocate; frames are counted from here
+  ALLOC_FRAME_RESET();
+  return state;
+}
+
+state_t *emscripten_init() {
+  uint64_t seed = time(NULL);
+  state_t *state = game_init(engine_init(MIN, MAX), seed);
+  const char *replay_path = getenv(REPLAY_RECORD_ENV);
+  if (replay_path != NULL) {
+    state->recording = replay_writer_init(replay_path, seed);
+    if (state->recording == NULL) {
+      fprintf(stderr, "could not record to %s\n", replay_path);
+    }
+  }
   sdl_on_key((void *)on_key);
   sdl_on_mouse((mouse_handler_t)on_click);
-  sdl_on_mouse((mouse_handler_t)on_click);
   return state;
 }
 
-bool out_of_frame(asset_t *asset, double cam_height) {
-  body_t *body = get_image_asset_body(asset);
-  if (body != NULL) {
-    vector_t centroid = body_get_centroid(body);
-    return (centroid.y + TILE_HEIGHT / 2 < cam_height);
+void game_start(state_t *state, bool two_players) {
+  if (two_players) {
+    play_state_2(state);
+  } else {
+    play_state_1(state);
   }
-  return false;
 }
 
-asset_t *activated_shield(const char *msg, const SDL_Rect box) {
-  char activated_shield[SHIELD_MSG_LEN];
-  sprintf(activated_shield, "%s", msg);
-  asset_t *shield_label = asset_make_text(FONT_PATH, box, activated_shield, TEXT_COLOR);
-  return shield_label;
+void game_key(state_t *state, char key, key_event_type_t type,
+              double held_time) {
+  on_key(key, type, held_time, state);
 }
 
-bool emscripten_main(state_t *state) {
+bool game_is_over(state_t *state) { return state->game_state == GAME_OVER; }
+
+int32_t game_get_score(state_t *state) { return state->score; }
+
+bool out_of_frame(transform_t *transform, double cam_height) {
+  return (transform->centroid.y + TILE_HEIGHT / 2 < cam_height);
+}
+
+/**
+ * Updates and renders one frame of a game state.
+ *
+ * @return whether the world moves on this frame
+ */
+typedef bool (*game_state_update_t)(state_t *state);
+
+/**
+ * Renders the home screen with the loading progress of the preloads.
+ */
+bool home_update(state_t *state) {
+  PROFILE_FUNCTION();
+  if (state->headless) {
+    return true;
+  }
+  double progress = asset_cache_preload_progress();
+  ui_set_visible(state->loading_label, progress < 1);
+  if (progress < 1) {
+    char loading_str[UI_LABEL_LEN];
+    snprintf(loading_str, UI_LABEL_LEN, "LOADING %d%%",
+             (int)(progress * PERCENT));
+    ui_label_set_text(state->loading_label, loading_str);
+  }
+  ui_render(state->home_ui);
+  return true;
+}
+
+bool double_player_update(state_t *state) {
+  PROFILE_FUNCTION();
   bool scroll_up = true;
-  state->player_bounced = false;
-  sdl_clear();
-  double dt = time_since_last_tick();
-
-  //Rendering the homescreen 
-  if (strcmp(state->game_state, HOME_STATE) == 0) {
-    for (size_t i = 0; i < list_size(state->button_assets); i++) {
-      asset_t *asset = list_get(state->button_assets, i);
-      asset_render(asset);
-    }
-  } else if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0) {
-    if (state->max_cam_height / HEIGHT_TO_SCORE_RATIO > state->score) {
-      state->score = state->max_cam_height / HEIGHT_TO_SCORE_RATIO;
-    }
-    if (state->render_shield_p_1 && state->frames > state->time_shield_1 + SHIELDING_TIME) {
-      state->render_shield_p_1 = false;
-    }
-    if (state->render_shield_p_1 && state->frames > state->time_shield_2 + SHIELDING_TIME) {
-      state->render_shield_p_2 = false;
-    }
-    // handle invaders
-    if (!state->invaders_activated) {
-      state->invader_1 = initialize_invader(state, state->player_1);
-      scene_add_body(state->scene, state->invader_1);
-      state->invader_2 = initialize_invader(state, state->player_2);
-      scene_add_body(state->scene, state->invader_2);
-      state->invaders_activated = true;
-    }
-    update_invader(state->player_1, state->invader_1);
-    update_invader(state->player_2, state->invader_2);
-    // shooting bullets from invaders
-    if (state->frames % SPAWN_TIME == 0 && state->invaders_activated) {
-      invader_shoot_bullet(state->scene, state->player_1, state->invader_1, state, state->render_shield_p_1);
-    }
-    if (state->frames % SPAWN_TIME == 0 && state->invaders_activated) {
-      invader_shoot_bullet(state->scene, state->player_2, state->invader_2, state, state->render_shield_p_2);
-    }
-    //Changing background
-    if (state->bgd_changed && (body_get_velocity(state->player_1).y < 0 && body_get_velocity(state->player_2).y < 0)) {
-      SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
-      state->bgd = asset_make_image(BACKGROUND_PATH, background_box);
-      state->bgd_changed = false;
-    }
-    double player_1_height = body_get_centroid(state->player_1).y - (BEAVER_SIZE / 2);
-    double player_2_height = body_get_centroid(state->player_2).y - (BEAVER_SIZE / 2);
-    double higher_player_height = fmax(player_1_height, player_2_height);
-    double lower_player_height = fmin(player_1_height, player_2_height);
-    state->max_cam_height = fmax(state->max_cam_height, higher_player_height);
-    create_gravity(state);
-
-    //Deleting and rendering new tiles
-    for (size_t i = 0; i < list_size(state->body_assets); i++) {
-      asset_t *asset = list_get(state->body_assets, i);
-      body_t *body = get_image_asset_body(asset);
-      if (body != NULL) {
-        if (out_of_frame(asset, state->max_cam_height - MAX.y / 2)) {
-          if (asset_is_tile(asset)) {
-            body_remove(body);
-            list_remove(state->body_assets, i);
-            asset_destroy(asset);
-            if ((state->highest_row < state->max_cam_height) && scroll_up) {
-              spawn_row(state->max_cam_height + ROW_SEPARATION, state);
-              state->highest_row = state->max_cam_height + ROW_SEPARATION;
-              add_force_creators(state);
-              state->current_tile_index = tile_index;
-            }
-          } else if (check_asset_info_field(asset, "player 2") 
-                        || check_asset_info_field(asset, "player 1")) {
-            if (!state->beaver_fallen) {
-              state->beaver_fallen = true;
-              state->frames_at_end = state->frames;
-              scroll_up = false;
-            }
-            state->max_cam_height = lower_player_height;
-          }
-        } if (state->beaver_fallen 
-                    && state->frames > state->frames_at_end + BEAVER_FALLING_FRAMES) {
-          body_remove(body);
-          list_remove(state->body_assets, i);
-          free(asset);
-          state->game_state = OVER_STATE;
+  if (state->max_cam_height / HEIGHT_TO_SCORE_RATIO > state->score) {
+    state->score = state->max_cam_height / HEIGHT_TO_SCORE_RATIO;
+  }
+  if (state->render_shield_p_1 && state->frames > state->time_shield_1 + SHIELDING_TIME) {
+    state->render_shield_p_1 = false;
+  }
+  if (state->render_shield_p_1 && state->frames > state->time_shield_2 + SHIELDING_TIME) {
+    state->render_shield_p_2 = false;
+  }
+  // handle invaders
+  if (!state->invaders_activated) {
+    spawn_invaders(state, state->stress ? STRESS_INVADERS
+                                        : INVADERS_PER_PLAYER * NUM_PLAYERS);
+    state->invaders_activated = true;
+  }
+  steer_invaders(state);
+  // shooting bullets from invaders
+  if (state->frames % SPAWN_TIME == 0 && state->invaders_activated) {
+    invaders_shoot(state);
+  }
+  if (state->stress) {
+    invaders_stress_fire(state);
+  }
+  //Changing background
+  if (state->bgd_changed && (body_get_velocity(state->player_1).y < 0 && body_get_velocity(state->player_2).y < 0)) {
+    set_background(state, BACKGROUND_PATH);
+    state->bgd_changed = false;
+  }
+  double player_1_height = body_get_centroid(state->player_1).y - (BEAVER_SIZE / 2);
+  double player_2_height = body_get_centroid(state->player_2).y - (BEAVER_SIZE / 2);
+  double higher_player_height = fmax(player_1_height, player_2_height);
+  double lower_player_height = fmin(player_1_height, player_2_height);
+  state->max_cam_height = fmax(state->max_cam_height, higher_player_height);
+  create_gravity(state);
+
+  //Recycling rows and deleting fallen players
+  scroll_rows(state);
+  sync_transforms(state);
+  ecs_query_t query = ecs_query(state->world, BODY_ENTITY);
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    transform_t *transforms = ecs_table_column(table, COMPONENT_TRANSFORM);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    const ecs_entity_t *entities = ecs_table_entities(table);
+    // from the last row down, since removing a row moves the last one into it
+    for (size_t i = ecs_table_size(table); i-- > 0;) {
+      body_info_t *body_info = (body_info_t *)body_get_info(bodies[i]);
+      if (out_of_frame(&transforms[i], state->max_cam_height - MAX.y / 2) &&
+          (body_info->flags & ENTITY_IS_PLAYER)) {
+        if (!state->beaver_fallen) {
+          state->beaver_fallen = true;
+          state->frames_at_end = state->frames;
+          scroll_up = false;
         }
+        state->max_cam_height = lower_player_height;
+      } if (state->beaver_fallen 
+                  && state->frames > state->frames_at_end + BEAVER_FALLING_FRAMES) {
+        ecs_remove(state->world, entities[i]);
+        state->game_state = GAME_OVER;
       }
     }
-    sdl_clear();
-    asset_render_with_cam(state->bgd, state->max_cam_height - MAX.y / 2, scroll_up);
-    for (size_t i = 0; i < list_size(state->body_assets); i++) {
-      asset_t *asset = list_get(state->body_assets, i);
-      asset_render_with_cam(asset, state->max_cam_height - MAX.y / 2, scroll_up);
-      body_info_t *body_info = (body_info_t *)body_get_info(get_image_asset_body(asset));
-      if (strcmp(body_info->name, TILE_MOVE) == 0) {
-        user_wrap_edges(get_image_asset_body(asset));
-      }
-    }
-    
-    char score_str[SCORE_STR_LEN];
-    sprintf(score_str, "%d", state->score);
-    asset_t *score_label = asset_make_text(FONT_PATH, text_box, score_str, TEXT_COLOR);
-    asset_render(score_label);
-    asset_destroy(score_label);
-
-    if (state->render_shield_p_1) {
-      asset_t *new_shield = activated_shield(ACTIVATED_MSG_1, SHIELD_BOX_1);
-      asset_render(new_shield);
-      asset_destroy(new_shield);
-    }
-    if (state->render_shield_p_2) {
-      asset_t *new_shield = activated_shield(ACTIVATED_MSG_2, SHIELD_BOX_2);
-      asset_render(new_shield);
-      asset_destroy(new_shield);
-    }
-    user_wrap_edges(state->player_1);
-    user_wrap_edges(state->player_2);
-  } else if (strcmp(state->game_state, SINGLE_PLAYER_STATE) == 0) {
-    if (state->max_cam_height / HEIGHT_TO_SCORE_RATIO > state->score) {
-      state->score = state->max_cam_height / HEIGHT_TO_SCORE_RATIO;
-    }
-    if (state->render_shield_p_1 && state->frames > state->time_shield_1 + SHIELDING_TIME) {
-      state->render_shield_p_1 = false;
-    }
-    // handle invaders
-    if (!state->invaders_activated) {
-      state->invader_1 = initialize_invader(state, state->player_1);
-      scene_add_body(state->scene, state->invader_1);
-      state->invaders_activated = true;
-    }
-    update_invader(state->player_1, state->invader_1);
-    if (state->frames % SPAWN_TIME == 0 && state->invaders_activated) {
-      invader_shoot_bullet(state->scene, state->player_1, state->invader_1, state, state->render_shield_p_1);
-    }
-    create_gravity(state);
+  }
+  move_camera(state, state->max_cam_height - MAX.y / 2, scroll_up);
+  render_play(state);
+  wrap_moving_tiles(state);
+  user_wrap_edges(state->player_1);
+  user_wrap_edges(state->player_2);
+  return true;
+}
 
-    // change this
-    if (state->bgd_changed && (body_get_velocity(state->player_1).y < 0)) {
-      SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
-      state->bgd = asset_make_image(BACKGROUND_PATH, background_box);
-      state->bgd_changed = false;
-    }
-    double player_1_height = body_get_centroid(state->player_1).y - (BEAVER_SIZE / 2);
-    state->max_cam_height = fmax(state->max_cam_height, player_1_height);
-
-    // just generating new rows and garbage collection
-    for (size_t i = 0; i < list_size(state->body_assets); i++) {
-      asset_t *asset = list_get(state->body_assets, i);
-      body_t *body = get_image_asset_body(asset);
-      if (body != NULL) {
-        if (out_of_frame(asset, state->max_cam_height - MAX.y / 2)) {
-          if (asset_is_tile(asset) ||  check_asset_info_field(asset, "player 2") || check_asset_info_field(asset, "bullet")) {
-            body_remove(body);
-            list_remove(state->body_assets, i);
-            asset_destroy(asset);
-            if (state->highest_row < state->max_cam_height) {
-              spawn_row(state->max_cam_height + ROW_SEPARATION, state);
-              state->highest_row = state->max_cam_height + ROW_SEPARATION;
-              add_force_creators(state);
-            }
-          }
-          else if (check_asset_info_field(asset, (void *) PLAYER_1_INFO)) {
-            if (!state->beaver_fallen) {
-              state->beaver_fallen = true;
-              state->frames_at_end = state->frames;
-              scroll_up = false;
-            }
-            state->max_cam_height = player_1_height;
+bool single_player_update(state_t *state) {
+  PROFILE_FUNCTION();
+  bool scroll_up = true;
+  if (state->max_cam_height / HEIGHT_TO_SCORE_RATIO > state->score) {
+    state->score = state->max_cam_height / HEIGHT_TO_SCORE_RATIO;
+  }
+  if (state->render_shield_p_1 && state->frames > state->time_shield_1 + SHIELDING_TIME) {
+    state->render_shield_p_1 = false;
+  }
+  // handle invaders
+  if (!state->invaders_activated) {
+    spawn_invaders(state, state->stress ? STRESS_INVADERS
+                                        : INVADERS_PER_PLAYER);
+    state->invaders_activated = true;
+  }
+  steer_invaders(state);
+  if (state->frames % SPAWN_TIME == 0 && state->invaders_activated) {
+    invaders_shoot(state);
+  }
+  if (state->stress) {
+    invaders_stress_fire(state);
+  }
+  create_gravity(state);
+
+  // change this
+  if (state->bgd_changed && (body_get_velocity(state->player_1).y < 0)) {
+    set_background(state, BACKGROUND_PATH);
+    state->bgd_changed = false;
+  }
+  double player_1_height = body_get_centroid(state->player_1).y - (BEAVER_SIZE / 2);
+  state->max_cam_height = fmax(state->max_cam_height, player_1_height);
+
+  // just recycling rows and garbage collection
+  scroll_rows(state);
+  sync_transforms(state);
+  ecs_query_t query = ecs_query(state->world, BODY_ENTITY);
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    transform_t *transforms = ecs_table_column(table, COMPONENT_TRANSFORM);
+    body_t **bodies = ecs_table_column(table, COMPONENT_BODY);
+    const ecs_entity_t *entities = ecs_table_entities(table);
+    // from the last row down, since removing a row moves the last one into it
+    for (size_t i = ecs_table_size(table); i-- > 0;) {
+      body_info_t *body_info = (body_info_t *)body_get_info(bodies[i]);
+      if (out_of_frame(&transforms[i], state->max_cam_height - MAX.y / 2)) {
+        if (body_info->kind == ENTITY_PLAYER_2) {
+          ecs_remove(state->world, entities[i]);
+        }
+        else if (body_info->kind == ENTITY_PLAYER_1) {
+          if (!state->beaver_fallen) {
+            state->beaver_fallen = true;
+            state->frames_at_end = state->frames;
+            scroll_up = false;
           }
-        } if (state->beaver_fallen && state->frames > 
-                  state->frames_at_end + BEAVER_FALLING_FRAMES) {
-          state->game_state = OVER_STATE;
+          state->max_cam_height = player_1_height;
         }
       }
     }
-    asset_render_with_cam(state->bgd, state->max_cam_height - MAX.y / 2, scroll_up);
-    for (size_t i = 0; i < list_size(state->body_assets); i++) {
-      asset_t *asset = list_get(state->body_assets, i);
-      asset_render_with_cam(asset, state->max_cam_height - MAX.y / 2, scroll_up);
-      // moving the moving tiles
-      body_info_t *body_info = (body_info_t *)body_get_info(get_image_asset_body(asset));
-      if (strcmp(body_info->name, TILE_MOVE) == 0) {
-        user_wrap_edges(get_image_asset_body(asset));
-      }
-    }
-
-    char score_str[SCORE_STR_LEN];
-    sprintf(score_str, "%d", state->score);
-    asset_t *score_label = asset_make_text(FONT_PATH, text_box, score_str, TEXT_COLOR);
-    asset_render(score_label);
-    asset_destroy(score_label);
+  }
+  if (state->beaver_fallen && state->frames >
+            state->frames_at_end + BEAVER_FALLING_FRAMES) {
+    state->game_state = GAME_OVER;
+  }
+  move_camera(state, state->max_cam_height - MAX.y / 2, scroll_up);
+  render_play(state);
+  wrap_moving_tiles(state);
+  user_wrap_edges(state->player_1);
+  return true;
+}
 
-    if (state->render_shield_p_1) {
-      asset_t *new_shield = activated_shield(ACTIVATED_MSG_1, SHIELD_BOX_1);
-      asset_render(new_shield);
-      asset_destroy(new_shield);
+/**
+ * Renders the game over screen, swapping the play assets out for its own on
+ * the first frame, plays its sound once, and stops the world.
+ */
+bool over_update(state_t *state) {
+  PROFILE_FUNCTION();
+  if (!state->headless && state->over_scope == NULL) {
+    // swap the play assets out for the game over ones
+    state->over_scope = asset_scope_init();
+    asset_scope_retain(state->over_scope, ASSET_IMAGE, GAME_OVER_PATH);
+    asset_scope_retain(state->over_scope, ASSET_SOUND, GAME_OVER_AUDIOPATH);
+    asset_scope_free(state->play_scope);
+    state->play_scope = NULL;
+    build_over_ui(state);
+  }
+  if (!state->headless) {
+    // once, but retried every frame while the sound is still preloading
+    if (!state->over_sound_played) {
+      state->over_sound_played =
+          voice_play(sdl_get_sound(GAME_OVER_AUDIOPATH), GAME_OVER_VOICE) ||
+          !asset_cache_is_loading(GAME_OVER_AUDIOPATH);
     }
-    user_wrap_edges(state->player_1);
-  } else if ((strcmp(state->game_state, OVER_STATE) == 0) || state->game_over) {
-    SDL_Rect background_box = {.x = MIN.x, .y = MIN.y, .w = MAX.x, .h = MAX.y};
-    asset_t *over_screen = asset_make_image(GAME_OVER_PATH, background_box);
-    asset_render(over_screen);
-    char score_str[SHIELD_MSG_LEN];
-    sprintf(score_str, "FINAL SCORE: %d", state->score);
-    asset_t *score_label = asset_make_text(FONT_PATH, text_box, score_str, TEXT_COLOR);
-    asset_render(score_label);
-    asset_destroy(score_label);
-
-    sdl_play_sound(state->game_over_audio);
-    for (size_t i = 0; i < list_size(state->body_assets); i++) {
-      asset_t *asset = list_get(state->body_assets, i);
-      body_t *body = get_image_asset_body(asset);
-      if (body != NULL) {
-        body_remove(body);
-        list_remove(state->body_assets, i);
-        free(asset);
-      }
+    ui_render(state->over_ui);
+  }
+
+  projectile_pool_clear(state->bullets);
+  ecs_query_t query = ecs_query(state->world, COMPONENT_BIT(COMPONENT_BODY));
+  ecs_table_t *table;
+  while ((table = ecs_query_next(&query)) != NULL) {
+    const ecs_entity_t *entities = ecs_table_entities(table);
+    for (size_t i = ecs_table_size(table); i-- > 0;) {
+      ecs_remove(state->world, entities[i]);
     }
-    sdl_show();
-    return state->game_over;
   }
-  scene_tick(state->scene, dt);
-  state->frames++;
-  if (state->player_bounced) {
-    sdl_play_sound(state->boing_audio);
+  return false;
+}
+
+const game_state_update_t GAME_STATE_UPDATES[NUM_GAME_STATES] = {
+    [GAME_HOME] = home_update,
+    [GAME_SINGLE_PLAYER] = single_player_update,
+    [GAME_DOUBLE_PLAYER] = double_player_update,
+    [GAME_OVER] = over_update};
+
+bool emscripten_main(state_t *state) {
+  PROFILE_FUNCTION();
+  state->player_bounced = false;
+  double dt = engine_tick(state->engine);
+  if (!state->headless) {
+    sdl_clear();
+    asset_cache_pump();
+  }
+
+  if (GAME_STATE_UPDATES[state->game_state](state)) {
+    tick_bullets(state, dt);
+    scene_tick(state->scene, dt);
+    state->frames++;
+    if (state->player_bounced && !state->headless) {
+      voice_play(sdl_get_sound(BOING_AUDIOPATH), BOING_VOICE);
+    }
     state->player_bounced = false;
   }
-  sdl_show();
+  if (!state->headless) {
+    sdl_show();
+  }
+  state->ticks++;
+  ALLOC_FRAME_END();
   return state->game_over;
 }
 
-void emscripten_free(state_t *state) {
-  body_free(state->player_1);
-  if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0) {
-    body_free(state->player_2);
-  }
-  body_free(state->invader_1);
-  if (strcmp(state->game_state, DOUBLE_PLAYER_STATE) == 0) {
-    body_free(state->invader_2);
+void game_free(state_t *state) {
+  if (state->recording != NULL) {
+    replay_writer_free(state->recording);
   }
-  Mix_FreeChunk(state->boing_audio);
-  Mix_FreeChunk(state->game_over_audio);
-  list_free(state->body_assets);
+  // removes the bodies from the scene, which frees them
+  ecs_free(state->world);
+  list_free(state->rows);
+  row_index_free(state->tile_index);
   list_free(state->button_assets);
-  for (size_t i = 0; i < scene_bodies(state->scene); i++) {
-    free((body_info_t *)body_get_info(scene_get_body(state->scene, i)));
+  list_free(state->button_parts);
+  if (state->home_scope != NULL) {
+    asset_scope_free(state->home_scope);
+  }
+  if (state->play_scope != NULL) {
+    asset_scope_free(state->play_scope);
+  }
+  if (state->over_scope != NULL) {
+    asset_scope_free(state->over_scope);
+  }
+  if (state->home_ui != NULL) {
+    ui_free(state->home_ui);
+  }
+  if (state->hud_ui != NULL) {
+    ui_free(state->hud_ui);
   }
+  if (state->over_ui != NULL) {
+    ui_free(state->over_ui);
+  }
+  // stopped before the alias table it samples is freed
+  generator_free(state->row_generator);
+  alias_table_free(state->row_planner.tile_kinds);
+  projectile_pool_free(state->bullets);
+  free(state->invader_positions);
+  flow_field_free(state->invader_field);
+  spatial_hash_free(state->invader_hash);
+  if (state->bullet_sprite != NULL) {
+    asset_destroy(state->bullet_sprite);
+  }
+  if (state->bgd != NULL) {
+    asset_destroy(state->bgd);
+  }
+  // frees the bodies, and with them their body_info_t's
   scene_free(state->scene);
   free(state);
 }
+
+void emscripten_free(state_t *state) {
+  PROFILE_WRITE(PROFILE_TRACE_PATH);
+  ALLOC_REPORT(stdout);
+  engine_t *engine = state->engine;
+  game_free(state);
+  engine_free(engine);
+}
@@ -0,0 +1,82 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "engine.h"
+#include "game.h"
+#include "replay.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
+/**
+ * Plays recorded games again without a window, one after another, at the
+ * inputs' recorded frames:
+ *
+ *   bin/replayer <replays...>
+ *
+ * Record one by running the windowed game with REPLAY_RECORD=<file> set.
+ * Frames are replayed at a fixed time step rather than the recorded one, so
+ * a replay plays like its game without matching it exactly. A game ends at
+ * its game over screen, or REPLAY_TAIL_TICKS after its last input.
+ */
+
+const vector_t REPLAY_MIN = {0, 0};
+const vector_t REPLAY_MAX = {1000, 500};
+const double REPLAY_DT = 1.0 / 60;
+const size_t REPLAY_TAIL_TICKS = 600;
+
+/**
+ * Plays one replay to its end on a fresh headless engine.
+ *
+ * @return the number of frames played
+ */
+static size_t play_replay(replay_t *replay, int32_t *score) {
+  engine_t *engine = engine_init_headless(REPLAY_MIN, REPLAY_MAX, REPLAY_DT);
+  state_t *state = game_init(engine, replay_get_seed(replay));
+  size_t num_events = replay_num_events(replay);
+  size_t end_tick =
+      (num_events > 0 ? replay_get_event(replay, num_events - 1)->tick : 0) +
+      REPLAY_TAIL_TICKS;
+
+  size_t next_event = 0;
+  size_t tick = 0;
+  while (tick < end_tick && !game_is_over(state)) {
+    while (next_event < num_events &&
+           replay_get_event(replay, next_event)->tick <= tick) {
+      const replay_event_t *event = replay_get_event(replay, next_event);
+      if (event->type == REPLAY_START) {
+        game_start(state, event->two_players);
+      } else {
+        game_key(state, event->key, event->key_type, event->held_time);
+      }
+      next_event++;
+    }
+    emscripten_main(state);
+    tick++;
+  }
+
+  *score = game_get_score(state);
+  game_free(state);
+  engine_free(engine);
+  return tick;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <replays...>\n", argv[0]);
+    return 1;
+  }
+  for (int i = 1; i < argc; i++) {
+    replay_t *replay = replay_load(argv[i]);
+    if (replay == NULL) {
+      fprintf(stderr, "could not read replay %s\n", argv[i]);
+      return 1;
+    }
+    int32_t score;
+    size_t ticks = play_replay(replay, &score);
+    printf("%s: %zu ticks, score %d\n", argv[i], ticks, score);
+    replay_free(replay);
+  }
+  return 0;
+}
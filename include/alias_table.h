@@ -0,0 +1,39 @@
+#ifndef __ALIAS_TABLE_H__
+#define __ALIAS_TABLE_H__
+
+#include <stddef.h>
+
+#include "rng.h"
+
+/**
+ * A discrete distribution over the indices 0..n-1 in proportion to their
+ * weights, sampled in constant time with Walker's alias method.
+ */
+typedef struct alias_table alias_table_t;
+
+/**
+ * Builds the table for the given weights.
+ *
+ * @param weights n non-negative weights, at least one of them positive
+ * @param n the number of weights
+ * @return the new table
+ */
+alias_table_t *alias_table_init(const double *weights, size_t n);
+
+/**
+ * Draws an index with probability weights[i] / sum(weights).
+ *
+ * @param table the table
+ * @param rng the generator to draw from
+ * @return the sampled index
+ */
+size_t alias_table_sample(alias_table_t *table, rng_t *rng);
+
+/**
+ * Frees the table.
+ *
+ * @param table the table to free
+ */
+void alias_table_free(alias_table_t *table);
+
+#endif // #ifndef __ALIAS_TABLE_H__
@@ -0,0 +1,112 @@
+#ifndef __ALLOC_TRACK_H__
+#define __ALLOC_TRACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Counts the allocations made in each frame, by the subsystem that made
+ * them, so the ones in per-frame code can be found and kept out.
+ *
+ * A source file opts in by including this header after every other header
+ * and naming its subsystem:
+ *
+ *   #include "alloc_track.h"
+ *   ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+ *
+ * Built with -DALLOC_TRACK (`make ALLOC_TRACK=true ...`, after a
+ * `make clean`), malloc, calloc and realloc in such files are counted
+ * against the calling thread's current frame. Frees are not counted. A
+ * frame ends when its thread calls ALLOC_FRAME_END; allocations on threads
+ * that never do (loaders, generators, the render thread) are not reported.
+ * Otherwise all the macros but ALLOC_SUBSYSTEM expand to nothing.
+ */
+
+typedef enum {
+  // containers and threading shared by everything
+  ALLOC_CORE,
+  // bodies, shapes, collisions and the structures that find them
+  ALLOC_PHYSICS,
+  // draw queues, text and UI
+  ALLOC_RENDER,
+  // the asset cache and what it loads
+  ALLOC_ASSETS,
+  // the game itself
+  ALLOC_GAME,
+  // the number of subsystems, not a subsystem itself
+  NUM_ALLOC_SUBSYSTEMS
+} alloc_subsystem_t;
+
+/**
+ * Names the subsystem the allocations of this file count against.
+ */
+#define ALLOC_SUBSYSTEM(subsystem)                                             \
+  static const alloc_subsystem_t ALLOC_FILE_SUBSYSTEM                          \
+      __attribute__((unused)) = subsystem
+
+#ifdef ALLOC_TRACK
+
+void *alloc_track_malloc(size_t size, alloc_subsystem_t subsystem);
+
+void *alloc_track_calloc(size_t count, size_t size,
+                         alloc_subsystem_t subsystem);
+
+void *alloc_track_realloc(void *ptr, size_t size, alloc_subsystem_t subsystem);
+
+/**
+ * Drops what the calling thread allocated since its last frame ended, e.g.
+ * the setup before the first frame.
+ */
+void alloc_track_frame_reset(void);
+
+/**
+ * Gets how many allocations the calling thread made since its last frame
+ * ended.
+ *
+ * @return the number of allocations
+ */
+size_t alloc_track_frame_allocs(void);
+
+/**
+ * Ends the calling thread's frame, adding it to the totals. If the frame
+ * went over the thread's budget, prints what it allocated and fails an
+ * assertion.
+ */
+void alloc_track_frame_end(void);
+
+/**
+ * Sets how many allocations each of the calling thread's frames may make.
+ *
+ * @param max_allocs the most allocations a frame may make
+ */
+void alloc_track_set_budget(size_t max_allocs);
+
+/**
+ * Prints the allocations per frame of each subsystem, over every frame
+ * ended so far on any thread, and the worst frame.
+ *
+ * @param file where to print
+ */
+void alloc_track_report(FILE *file);
+
+#define malloc(size) alloc_track_malloc(size, ALLOC_FILE_SUBSYSTEM)
+#define calloc(count, size) alloc_track_calloc(count, size, ALLOC_FILE_SUBSYSTEM)
+#define realloc(ptr, size) alloc_track_realloc(ptr, size, ALLOC_FILE_SUBSYSTEM)
+
+#define ALLOC_FRAME_RESET() alloc_track_frame_reset()
+#define ALLOC_FRAME_END() alloc_track_frame_end()
+#define ALLOC_SET_BUDGET(max_allocs) alloc_track_set_budget(max_allocs)
+#define ALLOC_REPORT(file) alloc_track_report(file)
+
+#else
+
+#define ALLOC_FRAME_RESET() ((void)0)
+#define ALLOC_FRAME_END() ((void)0)
+#define ALLOC_SET_BUDGET(max_allocs) ((void)0)
+#define ALLOC_REPORT(file) ((void)0)
+
+#endif // #ifdef ALLOC_TRACK
+
+#endif // #ifndef __ALLOC_TRACK_H__
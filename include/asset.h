@@ -4,10 +4,11 @@
 #include <SDL2/SDL_image.h>
 #include <SDL2/SDL_ttf.h>
 #include <color.h>
+#include <entity.h>
 #include <sdl_wrapper.h>
 #include <stddef.h>
 
-typedef enum { ASSET_IMAGE, ASSET_FONT, ASSET_BUTTON } asset_type_t;
+typedef enum { ASSET_IMAGE, ASSET_FONT, ASSET_BUTTON, ASSET_SOUND } asset_type_t;
 
 typedef struct asset asset_t;
 
@@ -27,12 +28,12 @@ asset_type_t asset_get_type(asset_t *asset);
 body_t *get_image_asset_body(asset_t *asset);
 
 /**
- * Checks if the asset's info field matches the info_field passed in
- * @param info_field the info field to be checked
- * 
- * @return a boolean if the asset's info field matches
+ * Checks if the asset is drawn for a body of the given kind
+ * @param kind the kind of entity to check for
+ *
+ * @return a boolean if the asset's body is of that kind
  */
-bool check_asset_info_field(asset_t *asset, char *info_field);
+bool asset_is_entity(asset_t *asset, entity_kind_t kind);
 
 /**
  * Checks if the asset is a tile
@@ -69,6 +70,15 @@ asset_t *asset_make_image(const char *filepath, SDL_Rect bounding_box);
 asset_t *asset_make_image_with_body(const char *filepath, SDL_Rect bounding,
                                     body_t *body);
 
+/**
+ * Changes the image an image asset draws, e.g. when its body is reused for
+ * something else.
+ *
+ * @param asset an image asset
+ * @param filepath the filepath to the new image file
+ */
+void asset_set_image(asset_t *asset, const char *filepath);
+
 /**
  * Allocates memory for a text asset with the given parameters.
  *
@@ -82,6 +92,20 @@ asset_t *asset_make_image_with_body(const char *filepath, SDL_Rect bounding,
 asset_t *asset_make_text(const char *filepath, SDL_Rect bounding_box,
                          const char *text, rgb_color_t color);
 
+/**
+ * Allocates memory for a text asset whose text rarely changes, like a label
+ * or a button caption. It is drawn from a cached texture of the whole string.
+ *
+ * @param filepath the filepath to the .ttf file
+ * @param bounding_box the bounding box containing the location and dimensions
+ * of the text when it is rendered
+ * @param text the text to render
+ * @param color the color of the text
+ * @return a pointer to the newly allocated text asset
+ */
+asset_t *asset_make_static_text(const char *filepath, SDL_Rect bounding_box,
+                                const char *text, rgb_color_t color);
+
 /**
  * A button handler.
  *
@@ -125,17 +149,18 @@ void asset_on_button_click(asset_t *button, state_t *state, double x, double y);
  */
 void asset_render(asset_t *asset);
 
-
 /**
- * Renders the asset to the screen in the frame of the camera
- * @param asset the asset to render
- * @param cam_height the camera's height relative to the original MIN, MAX frame
- *                      definition
- * @param up whether the camera is moving up or down
+ * Renders an image asset into a box of the world instead of its own
+ * bounding box, so one asset can draw any number of things without bodies.
+ * @param asset the image asset to render
+ * @param bounds where to draw it, in world units
  */
-void asset_render_with_cam(asset_t *asset, double cam_height, bool up);
+void asset_render_in(asset_t *asset, aabb_t bounds);
+
+
 /**
- * Frees the memory allocated for the asset.
+ * Frees the memory allocated for the asset. Image assets also release their
+ * reference on the cached image.
  * @param asset the asset to free
  */
 void asset_destroy(asset_t *asset);
@@ -4,6 +4,38 @@
 #include "asset.h"
 #include <stddef.h>
 
+/**
+ * A drawable image: a texture plus the region of it that holds the image.
+ * Images packed into an atlas share their texture with other sprites, so
+ * `src` must always be passed along when rendering.
+ */
+typedef struct sprite {
+  SDL_Texture *texture;
+  SDL_Rect src;
+} sprite_t;
+
+/**
+ * A set of cached assets kept resident together, e.g. everything one game
+ * state needs. Freeing the scope releases all of them at once.
+ */
+typedef struct asset_scope asset_scope_t;
+
+/**
+ * A snapshot of the cache's memory use.
+ */
+typedef struct asset_cache_usage {
+  // the limit set with asset_cache_set_budget
+  size_t budget_bytes;
+  // textures and sounds the cache may evict once unreferenced
+  size_t evictable_bytes;
+  // shared atlas pages, which stay resident for the cache's lifetime
+  size_t atlas_bytes;
+  // entries currently in memory
+  size_t num_resident;
+  // entries evicted (or never loaded), reloaded on their next use
+  size_t num_evicted;
+} asset_cache_usage_t;
+
 /**
  * Initializes the empty, list-based global asset cache. The caller must then
  * destroy the cache with `asset_cache_destroy` when done.
@@ -15,6 +47,17 @@ void asset_cache_init();
  */
 void asset_cache_destroy();
 
+/**
+ * Mounts a pack made by `bin/bake_assets`. From then on, assets found in the
+ * pack are uploaded straight from the memory-mapped file instead of being
+ * decoded from their original files; anything else still loads as before.
+ * Must be called before any asset is loaded.
+ *
+ * @param path the filepath of the pack
+ * @return whether the pack was found and mounted
+ */
+bool asset_cache_mount_pack(const char *path);
+
 /**
  * Gets the pointer to the object that is associated with the given filepath.
  * If the object exists, asserts that its type matches the given type.
@@ -29,14 +72,144 @@ void asset_cache_destroy();
  *
  * char *font_path = "assets/font.ttf";
  * TTF_Font *obj = asset_cache_obj_get_or_create(ASSET_FONT, font_path);
+ *
+ * char *sound_path = "assets/sound.wav";
+ * Mix_Chunk *obj = asset_cache_obj_get_or_create(ASSET_SOUND, sound_path);
  * ```
  *
+ * For images packed with `asset_cache_pack_atlas` this is the whole atlas
+ * page; use `asset_cache_get_sprite` to also get the image's region.
+ * Assets that are still being preloaded return NULL, and so do files that
+ * failed to load, which aren't tried again.
+ *
+ * The object is not referenced, so it may be evicted (and reloaded on the
+ * next call) once the cache is over budget. Hold assets you keep using in
+ * an asset scope.
+ *
  * @param ty the type of the asset
  * @param filepath the filepath to the asset
  * @return the object that corresponds to the filepath, as a void*
  */
 void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath);
 
+/**
+ * Queues the given images to be decoded in the background and packed into as
+ * few shared atlas textures as possible. Once the whole batch is decoded,
+ * asset_cache_pump packs it and each image is served from the cache as a
+ * sub-rectangle of its atlas page, so sprites that share a page also share
+ * one SDL_Texture.
+ *
+ * Images that are already cached are left alone, and images too large to fit
+ * on a page get a texture of their own.
+ *
+ * @param filepaths the filepaths of the images to pack
+ * @param num_paths the number of filepaths
+ */
+void asset_cache_pack_atlas(const char **filepaths, size_t num_paths);
+
+/**
+ * Queues images or sounds to be decoded on background threads. The files
+ * are added to the cache right away as loading placeholders and are filled
+ * in by asset_cache_pump as their decodes finish. Until then, their sprites
+ * have a NULL texture and their sounds are NULL.
+ *
+ * Asserts that `ty` is ASSET_IMAGE or ASSET_SOUND.
+ *
+ * @param ty the type of the assets
+ * @param filepaths the filepaths of the assets
+ * @param num_paths the number of filepaths
+ */
+void asset_cache_preload(asset_type_t ty, const char **filepaths,
+                         size_t num_paths);
+
+/**
+ * Checks whether a file queued with asset_cache_preload or
+ * asset_cache_pack_atlas is still being decoded.
+ *
+ * @param filepath the filepath of the asset
+ * @return whether the asset is still loading; false once it is ready, failed
+ *   or if it was never queued
+ */
+bool asset_cache_is_loading(const char *filepath);
+
+/**
+ * Uploads a few finished background decodes into the cache. Must be called
+ * on the main thread, once per frame, while anything is being preloaded.
+ * Without thread support, this also does the decoding, one file per call.
+ */
+void asset_cache_pump(void);
+
+/**
+ * Gets how much of everything queued with asset_cache_preload and
+ * asset_cache_pack_atlas is ready to use.
+ *
+ * @return the finished fraction, between 0 and 1 (1 if nothing was queued)
+ */
+double asset_cache_preload_progress(void);
+
+/**
+ * Gets the sprite for the image at the given filepath, loading the image
+ * into the cache if it isn't there yet, and takes a reference on it.
+ * The image won't be evicted until every reference is released with
+ * asset_cache_release_sprite. The sprite is owned by the cache and stays
+ * valid until asset_cache_destroy. Its texture is NULL while the image is
+ * still being preloaded.
+ *
+ * @param filepath the filepath to the image
+ * @return the texture holding the image and the region it occupies
+ */
+const sprite_t *asset_cache_acquire_sprite(const char *filepath);
+
+/**
+ * Releases a reference taken with asset_cache_acquire_sprite. Once nothing
+ * references the image, it may be evicted to stay within the budget.
+ *
+ * @param sprite a sprite returned from asset_cache_acquire_sprite
+ */
+void asset_cache_release_sprite(const sprite_t *sprite);
+
+/**
+ * Allocates an empty asset scope.
+ *
+ * @return the new scope, to be freed with asset_scope_free
+ */
+asset_scope_t *asset_scope_init(void);
+
+/**
+ * Takes a reference on the asset at the given filepath for as long as the
+ * scope lives, loading it if it isn't cached (or being preloaded) yet.
+ *
+ * @param scope a scope returned from asset_scope_init
+ * @param ty the type of the asset
+ * @param filepath the filepath to the asset
+ */
+void asset_scope_retain(asset_scope_t *scope, asset_type_t ty,
+                        const char *filepath);
+
+/**
+ * Releases every reference held by the scope and frees it.
+ *
+ * @param scope a scope returned from asset_scope_init
+ */
+void asset_scope_free(asset_scope_t *scope);
+
+/**
+ * Sets how many bytes of textures and sounds the cache keeps around.
+ * Whenever it is over budget, unreferenced assets are evicted, least
+ * recently used first. Referenced assets and atlas pages are never evicted,
+ * so the cache can stay above budget while they are in use.
+ *
+ * @param budget_bytes the memory budget in bytes
+ */
+void asset_cache_set_budget(size_t budget_bytes);
+
+/**
+ * Reports the current memory use of the cache.
+ *
+ * @return the cache's usage and budget
+ */
+asset_cache_usage_t asset_cache_get_usage(void);
+
 /**
  * Registers the button to the asset cache, effectively activating its button
  * handler. When this function is called, the asset_cache takes ownership of the
@@ -0,0 +1,119 @@
+#ifndef __ASSET_PACK_H__
+#define __ASSET_PACK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * A pre-baked asset pack: every asset in one file, already decoded, so it can
+ * be memory mapped and handed to SDL without any decompression.
+ *
+ * Layout: a pack_header_t, then the data of each entry (each starting on a
+ * PACK_ALIGNMENT boundary), then the index, an array of `num_entries`
+ * pack_entry_t sorted by path. All integers are little-endian.
+ */
+
+#define PACK_PATH_LEN 64
+#define PACK_ALIGNMENT 16
+
+extern const char PACK_MAGIC[4];
+extern const uint32_t PACK_VERSION;
+
+typedef enum {
+  // decoded pixels of an image with its own texture
+  PACK_IMAGE,
+  // decoded pixels of an atlas page shared by PACK_SPRITEs
+  PACK_ATLAS_PAGE,
+  // an image living in a region of an atlas page (no data of its own)
+  PACK_SPRITE,
+  // PCM samples in the format given by the entry
+  PACK_SOUND,
+  // the raw bytes of a font file
+  PACK_FONT
+} pack_entry_type_t;
+
+typedef struct pack_header {
+  char magic[4];
+  uint32_t version;
+  uint32_t num_entries;
+  uint32_t reserved;
+  uint64_t index_offset;
+} pack_header_t;
+
+typedef struct pack_entry {
+  // the asset's filepath, or "#page<n>" for atlas pages
+  char path[PACK_PATH_LEN];
+  uint32_t type;
+  // images/pages: SDL pixel format; sounds: SDL audio format
+  uint32_t format;
+  // images/pages/sprites: size in pixels, and bytes per row of pixels
+  uint32_t width;
+  uint32_t height;
+  uint32_t pitch;
+  // sprites: the atlas page they live on, and their position on it
+  uint32_t page;
+  int32_t x;
+  int32_t y;
+  // sounds: samples per second and number of channels
+  uint32_t freq;
+  uint32_t channels;
+  // where the entry's data starts in the file, and its size in bytes
+  uint64_t offset;
+  uint64_t size;
+} pack_entry_t;
+
+typedef struct asset_pack asset_pack_t;
+
+/**
+ * Memory maps the pack at the given path and checks its header, and that
+ * its index and the data of every entry lie inside the file.
+ *
+ * @param path the filepath of the pack
+ * @return the opened pack, or NULL if it is missing or not a valid pack
+ */
+asset_pack_t *asset_pack_open(const char *path);
+
+/**
+ * Unmaps the pack. Any data pointers into it become invalid.
+ *
+ * @param pack a pack returned from asset_pack_open
+ */
+void asset_pack_close(asset_pack_t *pack);
+
+/**
+ * Looks up an entry by the filepath it was baked from.
+ *
+ * @param pack a pack returned from asset_pack_open
+ * @param path the filepath of the asset
+ * @return the entry, or NULL if the pack doesn't contain the asset
+ */
+const pack_entry_t *asset_pack_find(asset_pack_t *pack, const char *path);
+
+/**
+ * Looks up the atlas page with the given number.
+ *
+ * @param pack a pack returned from asset_pack_open
+ * @param page the `page` field of a PACK_SPRITE entry
+ * @return the page entry, or NULL if there is no such page
+ */
+const pack_entry_t *asset_pack_find_page(asset_pack_t *pack, uint32_t page);
+
+/**
+ * Gets a pointer to an entry's data inside the mapped pack.
+ *
+ * @param pack a pack returned from asset_pack_open
+ * @param entry an entry of the pack
+ * @return the entry's data, valid until asset_pack_close
+ */
+const void *asset_pack_data(asset_pack_t *pack, const pack_entry_t *entry);
+
+/**
+ * Writes the name of an atlas page entry ("#page<n>") into `path`.
+ *
+ * @param path a buffer of at least PACK_PATH_LEN chars
+ * @param page the page number
+ */
+void asset_pack_page_name(char *path, uint32_t page);
+
+#endif // #ifndef __ASSET_PACK_H__
@@ -0,0 +1,52 @@
+#ifndef __ATLAS_H__
+#define __ATLAS_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+
+/**
+ * Transparent pixels left between packed images, so texture filtering never
+ * samples a neighbouring image.
+ */
+extern const int ATLAS_PADDING;
+
+/**
+ * A shelf packer filling one square atlas page. Images are placed left to
+ * right along a shelf; a new shelf starts below the tallest image of the
+ * previous one. Placing images tallest first keeps the shelves tight.
+ */
+typedef struct atlas_shelf {
+  int page_size;
+  int pen_x;
+  int pen_y;
+  int shelf_height;
+} atlas_shelf_t;
+
+/**
+ * Initializes an empty shelf packer for a page of the given size.
+ *
+ * @param shelf the packer to initialize
+ * @param page_size the width and height of the page in pixels
+ */
+void atlas_shelf_init(atlas_shelf_t *shelf, int page_size);
+
+/**
+ * Finds room for a `w` by `h` image on the page.
+ *
+ * @param shelf the packer for the page
+ * @param w the width of the image
+ * @param h the height of the image
+ * @param out set to the image's region of the page if it fits
+ * @return whether the image fit on the page
+ */
+bool atlas_shelf_place(atlas_shelf_t *shelf, int w, int h, SDL_Rect *out);
+
+/**
+ * Gets the number of rows of the page used so far.
+ *
+ * @param shelf the packer for the page
+ * @return the height of the used part of the page
+ */
+int atlas_shelf_used_height(atlas_shelf_t *shelf);
+
+#endif // #ifndef __ATLAS_H__
@@ -52,6 +52,14 @@ void body_free(body_t *body);
  */
 list_t *body_get_shape(body_t *body);
 
+/**
+ * Gets the current bounding box of a body, without copying its shape.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @return the body's axis-aligned bounding box
+ */
+aabb_t body_get_aabb(body_t *body);
+
 /**
  * Gets the current center of mass of a body.
  * While this could be calculated with polygon_centroid(), that becomes too slow
@@ -127,6 +135,17 @@ void body_set_color(body_t *body, rgb_color_t *col);
  */
 void body_set_centroid(body_t *body, vector_t x);
 
+/**
+ * Gives a body a new shape, reusing its vertices instead of allocating new
+ * ones. Keeps its velocity, mass and info.
+ *
+ * @param body a pointer to a body returned from body_init()
+ * @param points the vertices of the new shape
+ * @param num_points the number of vertices, which must be the number the
+ *   body's shape already has
+ */
+void body_set_shape(body_t *body, const vector_t *points, size_t num_points);
+
 /**
  * Changes a body's velocity (the time-derivative of its position).
  *
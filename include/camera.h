@@ -0,0 +1,87 @@
+#ifndef __CAMERA_H__
+#define __CAMERA_H__
+
+#include <stdbool.h>
+
+#include "polygon.h"
+#include "vector.h"
+
+/**
+ * A camera looking at a rectangle of the world. Anything whose bounding box
+ * misses the view rectangle can be skipped when rendering.
+ *
+ * The camera also maps world coordinates to window pixels. The transform is
+ * only recomputed when the camera moves or the window is resized, so mapping
+ * a point costs one multiply-add per axis.
+ */
+typedef struct camera camera_t;
+
+/**
+ * Allocates a camera whose view starts at the world origin, drawn into a
+ * viewport of one pixel per world unit until `camera_set_viewport`.
+ *
+ * @param view_size the width and height of the view, in world units
+ * @return the new camera
+ */
+camera_t *camera_init(vector_t view_size);
+
+/**
+ * Moves the view so its lower left corner is at the given point.
+ *
+ * @param camera the camera to move
+ * @param origin the new lower left corner of the view, in world units
+ */
+void camera_move_to(camera_t *camera, vector_t origin);
+
+/**
+ * Sets the size of the window the view is drawn into. The view is scaled
+ * uniformly to fit and centered.
+ *
+ * @param camera the camera
+ * @param viewport the width and height of the window, in pixels
+ */
+void camera_set_viewport(camera_t *camera, vector_t viewport);
+
+/**
+ * Gets the size of the window the view is drawn into.
+ *
+ * @param camera the camera
+ * @return the width and height of the window, in pixels
+ */
+vector_t camera_get_viewport(camera_t *camera);
+
+/**
+ * Gets the part of the world the camera currently sees.
+ *
+ * @param camera the camera
+ * @return the view rectangle, in world units
+ */
+aabb_t camera_get_view(camera_t *camera);
+
+/**
+ * Checks whether anything inside the given bounding box is visible.
+ *
+ * @param camera the camera
+ * @param bounds a bounding box in world units, e.g. from body_get_aabb
+ * @return whether the box overlaps the view
+ */
+bool camera_can_see(camera_t *camera, aabb_t bounds);
+
+/**
+ * Maps a world coordinate to a window coordinate. Positive y is up in the
+ * world and down in the window.
+ *
+ * @param camera the camera
+ * @param world a position in world units
+ * @return the position in pixels, not rounded
+ */
+vector_t camera_to_pixel(camera_t *camera, vector_t world);
+
+/**
+ * Frees the camera.
+ *
+ * @param camera the camera to free
+ */
+void camera_free(camera_t *camera);
+
+#endif // #ifndef __CAMERA_H__
@@ -0,0 +1,178 @@
+#ifndef __ECS_H__
+#define __ECS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "list.h"
+
+/**
+ * An entity component system. Entities are handles; their data lives in
+ * components, numbered 0..num_components-1 by the user of the world.
+ * Entities with the same set of components share an archetype table that
+ * stores each component in its own contiguous column, so a system iterates
+ * only the tables that have what it needs, row by row.
+ */
+typedef struct ecs ecs_t;
+
+/**
+ * One archetype: every entity with exactly one set of components.
+ */
+typedef struct ecs_table ecs_table_t;
+
+/**
+ * A handle to an entity. Stays invalid once the entity is removed, even if
+ * its slot is reused.
+ */
+typedef uint32_t ecs_entity_t;
+
+/**
+ * A set of components, with bit i set for component i.
+ */
+typedef uint32_t component_mask_t;
+
+#define ECS_MAX_COMPONENTS 32
+#define COMPONENT_BIT(component) ((component_mask_t)1 << (component))
+
+/**
+ * How a world stores one component.
+ */
+typedef struct ecs_component_info {
+  size_t size;
+  // if non-NULL, called with a pointer to the component when its entity is
+  // removed, when it is removed from its entity, and by ecs_free()
+  free_func_t freer;
+} ecs_component_info_t;
+
+/**
+ * Iterates the tables that have a set of components.
+ */
+typedef struct ecs_query {
+  ecs_t *ecs;
+  component_mask_t mask;
+  size_t next_table;
+} ecs_query_t;
+
+/**
+ * Allocates an empty world.
+ *
+ * @param components how each component is stored, indexed by component
+ * @param num_components the number of components, at most ECS_MAX_COMPONENTS
+ * @return the new world
+ */
+ecs_t *ecs_init(const ecs_component_info_t *components, size_t num_components);
+
+/**
+ * Frees the world, calling the freers of every component still in it.
+ *
+ * @param ecs the world to free
+ */
+void ecs_free(ecs_t *ecs);
+
+/**
+ * Adds an entity with the given components, all zeroed.
+ *
+ * @param ecs the world
+ * @param mask the components of the entity
+ * @return the new entity
+ */
+ecs_entity_t ecs_spawn(ecs_t *ecs, component_mask_t mask);
+
+/**
+ * Removes an entity and frees its components.
+ * The last entity of its table takes its row.
+ *
+ * @param ecs the world
+ * @param entity an entity of the world that wasn't removed yet
+ */
+void ecs_remove(ecs_t *ecs, ecs_entity_t entity);
+
+/**
+ * Checks whether an entity is still in the world.
+ *
+ * @param ecs the world
+ * @param entity the entity
+ * @return false if the entity was removed
+ */
+bool ecs_is_alive(ecs_t *ecs, ecs_entity_t entity);
+
+/**
+ * Gets one component of an entity. The pointer is valid until an entity is
+ * added to, removed from or moved out of the entity's table.
+ *
+ * @param ecs the world
+ * @param entity an entity of the world
+ * @param component the component
+ * @return the component, or NULL if the entity doesn't have it
+ */
+void *ecs_get(ecs_t *ecs, ecs_entity_t entity, size_t component);
+
+/**
+ * Adds a component to an entity, moving it to the table of its new set of
+ * components.
+ *
+ * @param ecs the world
+ * @param entity an entity of the world without the component
+ * @param component the component to add
+ * @return the new component, zeroed
+ */
+void *ecs_add_component(ecs_t *ecs, ecs_entity_t entity, size_t component);
+
+/**
+ * Frees a component of an entity and removes it, moving the entity to the
+ * table of its new set of components.
+ *
+ * @param ecs the world
+ * @param entity an entity of the world with the component
+ * @param component the component to remove
+ */
+void ecs_remove_component(ecs_t *ecs, ecs_entity_t entity, size_t component);
+
+/**
+ * Starts iterating the tables whose entities have (at least) the given
+ * components.
+ *
+ * @param ecs the world
+ * @param mask the components to look for
+ * @return the query, for ecs_query_next()
+ */
+ecs_query_t ecs_query(ecs_t *ecs, component_mask_t mask);
+
+/**
+ * Gets the next non-empty table of a query.
+ * Rows may be removed from the table while iterating it, from the last row
+ * down; tables added meanwhile are visited too.
+ *
+ * @param query a query from ecs_query()
+ * @return the table, or NULL once every table was visited
+ */
+ecs_table_t *ecs_query_next(ecs_query_t *query);
+
+/**
+ * Gets the number of entities (rows) in a table.
+ *
+ * @param table a table of a world
+ * @return the number of rows
+ */
+size_t ecs_table_size(ecs_table_t *table);
+
+/**
+ * Gets the column of one component of a table: an array of ecs_table_size()
+ * components. It moves when rows are added to the table.
+ *
+ * @param table a table of a world
+ * @param component a component the table has
+ * @return the column
+ */
+void *ecs_table_column(ecs_table_t *table, size_t component);
+
+/**
+ * Gets the entity of each row of a table.
+ *
+ * @param table a table of a world
+ * @return an array of ecs_table_size() entities
+ */
+const ecs_entity_t *ecs_table_entities(ecs_table_t *table);
+
+#endif // #ifndef __ECS_H__
@@ -0,0 +1,76 @@
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+#include <stdbool.h>
+
+#include "camera.h"
+#include "vector.h"
+
+/**
+ * What a game runs on: the camera it scrolls and the clock its frames are
+ * timed by. Every game gets its own engine, so any number of games can run
+ * in one process, each on its own thread.
+ *
+ * A windowed engine also brings up the display, fonts, audio and asset
+ * cache. There is only one window, so at most one windowed engine may exist
+ * at a time. A headless engine has none of these and never touches them:
+ * its game draws nothing, plays nothing and loads no assets, and each of
+ * its frames lasts a fixed time instead of the time that passed.
+ */
+typedef struct engine engine_t;
+
+/**
+ * Opens the window and everything drawn or played through it.
+ *
+ * @param min the lower left corner of the world the window first shows
+ * @param max the upper right corner
+ * @return the new engine
+ */
+engine_t *engine_init(vector_t min, vector_t max);
+
+/**
+ * Allocates an engine without a window.
+ *
+ * @param min the lower left corner of the world the camera first views
+ * @param max the upper right corner
+ * @param fixed_dt how many seconds every frame lasts
+ * @return the new engine
+ */
+engine_t *engine_init_headless(vector_t min, vector_t max, double fixed_dt);
+
+/**
+ * Frees the engine. A windowed one also frees the asset and glyph caches,
+ * with everything they loaded, and closes the audio device.
+ *
+ * @param engine the engine to free
+ */
+void engine_free(engine_t *engine);
+
+/**
+ * Gets whether the engine has no window, so its game must not draw, play
+ * sounds or load assets.
+ *
+ * @param engine the engine
+ * @return whether the engine is headless
+ */
+bool engine_is_headless(engine_t *engine);
+
+/**
+ * Gets the camera the game scrolls. A windowed engine's camera is the one
+ * mapping the scene to the window.
+ *
+ * @param engine the engine
+ * @return the camera, owned by the engine
+ */
+camera_t *engine_get_camera(engine_t *engine);
+
+/**
+ * Starts a new frame.
+ *
+ * @param engine the engine
+ * @return the seconds since the last frame started (0 for the first frame),
+ *   or the fixed frame time of a headless engine
+ */
+double engine_tick(engine_t *engine);
+
+#endif // #ifndef __ENGINE_H__
@@ -0,0 +1,71 @@
+#ifndef __ENTITY_H__
+#define __ENTITY_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * What a body in the game is. Every kind has a fixed set of flags, so
+ * collisions and the game loop can dispatch with a switch or a flag test
+ * instead of comparing names.
+ */
+typedef enum {
+  ENTITY_PLAYER_1,
+  ENTITY_PLAYER_2,
+  ENTITY_INVADER,
+  ENTITY_TILE,
+  ENTITY_TILE_BREAK,
+  ENTITY_TILE_SPRING,
+  ENTITY_TILE_ROCKET,
+  ENTITY_TILE_SHIELD,
+  ENTITY_TILE_MOVE,
+  // the number of kinds, not a kind itself
+  NUM_ENTITY_KINDS
+} entity_kind_t;
+
+/**
+ * Behaviors shared by several kinds of entity, or'ed together.
+ */
+typedef enum {
+  // players can bounce on it
+  ENTITY_IS_TILE = 1 << 0,
+  ENTITY_IS_PLAYER = 1 << 1,
+  // wraps around to the other side of the screen when it leaves it
+  ENTITY_WRAPS = 1 << 2,
+  // drops out of the world once bounced on
+  ENTITY_BREAKS = 1 << 3,
+  // switches to the rocket background once bounced on
+  ENTITY_LAUNCHES = 1 << 4,
+  // shields the player that bounces on it
+  ENTITY_SHIELDS = 1 << 5
+} entity_flag_t;
+
+/**
+ * The info attached to every body of the game.
+ */
+typedef struct body_info {
+  entity_kind_t kind;
+  // the entity_flag_t's of the kind
+  uint32_t flags;
+  // the order tiles were spawned in; 0 for everything else
+  size_t index;
+} body_info_t;
+
+/**
+ * Allocates the info of a body, with the flags of its kind.
+ *
+ * @param kind what the body is
+ * @param index the spawn index of a tile, or 0
+ * @return the new info, to be freed with free()
+ */
+body_info_t *body_info_init(entity_kind_t kind, size_t index);
+
+/**
+ * Gets the flags every entity of a kind has.
+ *
+ * @param kind the kind
+ * @return the entity_flag_t's of the kind, or'ed together
+ */
+uint32_t entity_kind_flags(entity_kind_t kind);
+
+#endif // #ifndef __ENTITY_H__
@@ -0,0 +1,67 @@
+#ifndef __FLOW_FIELD_H__
+#define __FLOW_FIELD_H__
+
+#include <stddef.h>
+
+#include "polygon.h"
+#include "vector.h"
+
+/**
+ * A coarse grid over a rectangle of the world that points every cell toward
+ * its nearest goal. It is built once for all goals, after which anything
+ * steering toward the goals needs one lookup instead of a search through
+ * them.
+ */
+typedef struct flow_field flow_field_t;
+
+/**
+ * Allocates a field with the given grid size. It points nowhere until
+ * flow_field_build().
+ *
+ * @param cols the number of cells across
+ * @param rows the number of cells up
+ * @return the new field
+ */
+flow_field_t *flow_field_init(size_t cols, size_t rows);
+
+/**
+ * Frees the field.
+ *
+ * @param field the field to free
+ */
+void flow_field_free(flow_field_t *field);
+
+/**
+ * Lays the grid over a rectangle and points every cell toward the nearest
+ * goal, counting steps between neighboring cells, in time linear in the
+ * number of cells.
+ *
+ * @param field the field
+ * @param area the rectangle the grid covers
+ * @param goals the positions to steer toward; ones outside the area count
+ *   from the nearest cell
+ * @param num_goals the number of goals, at least 1
+ */
+void flow_field_build(flow_field_t *field, aabb_t area, const vector_t *goals,
+                      size_t num_goals);
+
+/**
+ * Gets the direction from the cell of a position toward its nearest goal.
+ * Positions outside the area use the nearest cell.
+ *
+ * @param field a built field
+ * @param position the position
+ * @return a unit vector, or the zero vector if the cell is centered on a goal
+ */
+vector_t flow_field_direction(flow_field_t *field, vector_t position);
+
+/**
+ * Gets the nearest goal of the cell of a position.
+ *
+ * @param field a built field
+ * @param position the position
+ * @return the index of the goal in the goals given to flow_field_build()
+ */
+size_t flow_field_goal(flow_field_t *field, vector_t position);
+
+#endif // #ifndef __FLOW_FIELD_H__
@@ -2,6 +2,7 @@
 #define __FORCES_H__
 
 #include "collision.h"
+#include "row_index.h"
 #include "scene.h"
 
 void body_aux_free(void *aux);
@@ -80,6 +81,24 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                       collision_handler_t handler, void *aux,
                       double force_const);
 
+/**
+ * Adds a force creator to a scene that calls a collision handler each time
+ * a falling body lands on a body of a row index, like create_collision()
+ * for every pair. Only the rows the body overlaps are tested, and only while
+ * it moves down; while it rises it lands on nothing.
+ *
+ * @param scene the scene containing the body
+ * @param body the falling body, passed to the handler first
+ * @param index the rows it can land on; bodies removed from the scene must
+ *   be removed from the index too
+ * @param handler a function to call whenever the body lands on a row's body
+ * @param aux an auxiliary value to pass to the handler
+ * @param force_const a constant to pass to the handler
+ */
+void create_row_collision(scene_t *scene, body_t *body, row_index_t *index,
+                          collision_handler_t handler, void *aux,
+                          double force_const);
+
 /**
  * Adds a force creator to a scene that destroys two bodies when they collide.
  * The bodies should be destroyed by calling body_remove().
@@ -0,0 +1,69 @@
+#ifndef __GAME_H__
+#define __GAME_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "engine.h"
+#include "sdl_wrapper.h"
+#include "state.h"
+
+/**
+ * The game behind emscripten_init(), for running it on an engine of the
+ * caller's choosing, e.g. many headless games driven by bots instead of a
+ * keyboard. Each frame is still one emscripten_main().
+ */
+
+/**
+ * Sets up a game on the home screen.
+ *
+ * @param engine the engine the game runs on, which must outlive it
+ * @param seed the seed of the game's random stream; a seed replays the
+ *   same rows given the same inputs
+ * @return the new game
+ */
+state_t *game_init(engine_t *engine, uint64_t seed);
+
+/**
+ * Frees the game but not its engine.
+ *
+ * @param state the game to free
+ */
+void game_free(state_t *state);
+
+/**
+ * Leaves the home screen, as if its button was clicked.
+ *
+ * @param state the game
+ * @param two_players whether to start a two player game
+ */
+void game_start(state_t *state, bool two_players);
+
+/**
+ * Presses or releases a key, as the window does.
+ *
+ * @param state the game
+ * @param key the key, as passed to a key_handler_t
+ * @param type whether it was pressed or released
+ * @param held_time how long it has been held, in seconds
+ */
+void game_key(state_t *state, char key, key_event_type_t type,
+              double held_time);
+
+/**
+ * Gets whether the game reached the game over screen.
+ *
+ * @param state the game
+ * @return whether the game is over
+ */
+bool game_is_over(state_t *state);
+
+/**
+ * Gets the score, which is the height the players reached.
+ *
+ * @param state the game
+ * @return the score
+ */
+int32_t game_get_score(state_t *state);
+
+#endif // #ifndef __GAME_H__
@@ -0,0 +1,54 @@
+#ifndef __GENERATOR_H__
+#define __GENERATOR_H__
+
+#include <stddef.h>
+
+/**
+ * Runs a function that makes a sequence of items on a background thread,
+ * ahead of the thread that uses them. The items are handed over through a
+ * spsc_queue_t, so taking one that is ready never locks.
+ *
+ * If no thread can be started (e.g. a build without thread support), each
+ * item is made when it is asked for instead. Either way the sequence is the
+ * same.
+ */
+typedef struct generator generator_t;
+
+/**
+ * Makes the next item of a sequence.
+ *
+ * @param aux the generator's aux, only ever used by one thread at a time
+ * @param item where to write the item
+ */
+typedef void (*generator_func_t)(void *aux, void *item);
+
+/**
+ * Starts making items.
+ *
+ * @param item_size the size of each item, in bytes
+ * @param capacity how many items may be made ahead, a power of two
+ * @param generate makes each item
+ * @param aux passed to generate; it must not be used elsewhere until the
+ *   generator is freed
+ * @return the new generator
+ */
+generator_t *generator_init(size_t item_size, size_t capacity,
+                            generator_func_t generate, void *aux);
+
+/**
+ * Stops making items and frees the generator. The aux is not freed.
+ *
+ * @param gen the generator to free
+ */
+void generator_free(generator_t *gen);
+
+/**
+ * Takes the next item of the sequence, waiting for it only if the
+ * background thread fell behind.
+ *
+ * @param gen the generator
+ * @param item where to copy the item
+ */
+void generator_next(generator_t *gen, void *item);
+
+#endif // #ifndef __GENERATOR_H__
@@ -1,12 +1,32 @@
 #ifndef __POLYGON_H__
 #define __POLYGON_H__
 
+#include <stdbool.h>
+
 #include "color.h"
 #include "list.h"
 #include "vector.h"
 
 typedef struct polygon polygon_t;
 
+/**
+ * An axis-aligned bounding box: the smallest upright rectangle containing a
+ * shape, given by its lower left and upper right corners.
+ */
+typedef struct aabb {
+  vector_t min;
+  vector_t max;
+} aabb_t;
+
+/**
+ * Checks whether two bounding boxes overlap (touching counts).
+ *
+ * @param a a bounding box
+ * @param b another bounding box
+ * @return whether the boxes overlap
+ */
+bool aabb_overlaps(aabb_t a, aabb_t b);
+
 /**
  * Initialize a polygon object given a list of vertices.
  *
@@ -108,6 +128,26 @@ void polygon_set_color(polygon_t *polygon, rgb_color_t *color);
  */
 void polygon_set_center(polygon_t *polygon, vector_t centroid);
 
+/**
+ * Overwrites the vertices of the polygon in place, without allocating.
+ *
+ * @param polygon a polygon_t struct
+ * @param points the new vertices
+ * @param num_points the number of new vertices, which must be the number the
+ *   polygon already has
+ */
+void polygon_set_points(polygon_t *polygon, const vector_t *points,
+                        size_t num_points);
+
+/**
+ * Returns the bounding box of the polygon. It is kept up to date as the
+ * polygon moves, so this takes constant time.
+ *
+ * @param polygon a polygon_t struct
+ * @return the polygon's axis-aligned bounding box
+ */
+aabb_t polygon_get_bounds(polygon_t *polygon);
+
 /**
  * Returns the centroid of the polygon.
  *
@@ -0,0 +1,76 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * A profiler of where frame time goes. Each PROFILE_SCOPE records how long
+ * the rest of its block took, as a zone nested in the zones around it. Every
+ * thread records its zones into its own ring of the most recent ones, so
+ * recording never locks or waits on another thread.
+ *
+ * PROFILE_WRITE saves the recorded zones of every thread as a Chrome trace,
+ * to open with chrome://tracing or https://ui.perfetto.dev.
+ *
+ * The profiler is only built with -DPROFILE (`make PROFILE=true ...`, after
+ * a `make clean`). Otherwise the macros expand to nothing.
+ */
+
+#ifdef PROFILE
+
+/**
+ * A zone being recorded. Use the macros instead.
+ */
+typedef struct profile_zone {
+  const char *name;
+  uint64_t start;
+} profile_zone_t;
+
+profile_zone_t profile_zone_begin(const char *name);
+
+void profile_zone_end(profile_zone_t *zone);
+
+/**
+ * Writes the zones recorded so far by every thread as a Chrome trace.
+ * Threads may keep recording while it is written; zones they overwrite in
+ * the meantime are left out.
+ *
+ * @param path the file to write
+ * @return whether the file could be written
+ */
+bool profile_write(const char *path);
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * Records the rest of the enclosing block as a zone.
+ *
+ * @param name the zone's name, a string that outlives the program (e.g. a
+ *   literal) without quotes or backslashes
+ */
+#define PROFILE_SCOPE(name)                                                    \
+  profile_zone_t PROFILE_CONCAT(profile_zone_, __LINE__)                      \
+      __attribute__((cleanup(profile_zone_end), unused)) =                     \
+          profile_zone_begin(name)
+
+/**
+ * Records the rest of the enclosing function as a zone named after it.
+ */
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+
+/**
+ * Calls profile_write().
+ */
+#define PROFILE_WRITE(path) profile_write(path)
+
+#else
+
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_FUNCTION() ((void)0)
+#define PROFILE_WRITE(path) ((void)0)
+
+#endif // #ifdef PROFILE
+
+#endif // #ifndef __PROFILE_H__
@@ -0,0 +1,102 @@
+#ifndef __PROJECTILE_POOL_H__
+#define __PROJECTILE_POOL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "polygon.h"
+#include "vector.h"
+
+/**
+ * A fixed number of round projectiles of one size, with no bodies. Positions
+ * and velocities are stored as separate arrays per axis, so moving and
+ * testing every projectile runs straight down contiguous memory.
+ *
+ * Each projectile has a set of targets, bit i for target i, that it can hit.
+ * Projectiles are unordered: removing one moves the last one into its place.
+ */
+typedef struct projectile_pool projectile_pool_t;
+
+/**
+ * Allocates an empty pool.
+ *
+ * @param capacity the most projectiles in flight at once
+ * @param radius the radius of every projectile
+ * @return the new pool
+ */
+projectile_pool_t *projectile_pool_init(size_t capacity, double radius);
+
+/**
+ * Frees the pool.
+ *
+ * @param pool the pool to free
+ */
+void projectile_pool_free(projectile_pool_t *pool);
+
+/**
+ * Fires a projectile, unless the pool is full.
+ *
+ * @param pool the pool
+ * @param position where the projectile starts
+ * @param velocity how fast it flies
+ * @param targets the targets it can hit, or'ed together
+ * @return whether there was room for it
+ */
+bool projectile_pool_fire(projectile_pool_t *pool, vector_t position,
+                          vector_t velocity, uint32_t targets);
+
+/**
+ * Moves every projectile along its velocity.
+ *
+ * @param pool the pool
+ * @param dt the time elapsed since the last tick, in seconds
+ */
+void projectile_pool_tick(projectile_pool_t *pool, double dt);
+
+/**
+ * Removes every projectile aimed at a target that overlaps a circle.
+ *
+ * @param pool the pool
+ * @param center the center of the circle
+ * @param radius the radius of the circle
+ * @param target the bit of the target the circle is
+ * @return the number of projectiles that hit it
+ */
+size_t projectile_pool_hit(projectile_pool_t *pool, vector_t center,
+                           double radius, uint32_t target);
+
+/**
+ * Removes every projectile that has fallen entirely below a height.
+ *
+ * @param pool the pool
+ * @param min_y the height
+ * @return the number of projectiles removed
+ */
+size_t projectile_pool_cull_below(projectile_pool_t *pool, double min_y);
+
+/**
+ * Removes every projectile.
+ *
+ * @param pool the pool
+ */
+void projectile_pool_clear(projectile_pool_t *pool);
+
+/**
+ * Gets the number of projectiles in flight.
+ *
+ * @param pool the pool
+ * @return the number of projectiles
+ */
+size_t projectile_pool_size(projectile_pool_t *pool);
+
+/**
+ * Gets the bounding box of one projectile.
+ *
+ * @param pool the pool
+ * @param i the projectile, below projectile_pool_size()
+ * @return the box around it
+ */
+aabb_t projectile_pool_get_bounds(projectile_pool_t *pool, size_t i);
+
+#endif // #ifndef __PROJECTILE_POOL_H__
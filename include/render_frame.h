@@ -0,0 +1,108 @@
+#ifndef __RENDER_FRAME_H__
+#define __RENDER_FRAME_H__
+
+#include <SDL2/SDL.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * Polygons, images and text are queued and drawn when the frame is flushed,
+ * sorted by layer and then by texture so each run of one texture is a single
+ * draw call. Layers are drawn in this order; within a layer, the polygons
+ * come first and sprites of different textures may be drawn in any order,
+ * so things that overlap belong in different layers.
+ */
+typedef enum {
+  LAYER_BACKGROUND,
+  LAYER_SPRITES,
+  LAYER_TEXT,
+  // the number of layers, not a layer itself
+  NUM_RENDER_LAYERS
+} render_layer_t;
+
+/**
+ * The draw commands of one frame, already converted to pixels. A frame is
+ * filled by the game, then drawn by whichever thread owns the renderer, so
+ * it never refers to game objects. Its buffers only grow, so a frame
+ * allocates nothing once warmed up.
+ */
+typedef struct render_frame render_frame_t;
+
+/**
+ * Allocates an empty frame.
+ *
+ * @return the new frame
+ */
+render_frame_t *render_frame_init(void);
+
+/**
+ * Removes every draw command from the frame. Textures waiting to be
+ * destroyed stay queued.
+ *
+ * @param frame the frame
+ */
+void render_frame_reset(render_frame_t *frame);
+
+/**
+ * Adds a textured quad.
+ *
+ * @param frame the frame
+ * @param texture the texture to draw from, or NULL to do nothing
+ * @param layer the layer the quad is drawn in
+ * @param clip the part of the texture to draw, or NULL for all of it
+ * @param dest where the quad is drawn, in pixels
+ * @param color the color the texture is multiplied by
+ */
+void render_frame_add_sprite(render_frame_t *frame, SDL_Texture *texture,
+                             render_layer_t layer, const SDL_Rect *clip,
+                             SDL_FRect dest, SDL_Color color);
+
+/**
+ * Adds a convex polygon, drawn as a triangle fan from its first vertex.
+ *
+ * @param frame the frame
+ * @param layer the layer the polygon is drawn in
+ * @param num_vertices the number of vertices, at least 3
+ * @return the polygon's vertices, for the caller to fill in with pixel
+ *   positions and colors before adding anything else to the frame
+ */
+SDL_Vertex *render_frame_add_polygon(render_frame_t *frame,
+                                     render_layer_t layer,
+                                     size_t num_vertices);
+
+/**
+ * Sets the rectangle outlined on top of everything else.
+ *
+ * @param frame the frame
+ * @param boundary the outline, in pixels
+ */
+void render_frame_set_boundary(render_frame_t *frame, SDL_Rect boundary);
+
+/**
+ * Destroys a texture once the frame has been drawn, so the frame (and any
+ * frame before it) can still use it.
+ *
+ * @param frame the frame
+ * @param texture the texture to destroy
+ */
+void render_frame_destroy_texture(render_frame_t *frame, SDL_Texture *texture);
+
+/**
+ * Clears the screen to white and draws the frame: one SDL_RenderGeometry
+ * call per layer for its polygons and one per run of sprites sharing a
+ * texture. Then destroys the textures queued with
+ * render_frame_destroy_texture. Does not present.
+ *
+ * @param frame the frame
+ * @param renderer the renderer to draw with
+ */
+void render_frame_draw(render_frame_t *frame, SDL_Renderer *renderer);
+
+/**
+ * Frees the frame, without destroying its queued textures.
+ *
+ * @param frame the frame to free
+ */
+void render_frame_free(render_frame_t *frame);
+
+#endif // #ifndef __RENDER_FRAME_H__
@@ -0,0 +1,113 @@
+#ifndef __REPLAY_H__
+#define __REPLAY_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sdl_wrapper.h"
+
+/**
+ * The inputs of one played game, recorded so the game can be played again
+ * without a window or a player, e.g. to train a profile-guided build on
+ * realistic play.
+ *
+ * A replay is a text file: a `seed <seed>` line, then one line per event,
+ * in the order they happened:
+ *
+ *   start <tick> <1 for two players, 0 for one>
+ *   key <tick> <key code> <0 pressed, 1 released> <held seconds>
+ *
+ * where <tick> is the number of frames the game ran before the event.
+ */
+
+typedef enum { REPLAY_START, REPLAY_KEY } replay_event_type_t;
+
+typedef struct replay_event {
+  replay_event_type_t type;
+  // the number of frames the game ran before the event
+  size_t tick;
+  // REPLAY_START only
+  bool two_players;
+  // REPLAY_KEY only
+  char key;
+  key_event_type_t key_type;
+  double held_time;
+} replay_event_t;
+
+/**
+ * A replay being recorded.
+ */
+typedef struct replay_writer replay_writer_t;
+
+/**
+ * A replay read back from its file.
+ */
+typedef struct replay replay_t;
+
+/**
+ * Starts recording a replay, overwriting the file.
+ *
+ * @param path the file to record to
+ * @param seed the seed the game was started with
+ * @return the new recording, or NULL if the file could not be opened
+ */
+replay_writer_t *replay_writer_init(const char *path, uint64_t seed);
+
+/**
+ * Records an event. Events must be added in the order they happened.
+ *
+ * @param writer the recording
+ * @param event the event
+ */
+void replay_writer_add(replay_writer_t *writer, replay_event_t event);
+
+/**
+ * Finishes the recording and closes its file.
+ *
+ * @param writer the recording
+ */
+void replay_writer_free(replay_writer_t *writer);
+
+/**
+ * Reads a replay.
+ *
+ * @param path the file a replay_writer_t recorded
+ * @return the replay, or NULL if the file could not be read or isn't a
+ *   replay
+ */
+replay_t *replay_load(const char *path);
+
+/**
+ * Frees a replay.
+ *
+ * @param replay the replay
+ */
+void replay_free(replay_t *replay);
+
+/**
+ * Gets the seed of the replayed game.
+ *
+ * @param replay the replay
+ * @return the seed to pass to game_init
+ */
+uint64_t replay_get_seed(replay_t *replay);
+
+/**
+ * Gets the number of events in a replay.
+ *
+ * @param replay the replay
+ * @return the number of events
+ */
+size_t replay_num_events(replay_t *replay);
+
+/**
+ * Gets an event of a replay.
+ *
+ * @param replay the replay
+ * @param index the index of the event, in the order they happened
+ * @return the event
+ */
+const replay_event_t *replay_get_event(replay_t *replay, size_t index);
+
+#endif // #ifndef __REPLAY_H__
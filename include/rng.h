@@ -0,0 +1,52 @@
+#ifndef __RNG_H__
+#define __RNG_H__
+
+#include <stdint.h>
+
+/**
+ * A PCG32 random number generator. Each owner keeps its own generator, so
+ * streams are reproducible from their seed and safe to use from different
+ * threads, unlike rand().
+ * rng_t is defined here so it can be embedded in other structs.
+ */
+typedef struct {
+  uint64_t state;
+  // odd; selects one of 2^63 independent sequences
+  uint64_t inc;
+} rng_t;
+
+/**
+ * Seeds a generator. Equal seeds and streams give equal sequences.
+ *
+ * @param rng the generator
+ * @param seed the starting point of the sequence
+ * @param stream which sequence to draw from
+ */
+void rng_seed(rng_t *rng, uint64_t seed, uint64_t stream);
+
+/**
+ * Draws the next number of the sequence.
+ *
+ * @param rng the generator
+ * @return a uniformly distributed 32-bit number
+ */
+uint32_t rng_next(rng_t *rng);
+
+/**
+ * Draws a number in [0, bound) without the bias of rng_next() % bound.
+ *
+ * @param rng the generator
+ * @param bound the exclusive upper bound, greater than 0
+ * @return a uniformly distributed number below `bound`
+ */
+uint32_t rng_below(rng_t *rng, uint32_t bound);
+
+/**
+ * Draws a number in [0, 1).
+ *
+ * @param rng the generator
+ * @return a uniformly distributed double
+ */
+double rng_double(rng_t *rng);
+
+#endif // #ifndef __RNG_H__
@@ -0,0 +1,67 @@
+#ifndef __ROW_INDEX_H__
+#define __ROW_INDEX_H__
+
+#include <stddef.h>
+
+#include "body.h"
+
+/**
+ * An index of bodies laid out in horizontal rows, bucketed by the height of
+ * their row. Finding the bodies near a vertical range only looks at the
+ * buckets the range overlaps, however many rows there are.
+ *
+ * The buckets form a ring, so the index follows rows that keep moving up
+ * (or down) without growing; rows a whole ring apart share a bucket and are
+ * told apart by their height.
+ */
+typedef struct row_index row_index_t;
+
+/**
+ * Allocates an empty index.
+ *
+ * @param bucket_height the height covered by each bucket, e.g. the distance
+ *   between rows
+ * @param reach the furthest any body extends above or below its row's height
+ * @return the new index
+ */
+row_index_t *row_index_init(double bucket_height, double reach);
+
+/**
+ * Frees the index. The bodies in it are not freed.
+ *
+ * @param index the index to free
+ */
+void row_index_free(row_index_t *index);
+
+/**
+ * Adds a body to the row at the given height.
+ *
+ * @param index the index
+ * @param body the body, which must stay within `reach` of the row
+ * @param height the height of the body's row
+ */
+void row_index_add(row_index_t *index, body_t *body, double height);
+
+/**
+ * Removes a body from the row it was added to.
+ *
+ * @param index the index
+ * @param body a body in the index
+ * @param height the height it was added at
+ */
+void row_index_remove(row_index_t *index, body_t *body, double height);
+
+/**
+ * Finds the bodies of the rows that can reach into a vertical range.
+ *
+ * @param index the index
+ * @param min_y the bottom of the range
+ * @param max_y the top of the range
+ * @param bodies filled with the bodies found
+ * @param max_bodies the length of `bodies`; any more bodies are not returned
+ * @return the number of bodies written to `bodies`
+ */
+size_t row_index_query(row_index_t *index, double min_y, double max_y,
+                       body_t **bodies, size_t max_bodies);
+
+#endif // #ifndef __ROW_INDEX_H__
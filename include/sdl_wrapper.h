@@ -1,9 +1,11 @@
 #ifndef __SDL_WRAPPER_H__
 #define __SDL_WRAPPER_H__
 
+#include "camera.h"
 #include "color.h"
 #include "list.h"
 #include "polygon.h"
+#include "render_frame.h"
 #include "scene.h"
 #include "state.h"
 #include "vector.h"
@@ -32,26 +34,48 @@ typedef enum { KEY_PRESSED, KEY_RELEASED } key_event_type_t;
 
 typedef enum { MOUSE_PRESSED, MOUSE_RELEASED } mouse_event_type_t;
 
-// bool sdl_open_audio(); 
+/**
+ * Gets the sound at the given path from the asset cache, loading it the
+ * first time. The cache owns the sound.
+ *
+ * @param sound_path the filepath of the .wav file
+ * @return the sound, or NULL while it is still being preloaded
+ */
 Mix_Chunk *sdl_get_sound(const char *sound_path);
 
+/**
+ * Plays a sound through the voice manager with the default priority and
+ * concurrency limit (see voice.h). Playing the same sound again in the same
+ * frame does nothing.
+ *
+ * @param sound the sound to play, or NULL to do nothing
+ */
 void sdl_play_sound(Mix_Chunk *sound);
+
+/**
+ * Stops every voice still playing the sound. The sound itself stays in the
+ * asset cache, which frees it.
+ *
+ * @param sound the sound to stop
+ */
 void sdl_free_sound(Mix_Chunk *sound);
 
 /**
- * Computes the center of the window in pixel coordinates.
+ * Gets the camera that maps the scene to the window. It starts out viewing
+ * the rectangle passed to sdl_init(); moving it scrolls everything drawn
+ * from world coordinates (polygons and body images).
  *
- * @return A vector representing the center of the window.
+ * @return the camera, owned by the SDL wrapper
  */
-vector_t get_window_center(void);
+camera_t *sdl_get_camera(void);
+
 /**
- * Maps a scene coordinate to a window coordinate.
+ * Maps a rectangle of the scene to the window through the camera.
  *
- * @param scene_pos The position in scene coordinates.
- * @param window_center The center of the window in pixel coordinates.
- * @return A vector representing the mapped position in window coordinates.
+ * @param bounds the rectangle, in scene coordinates
+ * @return the rectangle in pixels
  */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center);
+SDL_Rect sdl_get_pixel_rect(aabb_t bounds);
 
 /**
  * A keypress handler.
@@ -86,6 +110,20 @@ typedef void (*mouse_handler_t)(void *state, double x_loc, double y_loc);
  * @param max the x and y coordinates of the top right of the scene
  */
 void sdl_init(vector_t min, vector_t max);
+
+/**
+ * Runs the game on its own thread while the calling thread, which must be
+ * the main thread, becomes the render thread. The render thread owns the
+ * window and the renderer: it creates textures for the game, polls window
+ * events for sdl_is_done() and draws each frame handed over by sdl_show(),
+ * so simulating the next frame overlaps with presenting the last one.
+ * Runs the game on the calling thread if no thread can be started. Once the
+ * game returns, shuts down the window, the renderer and SDL.
+ *
+ * @param game runs the whole game and returns when it is done; sdl_init()
+ *   must be called from it
+ */
+void sdl_run_threaded(SDL_ThreadFunction game);
 /**
  * Displays the image that is passed in as the img parameter
  * The size of the image is defined by the img_width and img_height parameters
@@ -95,14 +133,77 @@ void sdl_init(vector_t min, vector_t max);
 void sdl_render_image(SDL_Texture *img, size_t img_width, size_t img_height,
                       size_t img_center_x, size_t image_center_y);
 
-void sdl_render_image_with_cam(SDL_Texture *img, size_t img_width, size_t img_height,
-                      size_t img_center_x, size_t img_center_y, double cam_height);
+/**
+ * Displays the `clip` sub-rectangle of the texture passed in as the img
+ * parameter. Used for sprites that live inside a shared atlas texture.
+ * A NULL `clip` draws the whole texture, exactly like sdl_render_image.
+ */
+void sdl_render_image_clip(SDL_Texture *img, const SDL_Rect *clip,
+                           size_t img_width, size_t img_height,
+                           size_t img_center_x, size_t img_center_y);
+
+/**
+ * Sets the layer that images and polygons are queued in until the next call
+ * or the next sdl_clear(), which resets it to LAYER_SPRITES. Text is always
+ * queued in LAYER_TEXT.
+ *
+ * @param layer the layer for subsequent images and polygons
+ */
+void sdl_set_layer(render_layer_t layer);
+
+/**
+ * Gets the layer that images and polygons are currently queued in, e.g. to
+ * restore it after drawing in another one.
+ *
+ * @return the layer set by the last sdl_set_layer() since sdl_clear()
+ */
+render_layer_t sdl_get_layer(void);
+
 /**
  * Creates the texture of an image using the given stringPath that point to the
  * image file
  */
 SDL_Texture *sdl_display(const char *stringPath);
 
+/**
+ * Uploads an already decoded surface to the renderer as a texture.
+ * The surface is still owned (and must be freed) by the caller.
+ *
+ * @param surface the decoded pixels to upload
+ * @return the newly created texture, or NULL on failure
+ */
+SDL_Texture *sdl_create_texture(SDL_Surface *surface);
+
+/**
+ * Uploads raw pixels (e.g. from a memory-mapped asset pack) to the renderer
+ * as a texture with alpha blending, without any intermediate surface.
+ *
+ * @param format the SDL pixel format of the pixels
+ * @param width the width of the image in pixels
+ * @param height the height of the image in pixels
+ * @param pixels the pixel data, which is only read during the call
+ * @param pitch the number of bytes in each row of pixels
+ * @return the newly created texture, or NULL on failure
+ */
+SDL_Texture *sdl_create_texture_from_pixels(Uint32 format, int width,
+                                            int height, const void *pixels,
+                                            int pitch);
+
+/**
+ * Destroys a texture once the frame being drawn has been shown, since the
+ * frame may still draw it.
+ *
+ * @param texture the texture to destroy
+ */
+void sdl_destroy_texture(SDL_Texture *texture);
+
+/**
+ * Gets the largest texture width/height the renderer supports.
+ *
+ * @return the maximum texture dimension in pixels
+ */
+int sdl_max_texture_size(void);
+
 /**
  * Gets the bounding box for the body, the smallest box
  * that will cover the body entirely
@@ -112,14 +213,27 @@ SDL_Texture *sdl_display(const char *stringPath);
 SDL_Rect sdl_get_bounding_box(body_t *body);
 
 /**
- * Displays the text that is passed in as the txt parameter
+ * Displays the text that is passed in as the txt parameter, composed from
+ * the font's glyph atlas so changing text costs no rasterization.
  * @param txt the string that is printed
  * @param font the font that the string is printed with
  * @param position a vector describing the position of the text when displayed
+ * @param color the color of the text
  */
 void sdl_render_text(const char *txt, TTF_Font *font, const vector_t position,
                      SDL_Color color);
 
+/**
+ * Displays text that rarely changes (e.g. a label) from a cached texture of
+ * the whole string, rendered the first time the string is drawn.
+ * @param txt the string that is printed
+ * @param font the font that the string is printed with
+ * @param position a vector describing the position of the text when displayed
+ * @param color the color of the text
+ */
+void sdl_render_static_text(const char *txt, TTF_Font *font,
+                            const vector_t position, SDL_Color color);
+
 /**
  * Processes all SDL events and returns whether the window has been closed.
  * This function must be called in order to handle inputs.
@@ -134,7 +248,10 @@ bool sdl_is_done(void *state);
 void sdl_clear(void);
 
 /**
- * Draws a polygon from the given list of vertices and a color.
+ * Queues a polygon, filled with a color, in the current layer. Its vertices
+ * are converted to pixels right away, so the polygon may change or be freed
+ * afterwards. The polygon is drawn as a triangle fan from its first vertex,
+ * so it must be convex.
  *
  * @param poly a struct representing the polygon
  * @param color the color used to fill in the polygon
@@ -144,6 +261,8 @@ void sdl_draw_polygon(polygon_t *poly, rgb_color_t color);
 /**
  * Displays the rendered frame on the SDL window.
  * Must be called after drawing the polygons in order to show them.
+ * With a render thread, hands the frame to it and returns once the previous
+ * frame has started drawing.
  */
 void sdl_show(void);
 
@@ -187,12 +306,4 @@ void sdl_on_key(key_handler_t handler);
 
 void sdl_on_mouse(mouse_handler_t handler);
 
-/**
- * Gets the amount of time that has passed since the last time
- * this function was called, in seconds.
- *
- * @return the number of seconds that have elapsed
- */
-double time_since_last_tick(void);
-
 #endif // #ifndef __SDL_WRAPPER_H__
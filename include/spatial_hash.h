@@ -0,0 +1,57 @@
+#ifndef __SPATIAL_HASH_H__
+#define __SPATIAL_HASH_H__
+
+#include <stddef.h>
+
+#include "vector.h"
+
+/**
+ * Buckets a set of points by the square cell of the world they fall in, so
+ * the points near a position are found by looking at the few cells around it.
+ * It is rebuilt from scratch whenever the points move, in time linear in the
+ * number of points.
+ */
+typedef struct spatial_hash spatial_hash_t;
+
+/**
+ * Allocates an empty hash.
+ *
+ * @param cell_size the width and height of a cell, at least the largest
+ *   radius that will be queried
+ * @param num_buckets how many buckets the cells are hashed into
+ * @return the new hash
+ */
+spatial_hash_t *spatial_hash_init(double cell_size, size_t num_buckets);
+
+/**
+ * Frees the hash. The points are not freed.
+ *
+ * @param hash the hash to free
+ */
+void spatial_hash_free(spatial_hash_t *hash);
+
+/**
+ * Replaces the points in the hash.
+ *
+ * @param hash the hash
+ * @param points the points, which must not change until the next build
+ * @param num_points the number of points
+ */
+void spatial_hash_build(spatial_hash_t *hash, const vector_t *points,
+                        size_t num_points);
+
+/**
+ * Finds the points within a distance of a position.
+ *
+ * @param hash a built hash
+ * @param center the position
+ * @param radius the distance, at most the cell size
+ * @param indices filled with the indices of the points found
+ * @param max_indices the length of `indices`; any more points are not
+ *   returned
+ * @return the number of indices written to `indices`
+ */
+size_t spatial_hash_query(spatial_hash_t *hash, vector_t center, double radius,
+                          size_t *indices, size_t max_indices);
+
+#endif // #ifndef __SPATIAL_HASH_H__
@@ -0,0 +1,62 @@
+#ifndef __SPSC_QUEUE_H__
+#define __SPSC_QUEUE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A fixed-capacity ring of fixed-size items passed from one thread to
+ * another without locks. Exactly one thread may push and exactly one thread
+ * may pop; each side only writes its own end of the ring, and an item is
+ * copied in before the producer publishes it, so neither side ever waits
+ * on the other.
+ */
+typedef struct spsc_queue spsc_queue_t;
+
+/**
+ * Allocates an empty queue.
+ *
+ * @param item_size the size of each item, in bytes
+ * @param capacity how many items fit at once, a power of two
+ * @return the new queue
+ */
+spsc_queue_t *spsc_queue_init(size_t item_size, size_t capacity);
+
+/**
+ * Frees the queue and any items still in it. Neither thread may be using
+ * it.
+ *
+ * @param queue the queue to free
+ */
+void spsc_queue_free(spsc_queue_t *queue);
+
+/**
+ * Copies an item onto the back of the queue. Only the producer may call
+ * this.
+ *
+ * @param queue the queue
+ * @param item the item_size bytes to copy
+ * @return whether there was room; a full queue is left unchanged
+ */
+bool spsc_queue_push(spsc_queue_t *queue, const void *item);
+
+/**
+ * Copies the item at the front of the queue out and removes it. Only the
+ * consumer may call this.
+ *
+ * @param queue the queue
+ * @param item where to copy the item_size bytes of the item
+ * @return whether there was an item; an empty queue is left unchanged
+ */
+bool spsc_queue_pop(spsc_queue_t *queue, void *item);
+
+/**
+ * Gets how many items are in the queue. From either thread it is only a
+ * snapshot: the other thread may push or pop right after.
+ *
+ * @param queue the queue
+ * @return the number of items
+ */
+size_t spsc_queue_size(spsc_queue_t *queue);
+
+#endif // #ifndef __SPSC_QUEUE_H__
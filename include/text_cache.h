@@ -0,0 +1,78 @@
+#ifndef __TEXT_CACHE_H__
+#define __TEXT_CACHE_H__
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+// glyph atlases hold the printable ASCII characters
+#define FIRST_GLYPH ' '
+#define LAST_GLYPH '~'
+#define NUM_GLYPHS (LAST_GLYPH - FIRST_GLYPH + 1)
+
+/**
+ * Where one character lives in its font's glyph atlas. The region is a full
+ * line high, so drawing it with its top at the line's top and then moving
+ * the pen right by `advance` lays out a string.
+ */
+typedef struct glyph {
+  SDL_Rect src;
+  int advance;
+} glyph_t;
+
+/**
+ * Every printable character of one font, rasterized once in white into a
+ * single texture. Tint it with SDL_SetTextureColorMod when drawing.
+ */
+typedef struct glyph_atlas {
+  SDL_Texture *texture;
+  glyph_t glyphs[NUM_GLYPHS];
+  int line_height;
+} glyph_atlas_t;
+
+/**
+ * Gets the glyph atlas of a font, rasterizing it the first time the font is
+ * used.
+ *
+ * @param font the font to rasterize
+ * @return the font's glyph atlas, or NULL if it couldn't be created
+ */
+const glyph_atlas_t *text_cache_get_glyphs(TTF_Font *font);
+
+/**
+ * Gets the glyph of a character, falling back to '?' for characters the
+ * atlas doesn't hold.
+ *
+ * @param atlas a glyph atlas
+ * @param c the character
+ * @return the character's glyph
+ */
+const glyph_t *text_cache_get_glyph(const glyph_atlas_t *atlas, char c);
+
+/**
+ * Gets a texture holding a whole string, rendering it the first time this
+ * font, text and color are asked for. Meant for labels that rarely change;
+ * the least recently used strings are dropped once too many are cached.
+ *
+ * @param font the font of the text
+ * @param text the string to render
+ * @param color the color of the text
+ * @return the string's texture, owned by the cache and valid until the next
+ *   call, or NULL if it couldn't be rendered
+ */
+SDL_Texture *text_cache_get_string(TTF_Font *font, const char *text,
+                                   SDL_Color color);
+
+/**
+ * Frees the glyph atlas and string textures of a font. Must be called before
+ * the font is closed, since a font opened later may reuse its address.
+ *
+ * @param font the font about to be closed
+ */
+void text_cache_forget_font(TTF_Font *font);
+
+/**
+ * Frees every glyph atlas and string texture.
+ */
+void text_cache_destroy(void);
+
+#endif // #ifndef __TEXT_CACHE_H__
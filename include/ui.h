@@ -0,0 +1,97 @@
+#ifndef __UI_H__
+#define __UI_H__
+
+#include "asset.h"
+#include <stdbool.h>
+
+/**
+ * A retained UI tree. Each screen builds its tree once; per frame the game
+ * only updates what changed (label text, visibility) and renders the root,
+ * which allocates nothing.
+ */
+typedef struct ui_node ui_node_t;
+
+// the longest label text, including the terminating null
+#define UI_LABEL_LEN 64
+
+/**
+ * Allocates an empty group node, which only renders its children.
+ *
+ * @return the new group
+ */
+ui_node_t *ui_group_init(void);
+
+/**
+ * Allocates a node drawing an asset.
+ *
+ * @param asset the asset to draw
+ * @param owns_asset whether `ui_free` should destroy the asset, e.g. false
+ *   for buttons owned by the asset cache
+ * @return the new node
+ */
+ui_node_t *ui_asset_init(asset_t *asset, bool owns_asset);
+
+/**
+ * Allocates a text label. The label keeps its own copy of its text.
+ *
+ * @param font_path the filepath to the .ttf file
+ * @param box the bounding box of the label
+ * @param color the color of the text
+ * @param is_static true for text that rarely changes, which is drawn from a
+ *   cached texture of the whole string instead of glyph by glyph
+ * @return the new label, with empty text
+ */
+ui_node_t *ui_label_init(const char *font_path, SDL_Rect box,
+                         rgb_color_t color, bool is_static);
+
+/**
+ * Adds a child to a group. The group takes ownership of the child.
+ *
+ * @param group a node made with `ui_group_init`
+ * @param child the node to add
+ */
+void ui_add_child(ui_node_t *group, ui_node_t *child);
+
+/**
+ * Shows or hides a node and its children.
+ *
+ * @param node the node
+ * @param visible whether the node is rendered
+ */
+void ui_set_visible(ui_node_t *node, bool visible);
+
+/**
+ * Sets the text of a label. Does nothing if the text is unchanged, so it is
+ * cheap to call every frame. Text longer than UI_LABEL_LEN is cut off.
+ *
+ * @param label a node made with `ui_label_init`
+ * @param text the new text
+ */
+void ui_label_set_text(ui_node_t *label, const char *text);
+
+/**
+ * Sets the layer an asset node's images are drawn in (see sdl_set_layer),
+ * e.g. LAYER_BACKGROUND for a full screen picture under the buttons.
+ * Nodes start in LAYER_SPRITES; text is always drawn in LAYER_TEXT.
+ *
+ * @param node a node made with `ui_asset_init`
+ * @param layer the layer to draw the node's images in
+ */
+void ui_set_layer(ui_node_t *node, render_layer_t layer);
+
+/**
+ * Renders a node and its visible children, in the order they were added.
+ * The current render layer is left as it was.
+ *
+ * @param node the root of the tree to render
+ */
+void ui_render(ui_node_t *node);
+
+/**
+ * Frees a node, its children and the assets they own.
+ *
+ * @param node the root of the tree to free
+ */
+void ui_free(ui_node_t *node);
+
+#endif // #ifndef __UI_H__
@@ -0,0 +1,58 @@
+#ifndef __VOICE_H__
+#define __VOICE_H__
+
+#include <SDL2/SDL_mixer.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * A voice manager on top of SDL_mixer's channels. The number of sounds
+ * mixed at once is fixed, so the cost of audio stays bounded however many
+ * events ask for sounds:
+ *
+ * - a sound asked for twice in the same frame only plays once
+ * - a sound already playing `max_instances` times restarts its oldest voice
+ * - when every voice is busy, the oldest voice with the lowest priority not
+ *   above the new sound's is stolen; otherwise the new sound is dropped
+ */
+
+// the number of mixer channels the manager allocates
+#define NUM_VOICES 8
+
+typedef struct voice_params {
+  // higher priorities may steal voices from lower ones
+  int priority;
+  // how many voices this sound may use at once
+  size_t max_instances;
+} voice_params_t;
+
+// low priority, at most two overlapping copies
+extern const voice_params_t DEFAULT_VOICE_PARAMS;
+
+/**
+ * Allocates the mixer channels. Must be called after Mix_OpenAudio.
+ */
+void voice_init(void);
+
+/**
+ * Plays a sound once, subject to the limits above.
+ *
+ * @param sound the sound to play; NULL (e.g. still preloading) is ignored
+ * @param params the sound's priority and concurrency limit
+ * @return whether the sound started playing
+ */
+bool voice_play(Mix_Chunk *sound, voice_params_t params);
+
+/**
+ * Stops every voice playing the given sound.
+ *
+ * @param sound the sound to stop
+ */
+void voice_stop(Mix_Chunk *sound);
+
+/**
+ * Marks the end of a frame, so sounds may be played again.
+ */
+void voice_end_frame(void);
+
+#endif // #ifndef __VOICE_H__
@@ -0,0 +1,78 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "alias_table.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
+struct alias_table {
+  size_t size;
+  // the chance of keeping column i instead of taking its alias
+  double *keep;
+  size_t *alias;
+};
+
+alias_table_t *alias_table_init(const double *weights, size_t n) {
+  assert(n > 0);
+  double total = 0;
+  for (size_t i = 0; i < n; i++) {
+    assert(weights[i] >= 0);
+    total += weights[i];
+  }
+  assert(total > 0);
+
+  alias_table_t *table = malloc(sizeof(alias_table_t));
+  assert(table);
+  table->size = n;
+  table->keep = malloc(sizeof(double) * n);
+  table->alias = malloc(sizeof(size_t) * n);
+  // columns still below and above the average height, as stacks
+  size_t *small = malloc(sizeof(size_t) * n);
+  size_t *large = malloc(sizeof(size_t) * n);
+  assert(table->keep && table->alias && small && large);
+
+  size_t num_small = 0, num_large = 0;
+  for (size_t i = 0; i < n; i++) {
+    // scaled so the average column has height 1
+    table->keep[i] = weights[i] * n / total;
+    table->alias[i] = i;
+    if (table->keep[i] < 1) {
+      small[num_small++] = i;
+    } else {
+      large[num_large++] = i;
+    }
+  }
+  // fill each short column up to 1 with part of a tall one
+  while (num_small > 0 && num_large > 0) {
+    size_t short_col = small[--num_small];
+    size_t tall_col = large[num_large - 1];
+    table->alias[short_col] = tall_col;
+    table->keep[tall_col] -= 1 - table->keep[short_col];
+    if (table->keep[tall_col] < 1) {
+      num_large--;
+      small[num_small++] = tall_col;
+    }
+  }
+  // whatever is left is 1 up to rounding error
+  while (num_large > 0) {
+    table->keep[large[--num_large]] = 1;
+  }
+  while (num_small > 0) {
+    table->keep[small[--num_small]] = 1;
+  }
+  free(small);
+  free(large);
+  return table;
+}
+
+size_t alias_table_sample(alias_table_t *table, rng_t *rng) {
+  size_t column = rng_below(rng, table->size);
+  return rng_double(rng) < table->keep[column] ? column : table->alias[column];
+}
+
+void alias_table_free(alias_table_t *table) {
+  free(table->keep);
+  free(table->alias);
+  free(table);
+}
@@ -0,0 +1,120 @@
+#include "alloc_track.h"
+
+#ifdef ALLOC_TRACK
+
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <stdint.h>
+
+// the real allocators, for this file only
+#undef malloc
+#undef calloc
+#undef realloc
+
+const char *ALLOC_SUBSYSTEM_NAMES[NUM_ALLOC_SUBSYSTEMS] = {
+    [ALLOC_CORE] = "core",
+    [ALLOC_PHYSICS] = "physics",
+    [ALLOC_RENDER] = "render",
+    [ALLOC_ASSETS] = "assets",
+    [ALLOC_GAME] = "game"};
+
+typedef struct alloc_stats {
+  size_t allocs[NUM_ALLOC_SUBSYSTEMS];
+  size_t bytes[NUM_ALLOC_SUBSYSTEMS];
+} alloc_stats_t;
+
+// what the calling thread allocated since its last frame ended
+static _Thread_local alloc_stats_t THREAD_FRAME;
+static _Thread_local size_t THREAD_BUDGET = SIZE_MAX;
+
+/**
+ * Every ended frame, guarded by TOTALS_LOCK.
+ */
+static SDL_SpinLock TOTALS_LOCK = 0;
+static alloc_stats_t TOTALS;
+static size_t TOTAL_FRAMES = 0;
+static alloc_stats_t WORST_FRAME;
+static size_t WORST_FRAME_ALLOCS = 0;
+
+static void alloc_track_count(alloc_subsystem_t subsystem, size_t bytes) {
+  THREAD_FRAME.allocs[subsystem]++;
+  THREAD_FRAME.bytes[subsystem] += bytes;
+}
+
+void *alloc_track_malloc(size_t size, alloc_subsystem_t subsystem) {
+  alloc_track_count(subsystem, size);
+  return malloc(size);
+}
+
+void *alloc_track_calloc(size_t count, size_t size,
+                         alloc_subsystem_t subsystem) {
+  alloc_track_count(subsystem, count * size);
+  return calloc(count, size);
+}
+
+void *alloc_track_realloc(void *ptr, size_t size,
+                          alloc_subsystem_t subsystem) {
+  alloc_track_count(subsystem, size);
+  return realloc(ptr, size);
+}
+
+void alloc_track_frame_reset(void) { THREAD_FRAME = (alloc_stats_t){0}; }
+
+static size_t alloc_stats_allocs(alloc_stats_t *stats) {
+  size_t allocs = 0;
+  for (size_t s = 0; s < NUM_ALLOC_SUBSYSTEMS; s++) {
+    allocs += stats->allocs[s];
+  }
+  return allocs;
+}
+
+static void alloc_stats_print(FILE *file, alloc_stats_t *stats,
+                              double frames) {
+  for (size_t s = 0; s < NUM_ALLOC_SUBSYSTEMS; s++) {
+    fprintf(file, "  %-8s %12.2f allocs %14.1f bytes\n",
+            ALLOC_SUBSYSTEM_NAMES[s], stats->allocs[s] / frames,
+            stats->bytes[s] / frames);
+  }
+}
+
+size_t alloc_track_frame_allocs(void) {
+  return alloc_stats_allocs(&THREAD_FRAME);
+}
+
+void alloc_track_frame_end(void) {
+  size_t allocs = alloc_stats_allocs(&THREAD_FRAME);
+  SDL_AtomicLock(&TOTALS_LOCK);
+  for (size_t s = 0; s < NUM_ALLOC_SUBSYSTEMS; s++) {
+    TOTALS.allocs[s] += THREAD_FRAME.allocs[s];
+    TOTALS.bytes[s] += THREAD_FRAME.bytes[s];
+  }
+  TOTAL_FRAMES++;
+  if (allocs > WORST_FRAME_ALLOCS) {
+    WORST_FRAME_ALLOCS = allocs;
+    WORST_FRAME = THREAD_FRAME;
+  }
+  SDL_AtomicUnlock(&TOTALS_LOCK);
+
+  if (allocs > THREAD_BUDGET) {
+    fprintf(stderr, "frame made %zu allocations, over its budget of %zu:\n",
+            allocs, THREAD_BUDGET);
+    alloc_stats_print(stderr, &THREAD_FRAME, 1);
+  }
+  assert(allocs <= THREAD_BUDGET);
+  alloc_track_frame_reset();
+}
+
+void alloc_track_set_budget(size_t max_allocs) { THREAD_BUDGET = max_allocs; }
+
+void alloc_track_report(FILE *file) {
+  SDL_AtomicLock(&TOTALS_LOCK);
+  if (TOTAL_FRAMES > 0) {
+    fprintf(file, "allocations per frame, over %zu frames:\n", TOTAL_FRAMES);
+    alloc_stats_print(file, &TOTALS, TOTAL_FRAMES);
+    fprintf(file, "worst frame, %zu allocations:\n", WORST_FRAME_ALLOCS);
+    alloc_stats_print(file, &WORST_FRAME, 1);
+  }
+  SDL_AtomicUnlock(&TOTALS_LOCK);
+}
+
+#endif // #ifdef ALLOC_TRACK
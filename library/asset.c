@@ -5,9 +5,14 @@
 #include "asset.h"
 #include "asset_cache.h"
 #include "color.h"
+#include "entity.h"
 #include "sdl_wrapper.h"
 #include "body.h"
 #include "mystr.h"
+#include "profile.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_ASSETS);
 
 const Uint8 OPAQUE_ALPHA_VALUE = 255;
 
@@ -16,22 +21,18 @@ typedef struct asset {
   SDL_Rect bounding_box;
 } asset_t;
 
-typedef struct body_info {
-  bool is_tile;
-  char *name;
-  size_t index;
-} body_info_t;
-
 typedef struct text_asset {
   asset_t base;
   TTF_Font *font;
   const char *text;
   rgb_color_t color;
+  // drawn from a cached texture of the whole string instead of glyph by glyph
+  bool is_static;
 } text_asset_t;
 
 typedef struct image_asset {
   asset_t base;
-  SDL_Texture *texture;
+  const sprite_t *sprite;
   body_t *body;
 } image_asset_t;
 
@@ -87,28 +88,22 @@ body_t *get_image_asset_body(asset_t *asset) {
 }
 
 bool asset_is_tile(asset_t *asset) {
-    body_t *asset_body = get_image_asset_body(asset);
-    if (asset_body != NULL) {
-        body_info_t *body_info = (body_info_t *) body_get_info(asset_body);
-        return body_info->is_tile;
-    }
-    return false;
+  body_t *asset_body = get_image_asset_body(asset);
+  if (asset_body != NULL) {
+    body_info_t *body_info = (body_info_t *)body_get_info(asset_body);
+    return body_info != NULL && (body_info->flags & ENTITY_IS_TILE);
   }
-
-
-bool check_asset_info_field(asset_t *asset, char *info_field) {
-    if (asset->type == ASSET_IMAGE) {
-        body_t *body = get_image_asset_body(asset);
-        body_info_t *body_info = (body_info_t *) body_get_info(body);
-        if (body != NULL) {
-            if (body_info != NULL && strcmp(body_info->name, info_field) == 0) {
-                return true;
-            }
-        }
-    }
-    return false;
+  return false;
 }
 
+bool asset_is_entity(asset_t *asset, entity_kind_t kind) {
+  body_t *body = get_image_asset_body(asset);
+  if (body != NULL) {
+    body_info_t *body_info = (body_info_t *)body_get_info(body);
+    return body_info != NULL && body_info->kind == kind;
+  }
+  return false;
+}
 
 vector_t asset_get_centroid(asset_t *asset) {
   body_t *body = get_image_asset_body(asset);
@@ -125,20 +120,25 @@ asset_t *asset_make_image(const char *filepath, SDL_Rect bounding_box) {
 
 asset_t *asset_make_image_with_body(const char *filepath, SDL_Rect bounding,
                                     body_t *body) {
-  image_asset_t *img = malloc(sizeof(image_asset_t));
-  assert(img);
-  img->base = *asset_init(ASSET_IMAGE, bounding);
-  img->texture = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
+  image_asset_t *img = (image_asset_t *)asset_init(ASSET_IMAGE, bounding);
+  img->sprite = asset_cache_acquire_sprite(filepath);
   img->body = body;
   return (asset_t *)img;
 }
 
+void asset_set_image(asset_t *asset, const char *filepath) {
+  assert(asset->type == ASSET_IMAGE);
+  image_asset_t *img = (image_asset_t *)asset;
+  // acquired first, so a sprite shared with the old image stays resident
+  const sprite_t *sprite = asset_cache_acquire_sprite(filepath);
+  asset_cache_release_sprite(img->sprite);
+  img->sprite = sprite;
+}
+
 asset_t *asset_make_image_with_body_cam(const char *filepath, SDL_Rect bounding,
                                     body_t *body, double cam_movement) {
-  image_asset_t *img = malloc(sizeof(image_asset_t));
-  assert(img);
-  img->base = *asset_init(ASSET_IMAGE, bounding);
-  img->texture = asset_cache_obj_get_or_create(ASSET_IMAGE, filepath);
+  image_asset_t *img = (image_asset_t *)asset_init(ASSET_IMAGE, bounding);
+  img->sprite = asset_cache_acquire_sprite(filepath);
   img->body = body;
   vector_t current_position = body_get_centroid(img->body); 
   vector_t new_position = (vector_t){.x = current_position.x, .y = current_position.y + cam_movement};
@@ -148,12 +148,19 @@ asset_t *asset_make_image_with_body_cam(const char *filepath, SDL_Rect bounding,
 
 asset_t *asset_make_text(const char *filepath, SDL_Rect bounding_box,
                          const char *text, rgb_color_t color) {
-  text_asset_t *t = malloc(sizeof(text_asset_t));
-  assert(t);
-  t->base = *asset_init(ASSET_FONT, bounding_box);
+  text_asset_t *t = (text_asset_t *)asset_init(ASSET_FONT, bounding_box);
   t->font = asset_cache_obj_get_or_create(ASSET_FONT, filepath);
   t->text = text;
   t->color = color;
+  t->is_static = false;
+  return (asset_t *)t;
+}
+
+asset_t *asset_make_static_text(const char *filepath, SDL_Rect bounding_box,
+                                const char *text, rgb_color_t color) {
+  text_asset_t *t = (text_asset_t *)asset_make_text(filepath, bounding_box,
+                                                    text, color);
+  t->is_static = true;
   return (asset_t *)t;
 }
 
@@ -161,12 +168,12 @@ asset_t *asset_make_button(SDL_Rect bounding_box, asset_t *image_asset,
                            asset_t *text_asset, button_handler_t handler) {
   assert(image_asset == NULL || image_asset->type == ASSET_IMAGE);
   assert(text_asset == NULL || text_asset->type == ASSET_FONT);
-  button_asset_t *button = malloc(sizeof(text_asset_t));
-  assert(button);
-  button->base = *asset_init(ASSET_BUTTON, bounding_box);
+  button_asset_t *button =
+      (button_asset_t *)asset_init(ASSET_BUTTON, bounding_box);
   button->image_asset = (image_asset_t *)image_asset;
   button->text_asset = (text_asset_t *)text_asset;
   button->handler = handler;
+  button->is_rendered = false;
 
   return (asset_t *)button;
 }
@@ -199,27 +206,48 @@ void asset_on_button_click(asset_t *button, state_t *state, double x,
   return;
 }
 
+/**
+ * Draws an image asset's sprite into the given box on the screen.
+ * Images that are still being preloaded are skipped.
+ */
+static void image_render(image_asset_t *img, SDL_Rect box) {
+  if (img->sprite->texture == NULL) {
+    return;
+  }
+  sdl_render_image_clip(img->sprite->texture, &img->sprite->src, box.w, box.h,
+                        box.x, box.y);
+}
+
+/**
+ * Draws a text asset at the top left corner of its bounding box.
+ */
+static void text_render(text_asset_t *text) {
+  SDL_Color c = (SDL_Color){.r = text->color.r,
+                            .g = text->color.g,
+                            .b = text->color.b,
+                            .a = OPAQUE_ALPHA_VALUE};
+  vector_t position = {.x = text->base.bounding_box.x,
+                       .y = text->base.bounding_box.y};
+  if (text->is_static) {
+    sdl_render_static_text(text->text, text->font, position, c);
+  } else {
+    sdl_render_text(text->text, text->font, position, c);
+  }
+}
+
 void asset_render(asset_t *asset) {
+  PROFILE_FUNCTION();
   switch (asset->type) {
   case ASSET_IMAGE: {
     image_asset_t *img = (image_asset_t *)asset;
     if (img->body != NULL) {
       asset->bounding_box = sdl_get_bounding_box(img->body);
     }
-    sdl_render_image(img->texture, asset->bounding_box.w, asset->bounding_box.h,
-                     asset->bounding_box.x, asset->bounding_box.y);
+    image_render(img, asset->bounding_box);
     break;
   }
   case ASSET_FONT: {
-    text_asset_t *text = (text_asset_t *)asset;
-    SDL_Color c = (SDL_Color){.r = text->color.r,
-                              .g = text->color.g,
-                              .b = text->color.b,
-                              .a = OPAQUE_ALPHA_VALUE};
-    sdl_render_text(text->text, text->font,
-                    (vector_t){.x = text->base.bounding_box.x,
-                               .y = text->base.bounding_box.y},
-                    c);
+    text_render((text_asset_t *)asset);
     break;
   }
   case ASSET_BUTTON: {
@@ -239,60 +267,16 @@ void asset_render(asset_t *asset) {
   }
 }
 
+void asset_render_in(asset_t *asset, aabb_t bounds) {
+  assert(asset->type == ASSET_IMAGE);
+  image_render((image_asset_t *)asset, sdl_get_pixel_rect(bounds));
+}
 
-void asset_render_with_cam(asset_t *asset, double cam_height, bool up) {
-  switch (asset->type) {
-  case ASSET_IMAGE: {
+
+void asset_destroy(asset_t *asset) {
+  if (asset->type == ASSET_IMAGE) {
     image_asset_t *img = (image_asset_t *)asset;
-    if (img->body != NULL && up) {
-      SDL_Rect bbox = sdl_get_bounding_box(img->body);
-      //img->body.y += cam_height;
-      // body_t *body = img->body;
-      bbox.y += cam_height; // Adjust the bounding box position
-      // if (bbox.y < cam_height) {
-        sdl_render_image(img->texture, bbox.w, bbox.h, bbox.x, bbox.y);
-      // }
-    }
-    else if (img->body != NULL && !up) {
-      SDL_Rect bbox = sdl_get_bounding_box(img->body);
-      bbox.y -= cam_height;
-      // if (bbox.y < cam_height) {
-        sdl_render_image(img->texture, bbox.w, bbox.h, bbox.x, bbox.y);
-      // }
-    }
-    else {
-      sdl_render_image(img->texture, asset->bounding_box.w, asset->bounding_box.h,
-                        asset->bounding_box.x, asset->bounding_box.y);
-    }
-    break;
-  }
-  case ASSET_FONT: {
-    text_asset_t *text = (text_asset_t *)asset;
-    SDL_Color c = (SDL_Color){.r = text->color.r,
-                              .g = text->color.g,
-                              .b = text->color.b,
-                              .a = OPAQUE_ALPHA_VALUE};
-    sdl_render_text(text->text, text->font,
-                    (vector_t){.x = text->base.bounding_box.x,
-                               .y = text->base.bounding_box.y},
-                    c);
-    break;
-  }
-  case ASSET_BUTTON: {
-    button_asset_t *button = (button_asset_t *)asset;
-    if (button->image_asset != NULL) {
-      asset_render((asset_t *)button->image_asset);
-    }
-    if (button->text_asset != NULL) {
-      asset_render((asset_t *)button->text_asset);
-    }
-    button->is_rendered = true;
-    break;
-  }
-  default: {
-    assert(false && "Invalid Asset Type");
-  }
+    asset_cache_release_sprite(img->sprite);
   }
+  free(asset);
 }
-
-void asset_destroy(asset_t *asset) { free(asset); }
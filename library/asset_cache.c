@@ -1,41 +1,226 @@
 #include <SDL2/SDL_image.h>
+#include <SDL2/SDL_mixer.h>
 #include <SDL2/SDL_ttf.h>
 #include <assert.h>
+#include <stddef.h>
 
 #include "asset.h"
 #include "asset_cache.h"
+#include "asset_pack.h"
+#include "atlas.h"
 #include "list.h"
+#include "profile.h"
 #include "sdl_wrapper.h"
+#include "text_cache.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_ASSETS);
 
 static list_t *ASSET_CACHE;
+// atlas page textures; entries packed into a page don't own their texture
+static list_t *ATLAS_PAGES;
+// decoded atlas images waiting for the rest of their batch
+static list_t *ATLAS_BATCH;
+// atlas images queued for decoding but not yet in ATLAS_BATCH
+static size_t ATLAS_OUTSTANDING;
+// bytes held by the atlas pages, which are never evicted
+static size_t ATLAS_BYTES;
+// evictable bytes the cache tries to stay under
+static size_t BUDGET_BYTES;
+// bumped on every retain/release to order entries by recency
+static size_t USE_CLOCK;
+// the mounted pre-baked asset pack, or NULL to decode the original files
+static asset_pack_t *PACK;
+// textures of the pack's atlas pages, uploaded on first use (also owned by
+// ATLAS_PAGES)
+static SDL_Texture **PACK_PAGES;
+static size_t NUM_PACK_PAGES;
 
 const size_t FONT_SIZE = 18;
 const size_t INITIAL_CAPACITY = 5;
+// the largest atlas page we allocate, if the renderer allows it
+const int ATLAS_PAGE_SIZE = 2048;
+// upper bound on background decoding threads
+#define MAX_LOADER_THREADS 4
+// textures uploaded per asset_cache_pump call, to keep frames smooth
+const size_t UPLOADS_PER_PUMP = 2;
+const size_t DEFAULT_BUDGET_BYTES = 32 * 1024 * 1024;
 
 typedef struct {
   asset_type_t type;
   const char *filepath;
+  // the font, sound or button (unused for images)
   void *obj;
+  // the texture and region holding the image (images only)
+  sprite_t sprite;
+  // false if the texture is a shared atlas page
+  bool owns_obj;
+  // true while a preload of this entry is still in flight
+  bool loading;
+  // true once its file failed to load, so lookups don't retry it every time
+  bool failed;
+  // number of assets and scopes holding on to this entry
+  size_t refcount;
+  // USE_CLOCK when the entry was last retained or released
+  size_t last_used;
+  // memory held by the texture/sound, if the cache owns it
+  size_t bytes;
 } entry_t;
 
-static void asset_cache_free_entry(entry_t *entry) {
-  assert(entry);
+struct asset_scope {
+  list_t *entries;
+};
+
+typedef struct atlas_image {
+  entry_t *entry;
+  SDL_Surface *surface;
+  SDL_Rect src;
+  bool placed;
+} atlas_image_t;
+
+/**
+ * A request to decode one file off the main thread. Workers only read
+ * `type`, `filepath` and `atlas` and write `decoded`; `entry` is filled in
+ * on the main thread by asset_cache_pump.
+ */
+typedef struct load_job {
+  asset_type_t type;
+  char *filepath;
+  entry_t *entry;
+  bool atlas;
+  // SDL_Surface * for images, Mix_Chunk * for sounds, NULL on failure
+  void *decoded;
+} load_job_t;
+
+/**
+ * The background loader. `pending` and `decoded` are guarded by `lock`.
+ * If no worker thread could be started (e.g. a build without thread
+ * support), asset_cache_pump decodes the pending jobs itself.
+ */
+typedef struct loader {
+  SDL_mutex *lock;
+  SDL_cond *has_jobs;
+  list_t *pending;
+  list_t *decoded;
+  SDL_Thread *workers[MAX_LOADER_THREADS];
+  size_t num_workers;
+  bool started;
+  bool quit;
+  // only touched on the main thread
+  size_t num_queued;
+  size_t num_finished;
+} loader_t;
+
+static loader_t LOADER;
+
+/**
+ * Frees the texture/sound/font held by the entry, leaving the entry itself
+ * in the cache so it can be loaded again on the next request.
+ */
+static void entry_unload(entry_t *entry) {
   if (entry->type == ASSET_IMAGE) {
-    SDL_DestroyTexture(entry->obj);
+    if (entry->owns_obj && entry->sprite.texture != NULL) {
+      sdl_destroy_texture(entry->sprite.texture);
+    }
+    entry->sprite.texture = NULL;
   } else if (entry->type == ASSET_FONT) {
+    if (entry->obj != NULL) {
+      // a font opened later may get this one's address
+      text_cache_forget_font(entry->obj);
+    }
     TTF_CloseFont(entry->obj);
-  } else if (entry->type == ASSET_BUTTON) {
+    entry->obj = NULL;
+  } else if (entry->type == ASSET_SOUND) {
+    Mix_FreeChunk(entry->obj);
+    entry->obj = NULL;
+  }
+  entry->bytes = 0;
+}
+
+static void asset_cache_free_entry(entry_t *entry) {
+  assert(entry);
+  entry_unload(entry);
+  if (entry->type == ASSET_BUTTON) {
     free(entry->obj);
   }
+  free((char *)entry->filepath);
   free(entry);
 }
 
+/**
+ * Frees a load job along with whatever it decoded.
+ */
+static void load_job_free(load_job_t *job) {
+  if (job->decoded != NULL) {
+    if (job->type == ASSET_IMAGE) {
+      SDL_FreeSurface(job->decoded);
+    } else if (job->type == ASSET_SOUND) {
+      Mix_FreeChunk(job->decoded);
+    }
+  }
+  free(job->filepath);
+  free(job);
+}
+
 void asset_cache_init() {
   ASSET_CACHE =
       list_init(INITIAL_CAPACITY, (free_func_t)asset_cache_free_entry);
+  ATLAS_PAGES = list_init(1, (free_func_t)sdl_destroy_texture);
+  ATLAS_BATCH = list_init(INITIAL_CAPACITY, free);
+  ATLAS_OUTSTANDING = 0;
+  ATLAS_BYTES = 0;
+  BUDGET_BYTES = DEFAULT_BUDGET_BYTES;
+  USE_CLOCK = 0;
+  PACK = NULL;
+  PACK_PAGES = NULL;
+  NUM_PACK_PAGES = 0;
+  LOADER = (loader_t){.started = false, .quit = false};
+  LOADER.lock = SDL_CreateMutex();
+  LOADER.has_jobs = SDL_CreateCond();
+  LOADER.pending = list_init(INITIAL_CAPACITY, (free_func_t)load_job_free);
+  LOADER.decoded = list_init(INITIAL_CAPACITY, (free_func_t)load_job_free);
 }
 
-void asset_cache_destroy() { list_free(ASSET_CACHE); }
+void asset_cache_destroy() {
+  SDL_LockMutex(LOADER.lock);
+  LOADER.quit = true;
+  SDL_CondBroadcast(LOADER.has_jobs);
+  SDL_UnlockMutex(LOADER.lock);
+  for (size_t i = 0; i < LOADER.num_workers; i++) {
+    SDL_WaitThread(LOADER.workers[i], NULL);
+  }
+  list_free(LOADER.pending);
+  list_free(LOADER.decoded);
+  SDL_DestroyCond(LOADER.has_jobs);
+  SDL_DestroyMutex(LOADER.lock);
+
+  for (size_t i = 0; i < list_size(ATLAS_BATCH); i++) {
+    atlas_image_t *img = list_get(ATLAS_BATCH, i);
+    SDL_FreeSurface(img->surface);
+  }
+  list_free(ATLAS_BATCH);
+  list_free(ASSET_CACHE);
+  list_free(ATLAS_PAGES);
+  free(PACK_PAGES);
+  // closed last, since packed sounds and fonts point into it
+  if (PACK != NULL) {
+    asset_pack_close(PACK);
+  }
+}
+
+bool asset_cache_mount_pack(const char *path) {
+  assert(PACK == NULL);
+  PACK = asset_pack_open(path);
+  if (PACK == NULL) {
+    return false;
+  }
+  while (asset_pack_find_page(PACK, NUM_PACK_PAGES) != NULL) {
+    NUM_PACK_PAGES++;
+  }
+  PACK_PAGES = calloc(NUM_PACK_PAGES + 1, sizeof(SDL_Texture *));
+  assert(PACK_PAGES);
+  return true;
+}
 
 /**
  * Checks whether the given entry already corresponds to a filepath
@@ -55,33 +240,593 @@ entry_t *asset_found(const char *filepath) {
   return NULL;
 }
 
+/**
+ * Allocates an empty cache entry and adds it to the cache.
+ */
+static entry_t *asset_cache_add_entry(asset_type_t ty, const char *filepath) {
+  entry_t *new = malloc(sizeof(entry_t));
+  assert(new);
+  new->filepath = filepath != NULL ? strdup(filepath) : NULL;
+  new->type = ty;
+  new->obj = NULL;
+  new->sprite = (sprite_t){.texture = NULL, .src = {0, 0, 0, 0}};
+  new->owns_obj = true;
+  new->loading = false;
+  new->failed = false;
+  new->refcount = 0;
+  new->last_used = USE_CLOCK;
+  new->bytes = 0;
+  list_add(ASSET_CACHE, new);
+  return new;
+}
+
+/**
+ * Makes `texture` the image of `entry`, covering the whole texture.
+ */
+static void entry_set_texture(entry_t *entry, SDL_Texture *texture) {
+  entry->sprite.texture = texture;
+  entry->sprite.src = (SDL_Rect){0, 0, 0, 0};
+  entry->bytes = 0;
+  if (texture != NULL) {
+    Uint32 format;
+    SDL_QueryTexture(texture, &format, NULL, &entry->sprite.src.w,
+                     &entry->sprite.src.h);
+    entry->bytes = (size_t)entry->sprite.src.w * entry->sprite.src.h *
+                   SDL_BYTESPERPIXEL(format);
+  }
+}
+
+/**
+ * Makes `chunk` the sound of `entry`.
+ */
+static void entry_set_sound(entry_t *entry, Mix_Chunk *chunk) {
+  entry->obj = chunk;
+  entry->bytes = chunk != NULL ? chunk->alen : 0;
+}
+
+/**
+ * Checks whether the entry's texture/sound/font is currently in memory.
+ */
+static bool entry_is_resident(entry_t *entry) {
+  if (entry->type == ASSET_IMAGE) {
+    return entry->sprite.texture != NULL;
+  }
+  return entry->obj != NULL;
+}
+
+/**
+ * Gets the texture of one of the pack's atlas pages, uploading it the first
+ * time it is needed.
+ */
+static SDL_Texture *pack_page_texture(uint32_t page) {
+  if (page >= NUM_PACK_PAGES) {
+    return NULL;
+  }
+  if (PACK_PAGES[page] == NULL) {
+    const pack_entry_t *baked = asset_pack_find_page(PACK, page);
+    SDL_Texture *texture = sdl_create_texture_from_pixels(
+        baked->format, baked->width, baked->height,
+        asset_pack_data(PACK, baked), baked->pitch);
+    if (texture == NULL) {
+      return NULL;
+    }
+    PACK_PAGES[page] = texture;
+    list_add(ATLAS_PAGES, texture);
+    ATLAS_BYTES += (size_t)baked->height * baked->pitch;
+  }
+  return PACK_PAGES[page];
+}
+
+/**
+ * Loads an entry straight out of the mounted pack, which needs no decoding.
+ *
+ * @return whether the pack had the entry in a usable form; if not, the
+ *   original file has to be decoded instead
+ */
+static bool entry_load_from_pack(entry_t *entry) {
+  if (PACK == NULL || entry->filepath == NULL) {
+    return false;
+  }
+  const pack_entry_t *baked = asset_pack_find(PACK, entry->filepath);
+  if (baked == NULL) {
+    return false;
+  }
+  const void *data = asset_pack_data(PACK, baked);
+  if (entry->type == ASSET_IMAGE && baked->type == PACK_IMAGE) {
+    entry->owns_obj = true;
+    entry_set_texture(entry,
+                      sdl_create_texture_from_pixels(
+                          baked->format, baked->width, baked->height, data,
+                          baked->pitch));
+    return entry->sprite.texture != NULL;
+  } else if (entry->type == ASSET_IMAGE && baked->type == PACK_SPRITE) {
+    entry->owns_obj = false;
+    entry->bytes = 0;
+    entry->sprite = (sprite_t){
+        .texture = pack_page_texture(baked->page),
+        .src = {baked->x, baked->y, baked->width, baked->height}};
+    return entry->sprite.texture != NULL;
+  } else if (entry->type == ASSET_SOUND && baked->type == PACK_SOUND) {
+    int freq;
+    Uint16 format;
+    int channels;
+    if (Mix_QuerySpec(&freq, &format, &channels) == 0 ||
+        (uint32_t)freq != baked->freq || format != baked->format ||
+        (uint32_t)channels != baked->channels) {
+      // baked for a different output format; let SDL_mixer convert the file
+      return false;
+    }
+    // the chunk points into the read-only mapping; SDL_mixer never writes
+    // to (or frees) samples of a chunk made with Mix_QuickLoad_RAW
+    entry->obj = Mix_QuickLoad_RAW((Uint8 *)data, baked->size);
+    // the samples live in the mapped pack, not in memory the cache owns
+    entry->bytes = 0;
+    return entry->obj != NULL;
+  } else if (entry->type == ASSET_FONT && baked->type == PACK_FONT) {
+    entry->obj =
+        TTF_OpenFontRW(SDL_RWFromConstMem(data, baked->size), 1, FONT_SIZE);
+    return entry->obj != NULL;
+  }
+  return false;
+}
+
+/**
+ * Loads the file of an entry that isn't resident, on the calling thread.
+ */
+static void entry_load(entry_t *entry) {
+  if (entry_load_from_pack(entry)) {
+    return;
+  }
+  if (entry->type == ASSET_IMAGE) {
+    // a standalone texture, even if the image was meant for an atlas page
+    entry->owns_obj = true;
+    entry_set_texture(entry, sdl_display(entry->filepath));
+  } else if (entry->type == ASSET_FONT) {
+    entry->obj = TTF_OpenFont(entry->filepath, FONT_SIZE);
+  } else if (entry->type == ASSET_SOUND) {
+    entry_set_sound(entry, Mix_LoadWAV(entry->filepath));
+  }
+}
+
+/**
+ * Gets the number of bytes held by textures and sounds that the cache may
+ * evict, i.e. everything it owns except the atlas pages.
+ */
+static size_t evictable_bytes(void) {
+  size_t total = 0;
+  for (size_t i = 0; i < list_size(ASSET_CACHE); i++) {
+    entry_t *entry = list_get(ASSET_CACHE, i);
+    if (entry->owns_obj) {
+      total += entry->bytes;
+    }
+  }
+  return total;
+}
+
+/**
+ * Evicts unreferenced textures and sounds, least recently used first, until
+ * the cache is back under its budget or nothing else can be evicted.
+ */
+static void asset_cache_trim(void) {
+  size_t used = evictable_bytes();
+  while (used > BUDGET_BYTES) {
+    entry_t *oldest = NULL;
+    for (size_t i = 0; i < list_size(ASSET_CACHE); i++) {
+      entry_t *entry = list_get(ASSET_CACHE, i);
+      if (entry->refcount > 0 || !entry->owns_obj || entry->bytes == 0 ||
+          entry->loading) {
+        continue;
+      }
+      if (oldest == NULL || entry->last_used < oldest->last_used) {
+        oldest = entry;
+      }
+    }
+    if (oldest == NULL) {
+      return;
+    }
+    used -= oldest->bytes;
+    entry_unload(oldest);
+  }
+}
+
+static void entry_retain(entry_t *entry) {
+  entry->refcount++;
+  entry->last_used = ++USE_CLOCK;
+}
+
+static void entry_release(entry_t *entry) {
+  assert(entry->refcount > 0);
+  entry->refcount--;
+  entry->last_used = ++USE_CLOCK;
+  if (entry->refcount == 0) {
+    asset_cache_trim();
+  }
+}
+
+static entry_t *asset_cache_entry_get_or_create(asset_type_t ty,
+                                                const char *filepath) {
+  entry_t *entry = asset_found(filepath);
+  if (entry == NULL) {
+    entry = asset_cache_add_entry(ty, filepath);
+  }
+  assert(entry->type == ty);
+  if (!entry->loading && !entry->failed && !entry_is_resident(entry)) {
+    // never loaded, or evicted since it was last used
+    entry_load(entry);
+    entry->failed = !entry_is_resident(entry);
+    entry->last_used = ++USE_CLOCK;
+    asset_cache_trim();
+  }
+  return entry;
+}
+
 void *asset_cache_obj_get_or_create(asset_type_t ty, const char *filepath) {
-  entry_t *found_entry = asset_found(filepath);
-  if (found_entry == NULL) {
-    entry_t *new = malloc(sizeof(entry_t));
-    assert(new);
-    new->filepath = strdup(filepath);
-    new->type = ty;
-    if (ty == ASSET_IMAGE) {
-      new->obj = sdl_display(filepath);
-    } else if (ty == ASSET_FONT) {
-      new->obj = TTF_OpenFont(filepath, FONT_SIZE);
+  entry_t *entry = asset_cache_entry_get_or_create(ty, filepath);
+  if (ty == ASSET_IMAGE) {
+    return entry->sprite.texture;
+  }
+  return entry->obj;
+}
+
+const sprite_t *asset_cache_acquire_sprite(const char *filepath) {
+  entry_t *entry = asset_cache_entry_get_or_create(ASSET_IMAGE, filepath);
+  entry_retain(entry);
+  return &entry->sprite;
+}
+
+void asset_cache_release_sprite(const sprite_t *sprite) {
+  entry_t *entry = (entry_t *)((char *)sprite - offsetof(entry_t, sprite));
+  entry_release(entry);
+}
+
+asset_scope_t *asset_scope_init(void) {
+  asset_scope_t *scope = malloc(sizeof(asset_scope_t));
+  assert(scope);
+  scope->entries = list_init(INITIAL_CAPACITY, NULL);
+  return scope;
+}
+
+void asset_scope_retain(asset_scope_t *scope, asset_type_t ty,
+                        const char *filepath) {
+  entry_t *entry = asset_cache_entry_get_or_create(ty, filepath);
+  entry_retain(entry);
+  list_add(scope->entries, entry);
+}
+
+void asset_scope_free(asset_scope_t *scope) {
+  for (size_t i = 0; i < list_size(scope->entries); i++) {
+    entry_release(list_get(scope->entries, i));
+  }
+  list_free(scope->entries);
+  free(scope);
+}
+
+void asset_cache_set_budget(size_t budget_bytes) {
+  BUDGET_BYTES = budget_bytes;
+  asset_cache_trim();
+}
+
+asset_cache_usage_t asset_cache_get_usage(void) {
+  asset_cache_usage_t usage = {.budget_bytes = BUDGET_BYTES,
+                               .atlas_bytes = ATLAS_BYTES,
+                               .evictable_bytes = evictable_bytes(),
+                               .num_resident = 0,
+                               .num_evicted = 0};
+  for (size_t i = 0; i < list_size(ASSET_CACHE); i++) {
+    entry_t *entry = list_get(ASSET_CACHE, i);
+    if (entry->type == ASSET_BUTTON || entry->loading) {
+      continue;
+    }
+    if (entry_is_resident(entry)) {
+      usage.num_resident++;
+    } else {
+      usage.num_evicted++;
+    }
+  }
+  return usage;
+}
+
+/**
+ * Decodes the file of a load job. Safe to call from any thread, since it
+ * touches neither the renderer nor the cache.
+ */
+static void load_job_decode(load_job_t *job) {
+  if (job->type == ASSET_IMAGE) {
+    SDL_Surface *surface = IMG_Load(job->filepath);
+    if (surface != NULL && job->atlas) {
+      // atlas pages are RGBA, so convert here instead of on the main thread
+      SDL_Surface *converted =
+          SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_RGBA32, 0);
+      SDL_FreeSurface(surface);
+      surface = converted;
+    }
+    job->decoded = surface;
+  } else if (job->type == ASSET_SOUND) {
+    job->decoded = Mix_LoadWAV(job->filepath);
+  }
+}
+
+static int loader_worker(void *aux) {
+  loader_t *loader = aux;
+  SDL_LockMutex(loader->lock);
+  while (true) {
+    while (list_size(loader->pending) == 0 && !loader->quit) {
+      SDL_CondWait(loader->has_jobs, loader->lock);
     }
-    list_add(ASSET_CACHE, new);
-    return new->obj;
+    if (loader->quit) {
+      break;
+    }
+    load_job_t *job = list_remove(loader->pending, 0);
+    SDL_UnlockMutex(loader->lock);
+    load_job_decode(job);
+    SDL_LockMutex(loader->lock);
+    list_add(loader->decoded, job);
+  }
+  SDL_UnlockMutex(loader->lock);
+  return 0;
+}
+
+/**
+ * Starts the worker threads the first time anything is preloaded.
+ */
+static void loader_start(void) {
+  if (LOADER.started) {
+    return;
+  }
+  LOADER.started = true;
+  int num_threads = SDL_GetCPUCount() - 1;
+  if (num_threads < 1) {
+    num_threads = 1;
+  }
+  if (num_threads > MAX_LOADER_THREADS) {
+    num_threads = MAX_LOADER_THREADS;
+  }
+  for (int i = 0; i < num_threads; i++) {
+    SDL_Thread *worker = SDL_CreateThread(loader_worker, "asset", &LOADER);
+    if (worker == NULL) {
+      break;
+    }
+    LOADER.workers[LOADER.num_workers] = worker;
+    LOADER.num_workers++;
+  }
+}
+
+/**
+ * Creates a loading placeholder entry for `filepath` and queues its decode.
+ * Does nothing if the file is already cached or queued.
+ */
+static void loader_enqueue(asset_type_t ty, const char *filepath, bool atlas) {
+  if (asset_found(filepath) != NULL) {
+    return;
+  }
+  entry_t *entry = asset_cache_add_entry(ty, filepath);
+  if (entry_load_from_pack(entry)) {
+    // already decoded (and possibly packed into a page) by the baker
+    LOADER.num_queued++;
+    LOADER.num_finished++;
+    return;
+  }
+  loader_start();
+  entry->loading = true;
+  entry->owns_obj = !atlas;
+  load_job_t *job = malloc(sizeof(load_job_t));
+  assert(job);
+  *job = (load_job_t){.type = ty,
+                      .filepath = strdup(filepath),
+                      .entry = entry,
+                      .atlas = atlas,
+                      .decoded = NULL};
+  if (atlas) {
+    ATLAS_OUTSTANDING++;
+  }
+  LOADER.num_queued++;
+  SDL_LockMutex(LOADER.lock);
+  list_add(LOADER.pending, job);
+  SDL_CondSignal(LOADER.has_jobs);
+  SDL_UnlockMutex(LOADER.lock);
+}
+
+void asset_cache_preload(asset_type_t ty, const char **filepaths,
+                         size_t num_paths) {
+  assert(ty == ASSET_IMAGE || ty == ASSET_SOUND);
+  for (size_t i = 0; i < num_paths; i++) {
+    loader_enqueue(ty, filepaths[i], false);
+  }
+}
+
+/**
+ * Sorts atlas images tallest first, which keeps shelves tightly filled.
+ */
+static int atlas_image_compare(const void *a, const void *b) {
+  const atlas_image_t *img_a = *(atlas_image_t *const *)a;
+  const atlas_image_t *img_b = *(atlas_image_t *const *)b;
+  return img_b->surface->h - img_a->surface->h;
+}
+
+/**
+ * Shelf-packs as many of the unplaced images as fit onto one atlas page of
+ * the given size, uploads the page and points each image's entry at it.
+ *
+ * @return the number of images placed on the page
+ */
+static size_t atlas_pack_page(atlas_image_t **images, size_t num_images,
+                              int page_size) {
+  SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, page_size, page_size,
+                                                     32, SDL_PIXELFORMAT_RGBA32);
+  assert(page);
+  atlas_shelf_t shelf;
+  atlas_shelf_init(&shelf, page_size);
+  size_t num_placed = 0;
+  for (size_t i = 0; i < num_images; i++) {
+    atlas_image_t *img = images[i];
+    if (img->placed || !atlas_shelf_place(&shelf, img->surface->w,
+                                          img->surface->h, &img->src)) {
+      continue;
+    }
+    // copy the alpha channel as is instead of blending onto the empty page
+    SDL_SetSurfaceBlendMode(img->surface, SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(img->surface, NULL, page, &img->src);
+    img->placed = true;
+    num_placed++;
+  }
+  if (num_placed > 0) {
+    SDL_Texture *texture = sdl_create_texture(page);
+    assert(texture);
+    list_add(ATLAS_PAGES, texture);
+    ATLAS_BYTES += (size_t)page->h * page->pitch;
+    for (size_t i = 0; i < num_images; i++) {
+      atlas_image_t *img = images[i];
+      if (img->placed && img->surface != NULL) {
+        img->entry->sprite = (sprite_t){.texture = texture, .src = img->src};
+        img->entry->loading = false;
+        SDL_FreeSurface(img->surface);
+        img->surface = NULL;
+      }
+    }
+  }
+  SDL_FreeSurface(page);
+  return num_placed;
+}
+
+/**
+ * Packs every image in ATLAS_BATCH onto as many atlas pages as needed.
+ * Images too large for a page get a texture of their own instead.
+ */
+static void atlas_pack_batch(void) {
+  int page_size = sdl_max_texture_size();
+  if (page_size > ATLAS_PAGE_SIZE) {
+    page_size = ATLAS_PAGE_SIZE;
+  }
+  size_t num_images = 0;
+  atlas_image_t **images =
+      malloc(sizeof(atlas_image_t *) * (list_size(ATLAS_BATCH) + 1));
+  assert(images);
+  for (size_t i = 0; i < list_size(ATLAS_BATCH); i++) {
+    atlas_image_t *img = list_get(ATLAS_BATCH, i);
+    if (img->surface->w > page_size || img->surface->h > page_size) {
+      img->entry->owns_obj = true;
+      entry_set_texture(img->entry, sdl_create_texture(img->surface));
+      img->entry->loading = false;
+      img->entry->failed = img->entry->sprite.texture == NULL;
+      SDL_FreeSurface(img->surface);
+      img->surface = NULL;
+      continue;
+    }
+    images[num_images] = img;
+    num_images++;
+  }
+  qsort(images, num_images, sizeof(atlas_image_t *), atlas_image_compare);
+
+  size_t num_placed = 0;
+  while (num_placed < num_images) {
+    size_t page_placed = atlas_pack_page(images, num_images, page_size);
+    assert(page_placed > 0);
+    num_placed += page_placed;
+  }
+  free(images);
+  // the batch's jobs only count as finished once their pages are uploaded
+  LOADER.num_finished += list_size(ATLAS_BATCH);
+  while (list_size(ATLAS_BATCH) > 0) {
+    free(list_remove(ATLAS_BATCH, list_size(ATLAS_BATCH) - 1));
+  }
+}
+
+void asset_cache_pack_atlas(const char **filepaths, size_t num_paths) {
+  for (size_t i = 0; i < num_paths; i++) {
+    loader_enqueue(ASSET_IMAGE, filepaths[i], true);
+  }
+}
+
+/**
+ * Moves the result of a finished load job into its cache entry.
+ * Must run on the main thread, since it may create textures.
+ *
+ * @return whether a texture was uploaded
+ */
+static bool loader_finish_job(load_job_t *job) {
+  entry_t *entry = job->entry;
+  bool uploaded = false;
+  // atlas images are counted by atlas_pack_batch instead
+  bool finished = true;
+  if (job->atlas) {
+    ATLAS_OUTSTANDING--;
+    if (job->decoded != NULL) {
+      atlas_image_t *img = malloc(sizeof(atlas_image_t));
+      assert(img);
+      *img = (atlas_image_t){
+          .entry = entry, .surface = job->decoded, .placed = false};
+      job->decoded = NULL;
+      list_add(ATLAS_BATCH, img);
+      finished = false;
+    } else {
+      entry->loading = false;
+    }
+    if (ATLAS_OUTSTANDING == 0 && list_size(ATLAS_BATCH) > 0) {
+      atlas_pack_batch();
+      uploaded = true;
+    }
+  } else if (job->type == ASSET_IMAGE) {
+    if (job->decoded != NULL) {
+      entry_set_texture(entry, sdl_create_texture(job->decoded));
+      uploaded = true;
+    }
+    entry->loading = false;
+  } else if (job->type == ASSET_SOUND) {
+    entry_set_sound(entry, job->decoded);
+    job->decoded = NULL;
+    entry->loading = false;
+  }
+  if (finished) {
+    entry->failed = !entry_is_resident(entry);
+    LOADER.num_finished++;
+  }
+  load_job_free(job);
+  asset_cache_trim();
+  return uploaded;
+}
+
+void asset_cache_pump(void) {
+  PROFILE_FUNCTION();
+  size_t uploads = 0;
+  while (uploads < UPLOADS_PER_PUMP) {
+    load_job_t *job = NULL;
+    SDL_LockMutex(LOADER.lock);
+    if (list_size(LOADER.decoded) > 0) {
+      job = list_remove(LOADER.decoded, 0);
+    } else if (LOADER.num_workers == 0 && list_size(LOADER.pending) > 0) {
+      job = list_remove(LOADER.pending, 0);
+    }
+    SDL_UnlockMutex(LOADER.lock);
+    if (job == NULL) {
+      break;
+    }
+    if (job->decoded == NULL) {
+      // no workers: decode it right here, one file per frame at most
+      load_job_decode(job);
+      uploads = UPLOADS_PER_PUMP;
+    }
+    if (loader_finish_job(job)) {
+      uploads++;
+    }
+  }
+}
+
+bool asset_cache_is_loading(const char *filepath) {
+  entry_t *entry = asset_found(filepath);
+  return entry != NULL && entry->loading;
+}
+
+double asset_cache_preload_progress(void) {
+  if (LOADER.num_queued == 0) {
+    return 1.0;
   }
-  assert(found_entry->type == ty);
-  return found_entry->obj;
+  return (double)LOADER.num_finished / LOADER.num_queued;
 }
 
 void asset_cache_register_button(asset_t *button) {
   assert(button);
-  entry_t *new_button = malloc(sizeof(entry_t));
-  assert(new_button);
-  new_button->filepath = NULL;
-  new_button->obj = button;
-  new_button->type = ASSET_BUTTON;
-  list_add(ASSET_CACHE, new_button);
+  entry_t *entry = asset_cache_add_entry(ASSET_BUTTON, NULL);
+  entry->obj = button;
 }
 
 void asset_cache_handle_buttons(state_t *state, double x, double y) {
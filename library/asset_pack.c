@@ -0,0 +1,121 @@
+#include <assert.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "asset_pack.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_ASSETS);
+
+const char PACK_MAGIC[4] = {'B', 'J', 'P', 'K'};
+const uint32_t PACK_VERSION = 1;
+
+struct asset_pack {
+  const uint8_t *map;
+  size_t map_size;
+  const pack_header_t *header;
+  const pack_entry_t *entries;
+};
+
+/**
+ * Checks that an entry's data lies inside the mapping, including the rows of
+ * pixels that images are uploaded from.
+ */
+static bool pack_entry_valid(const pack_entry_t *entry, size_t map_size) {
+  if (entry->offset > map_size || entry->size > map_size - entry->offset) {
+    return false;
+  }
+  if (entry->type == PACK_IMAGE || entry->type == PACK_ATLAS_PAGE) {
+    return (uint64_t)entry->pitch * entry->height <= entry->size;
+  }
+  return true;
+}
+
+/**
+ * Checks a mapped pack's header, and that its index and every entry's data
+ * lie inside the mapping, so later reads need no checks.
+ */
+static bool pack_valid(const uint8_t *map, size_t map_size) {
+  const pack_header_t *header = (const pack_header_t *)map;
+  if (memcmp(header->magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 ||
+      header->version != PACK_VERSION ||
+      header->index_offset % PACK_ALIGNMENT != 0 ||
+      header->index_offset > map_size ||
+      header->num_entries >
+          (map_size - header->index_offset) / sizeof(pack_entry_t)) {
+    return false;
+  }
+  const pack_entry_t *entries =
+      (const pack_entry_t *)(map + header->index_offset);
+  for (uint32_t i = 0; i < header->num_entries; i++) {
+    if (!pack_entry_valid(&entries[i], map_size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+asset_pack_t *asset_pack_open(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return NULL;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(pack_header_t)) {
+    close(fd);
+    return NULL;
+  }
+  void *map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+  if (map == MAP_FAILED) {
+    return NULL;
+  }
+  const pack_header_t *header = map;
+  if (!pack_valid(map, info.st_size)) {
+    fprintf(stderr, "%s is not a valid asset pack\n", path);
+    munmap(map, info.st_size);
+    return NULL;
+  }
+  asset_pack_t *pack = malloc(sizeof(asset_pack_t));
+  assert(pack);
+  pack->map = map;
+  pack->map_size = info.st_size;
+  pack->header = header;
+  pack->entries = (const pack_entry_t *)(pack->map + header->index_offset);
+  return pack;
+}
+
+void asset_pack_close(asset_pack_t *pack) {
+  munmap((void *)pack->map, pack->map_size);
+  free(pack);
+}
+
+static int pack_entry_compare(const void *key, const void *entry) {
+  return strncmp(key, ((const pack_entry_t *)entry)->path, PACK_PATH_LEN);
+}
+
+const pack_entry_t *asset_pack_find(asset_pack_t *pack, const char *path) {
+  return bsearch(path, pack->entries, pack->header->num_entries,
+                 sizeof(pack_entry_t), pack_entry_compare);
+}
+
+const pack_entry_t *asset_pack_find_page(asset_pack_t *pack, uint32_t page) {
+  char path[PACK_PATH_LEN];
+  asset_pack_page_name(path, page);
+  return asset_pack_find(pack, path);
+}
+
+const void *asset_pack_data(asset_pack_t *pack, const pack_entry_t *entry) {
+  // asset_pack_open checked that every entry lies inside the mapping
+  return pack->map + entry->offset;
+}
+
+void asset_pack_page_name(char *path, uint32_t page) {
+  snprintf(path, PACK_PATH_LEN, "#page%u", page);
+}
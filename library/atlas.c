@@ -0,0 +1,37 @@
+#include "atlas.h"
+
+const int ATLAS_PADDING = 2;
+
+void atlas_shelf_init(atlas_shelf_t *shelf, int page_size) {
+  shelf->page_size = page_size;
+  shelf->pen_x = 0;
+  shelf->pen_y = 0;
+  shelf->shelf_height = 0;
+}
+
+bool atlas_shelf_place(atlas_shelf_t *shelf, int w, int h, SDL_Rect *out) {
+  if (w > shelf->page_size) {
+    return false;
+  }
+  int x = shelf->pen_x;
+  int y = shelf->pen_y;
+  int shelf_height = shelf->shelf_height;
+  if (x + w > shelf->page_size) {
+    // start a new shelf below the current one
+    x = 0;
+    y += shelf_height + ATLAS_PADDING;
+    shelf_height = 0;
+  }
+  if (y + h > shelf->page_size) {
+    return false;
+  }
+  *out = (SDL_Rect){.x = x, .y = y, .w = w, .h = h};
+  shelf->pen_x = x + w + ATLAS_PADDING;
+  shelf->pen_y = y;
+  shelf->shelf_height = h > shelf_height ? h : shelf_height;
+  return true;
+}
+
+int atlas_shelf_used_height(atlas_shelf_t *shelf) {
+  return shelf->pen_y + shelf->shelf_height;
+}
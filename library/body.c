@@ -4,6 +4,9 @@
 
 #include "body.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
 
 
 struct body {
@@ -69,6 +72,8 @@ list_t *body_get_shape(body_t *body) {
   return copy;
 }
 
+aabb_t body_get_aabb(body_t *body) { return polygon_get_bounds(body->poly); }
+
 vector_t body_get_centroid(body_t *body) {
   return polygon_get_center(body->poly);
 }
@@ -90,6 +95,10 @@ void body_set_centroid(body_t *body, vector_t x) {
   polygon_set_center(body->poly, x);
 }
 
+void body_set_shape(body_t *body, const vector_t *points, size_t num_points) {
+  polygon_set_points(body->poly, points, num_points);
+}
+
 void body_set_velocity(body_t *body, vector_t v) {
   polygon_set_velocity(body->poly, v);
 }
@@ -0,0 +1,70 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "camera.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
+struct camera {
+  vector_t size;
+  aabb_t view;
+  // the window size, in pixels, that the view is fit into
+  vector_t viewport;
+  // pixel = scale * world + offset, per axis; scale.y is negative because
+  // pixel y grows downwards
+  vector_t scale;
+  vector_t offset;
+};
+
+/**
+ * Recomputes the world to pixel transform. The view is scaled uniformly to
+ * fit the viewport and centered in it.
+ */
+static void camera_update_transform(camera_t *camera) {
+  double x_scale = camera->viewport.x / camera->size.x,
+         y_scale = camera->viewport.y / camera->size.y;
+  double scale = x_scale < y_scale ? x_scale : y_scale;
+  vector_t view_center =
+      vec_multiply(0.5, vec_add(camera->view.min, camera->view.max));
+  camera->scale = (vector_t){.x = scale, .y = -scale};
+  camera->offset =
+      (vector_t){.x = camera->viewport.x / 2 - scale * view_center.x,
+                 .y = camera->viewport.y / 2 + scale * view_center.y};
+}
+
+camera_t *camera_init(vector_t view_size) {
+  camera_t *camera = malloc(sizeof(camera_t));
+  assert(camera);
+  camera->size = view_size;
+  camera->viewport = view_size;
+  camera_move_to(camera, VEC_ZERO);
+  return camera;
+}
+
+void camera_move_to(camera_t *camera, vector_t origin) {
+  camera->view = (aabb_t){.min = origin,
+                          .max = vec_add(origin, camera->size)};
+  camera_update_transform(camera);
+}
+
+void camera_set_viewport(camera_t *camera, vector_t viewport) {
+  assert(viewport.x > 0 && viewport.y > 0);
+  camera->viewport = viewport;
+  camera_update_transform(camera);
+}
+
+vector_t camera_get_viewport(camera_t *camera) { return camera->viewport; }
+
+aabb_t camera_get_view(camera_t *camera) { return camera->view; }
+
+bool camera_can_see(camera_t *camera, aabb_t bounds) {
+  return aabb_overlaps(camera->view, bounds);
+}
+
+vector_t camera_to_pixel(camera_t *camera, vector_t world) {
+  return (vector_t){.x = camera->scale.x * world.x + camera->offset.x,
+                    .y = camera->scale.y * world.y + camera->offset.y};
+}
+
+void camera_free(camera_t *camera) { free(camera); }
@@ -1,11 +1,15 @@
 #include "collision.h"
 #include "body.h"
+#include "profile.h"
 
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
 /**
  * Returns a list of vectors representing the edges of a shape.
  *
@@ -97,6 +101,7 @@ static collision_info_t compare_collision(list_t *shape1, list_t *shape2,
 }
 
 collision_info_t find_collision(body_t *body1, body_t *body2) {
+  PROFILE_FUNCTION();
   list_t *shape1 = body_get_shape(body1);
   list_t *shape2 = body_get_shape(body2);
 
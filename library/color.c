@@ -5,6 +5,9 @@
 
 #include "color.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_RENDER);
+
 const double COLOR_MAX = 255; // max value of each rgb value
 const double WHITE_MIX = 1;
 
@@ -0,0 +1,293 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ecs.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
+const size_t ECS_INITIAL_ROWS = 8;
+const size_t ECS_INITIAL_TABLES = 8;
+const size_t ECS_INITIAL_ENTITIES = 64;
+// an entity handle is its slot in the low bits and the slot's generation in
+// the high bits, so a handle to a removed entity never matches a new one
+const uint32_t ECS_SLOT_BITS = 24;
+const uint32_t ECS_SLOT_MASK = (1u << 24) - 1;
+
+struct ecs_table {
+  component_mask_t mask;
+  size_t size;
+  size_t capacity;
+  ecs_entity_t *entities;
+  // one array per component, NULL for the components the table doesn't have
+  uint8_t *columns[ECS_MAX_COMPONENTS];
+};
+
+typedef struct entity_slot {
+  uint32_t generation;
+  bool alive;
+  ecs_table_t *table;
+  size_t row;
+} entity_slot_t;
+
+struct ecs {
+  ecs_component_info_t components[ECS_MAX_COMPONENTS];
+  size_t num_components;
+  list_t *tables;
+  entity_slot_t *slots;
+  size_t num_slots;
+  size_t slots_capacity;
+  // slots of removed entities, reused before new ones
+  uint32_t *free_slots;
+  size_t num_free_slots;
+};
+
+static void table_free(ecs_table_t *table) {
+  for (size_t i = 0; i < ECS_MAX_COMPONENTS; i++) {
+    free(table->columns[i]);
+  }
+  free(table->entities);
+  free(table);
+}
+
+ecs_t *ecs_init(const ecs_component_info_t *components,
+                size_t num_components) {
+  assert(num_components <= ECS_MAX_COMPONENTS);
+  for (size_t c = 0; c < num_components; c++) {
+    assert(components[c].size > 0);
+  }
+  ecs_t *ecs = malloc(sizeof(ecs_t));
+  assert(ecs);
+  memcpy(ecs->components, components,
+         sizeof(ecs_component_info_t) * num_components);
+  ecs->num_components = num_components;
+  ecs->tables = list_init(ECS_INITIAL_TABLES, (free_func_t)table_free);
+  ecs->slots_capacity = ECS_INITIAL_ENTITIES;
+  ecs->slots = malloc(sizeof(entity_slot_t) * ecs->slots_capacity);
+  ecs->free_slots = malloc(sizeof(uint32_t) * ecs->slots_capacity);
+  assert(ecs->slots && ecs->free_slots);
+  ecs->num_slots = 0;
+  ecs->num_free_slots = 0;
+  return ecs;
+}
+
+/**
+ * Calls the freers of the given components of one row.
+ */
+static void row_free(ecs_t *ecs, ecs_table_t *table, size_t row,
+                     component_mask_t mask) {
+  for (size_t c = 0; c < ecs->num_components; c++) {
+    if ((mask & COMPONENT_BIT(c)) && ecs->components[c].freer != NULL) {
+      ecs->components[c].freer(table->columns[c] +
+                               row * ecs->components[c].size);
+    }
+  }
+}
+
+void ecs_free(ecs_t *ecs) {
+  for (size_t i = 0; i < list_size(ecs->tables); i++) {
+    ecs_table_t *table = list_get(ecs->tables, i);
+    for (size_t row = 0; row < table->size; row++) {
+      row_free(ecs, table, row, table->mask);
+    }
+  }
+  list_free(ecs->tables);
+  free(ecs->slots);
+  free(ecs->free_slots);
+  free(ecs);
+}
+
+/**
+ * Finds the table of a set of components, creating it the first time.
+ */
+static ecs_table_t *table_for(ecs_t *ecs, component_mask_t mask) {
+  for (size_t i = 0; i < list_size(ecs->tables); i++) {
+    ecs_table_t *table = list_get(ecs->tables, i);
+    if (table->mask == mask) {
+      return table;
+    }
+  }
+  ecs_table_t *table = calloc(1, sizeof(ecs_table_t));
+  assert(table);
+  table->mask = mask;
+  table->capacity = ECS_INITIAL_ROWS;
+  table->entities = malloc(sizeof(ecs_entity_t) * table->capacity);
+  assert(table->entities);
+  for (size_t c = 0; c < ecs->num_components; c++) {
+    if (mask & COMPONENT_BIT(c)) {
+      table->columns[c] = malloc(ecs->components[c].size * table->capacity);
+      assert(table->columns[c]);
+    }
+  }
+  list_add(ecs->tables, table);
+  return table;
+}
+
+/**
+ * Appends a row of zeroed components to a table.
+ *
+ * @return the new row
+ */
+static size_t table_push(ecs_t *ecs, ecs_table_t *table,
+                         ecs_entity_t entity) {
+  if (table->size == table->capacity) {
+    table->capacity *= 2;
+    table->entities =
+        realloc(table->entities, sizeof(ecs_entity_t) * table->capacity);
+    assert(table->entities);
+    for (size_t c = 0; c < ecs->num_components; c++) {
+      if (table->columns[c] != NULL) {
+        table->columns[c] = realloc(table->columns[c],
+                                    ecs->components[c].size * table->capacity);
+        assert(table->columns[c]);
+      }
+    }
+  }
+  size_t row = table->size++;
+  table->entities[row] = entity;
+  for (size_t c = 0; c < ecs->num_components; c++) {
+    if (table->columns[c] != NULL) {
+      memset(table->columns[c] + row * ecs->components[c].size, 0,
+             ecs->components[c].size);
+    }
+  }
+  return row;
+}
+
+/**
+ * Moves the last row of a table into the given one, without freeing it.
+ */
+static void table_swap_remove(ecs_t *ecs, ecs_table_t *table, size_t row) {
+  size_t last = table->size - 1;
+  if (row != last) {
+    for (size_t c = 0; c < ecs->num_components; c++) {
+      if (table->columns[c] != NULL) {
+        size_t size = ecs->components[c].size;
+        memcpy(table->columns[c] + row * size, table->columns[c] + last * size,
+               size);
+      }
+    }
+    table->entities[row] = table->entities[last];
+    ecs->slots[table->entities[row] & ECS_SLOT_MASK].row = row;
+  }
+  table->size--;
+}
+
+static entity_slot_t *slot_of(ecs_t *ecs, ecs_entity_t entity) {
+  assert(ecs_is_alive(ecs, entity));
+  return &ecs->slots[entity & ECS_SLOT_MASK];
+}
+
+bool ecs_is_alive(ecs_t *ecs, ecs_entity_t entity) {
+  uint32_t index = entity & ECS_SLOT_MASK;
+  return index < ecs->num_slots && ecs->slots[index].alive &&
+         ecs->slots[index].generation == entity >> ECS_SLOT_BITS;
+}
+
+ecs_entity_t ecs_spawn(ecs_t *ecs, component_mask_t mask) {
+  uint32_t index;
+  if (ecs->num_free_slots > 0) {
+    index = ecs->free_slots[--ecs->num_free_slots];
+  } else {
+    if (ecs->num_slots == ecs->slots_capacity) {
+      ecs->slots_capacity *= 2;
+      ecs->slots =
+          realloc(ecs->slots, sizeof(entity_slot_t) * ecs->slots_capacity);
+      ecs->free_slots =
+          realloc(ecs->free_slots, sizeof(uint32_t) * ecs->slots_capacity);
+      assert(ecs->slots && ecs->free_slots);
+    }
+    assert(ecs->num_slots <= ECS_SLOT_MASK);
+    index = ecs->num_slots++;
+    ecs->slots[index].generation = 0;
+  }
+  entity_slot_t *slot = &ecs->slots[index];
+  ecs_entity_t entity = (slot->generation << ECS_SLOT_BITS) | index;
+  slot->alive = true;
+  slot->table = table_for(ecs, mask);
+  slot->row = table_push(ecs, slot->table, entity);
+  return entity;
+}
+
+void ecs_remove(ecs_t *ecs, ecs_entity_t entity) {
+  entity_slot_t *slot = slot_of(ecs, entity);
+  row_free(ecs, slot->table, slot->row, slot->table->mask);
+  table_swap_remove(ecs, slot->table, slot->row);
+  slot->alive = false;
+  slot->generation = (slot->generation + 1) & (UINT32_MAX >> ECS_SLOT_BITS);
+  ecs->free_slots[ecs->num_free_slots++] = entity & ECS_SLOT_MASK;
+}
+
+void *ecs_get(ecs_t *ecs, ecs_entity_t entity, size_t component) {
+  entity_slot_t *slot = slot_of(ecs, entity);
+  uint8_t *column = slot->table->columns[component];
+  if (column == NULL) {
+    return NULL;
+  }
+  return column + slot->row * ecs->components[component].size;
+}
+
+/**
+ * Moves an entity to the table of a new set of components, keeping the
+ * components both sets have.
+ */
+static void entity_move(ecs_t *ecs, ecs_entity_t entity,
+                        component_mask_t mask) {
+  entity_slot_t *slot = slot_of(ecs, entity);
+  ecs_table_t *from = slot->table;
+  size_t from_row = slot->row;
+  ecs_table_t *to = table_for(ecs, mask);
+  size_t to_row = table_push(ecs, to, entity);
+  for (size_t c = 0; c < ecs->num_components; c++) {
+    if (from->columns[c] != NULL && to->columns[c] != NULL) {
+      size_t size = ecs->components[c].size;
+      memcpy(to->columns[c] + to_row * size, from->columns[c] + from_row * size,
+             size);
+    }
+  }
+  table_swap_remove(ecs, from, from_row);
+  slot->table = to;
+  slot->row = to_row;
+}
+
+void *ecs_add_component(ecs_t *ecs, ecs_entity_t entity, size_t component) {
+  assert(component < ecs->num_components);
+  component_mask_t mask = slot_of(ecs, entity)->table->mask;
+  assert(!(mask & COMPONENT_BIT(component)));
+  entity_move(ecs, entity, mask | COMPONENT_BIT(component));
+  return ecs_get(ecs, entity, component);
+}
+
+void ecs_remove_component(ecs_t *ecs, ecs_entity_t entity, size_t component) {
+  entity_slot_t *slot = slot_of(ecs, entity);
+  component_mask_t mask = slot->table->mask;
+  assert(mask & COMPONENT_BIT(component));
+  row_free(ecs, slot->table, slot->row, COMPONENT_BIT(component));
+  entity_move(ecs, entity, mask & ~COMPONENT_BIT(component));
+}
+
+ecs_query_t ecs_query(ecs_t *ecs, component_mask_t mask) {
+  return (ecs_query_t){.ecs = ecs, .mask = mask, .next_table = 0};
+}
+
+ecs_table_t *ecs_query_next(ecs_query_t *query) {
+  while (query->next_table < list_size(query->ecs->tables)) {
+    ecs_table_t *table = list_get(query->ecs->tables, query->next_table++);
+    if ((table->mask & query->mask) == query->mask && table->size > 0) {
+      return table;
+    }
+  }
+  return NULL;
+}
+
+size_t ecs_table_size(ecs_table_t *table) { return table->size; }
+
+void *ecs_table_column(ecs_table_t *table, size_t component) {
+  assert(component < ECS_MAX_COMPONENTS && table->columns[component] != NULL);
+  return table->columns[component];
+}
+
+const ecs_entity_t *ecs_table_entities(ecs_table_t *table) {
+  return table->entities;
+}
@@ -11,7 +11,13 @@
 
 state_t *state;
 
-void loop() {
+/**
+ * Runs one frame, creating the state first if needed and freeing it once
+ * the window is closed or the game is over.
+ *
+ * @return whether the game is done
+ */
+bool loop_frame() {
   // If needed, generate a pointer to our initial state
   if (!state) {
     state = emscripten_init();
@@ -19,27 +25,37 @@ void loop() {
 
   bool game_over = emscripten_main(state);
 
-  if (sdl_is_done((void *)state)) { // Once our demo exits...
-    emscripten_free(state);         // Free any state variables we've been using
-#ifdef __EMSCRIPTEN__ // Clean up emscripten environment (if we're using it)
+  if (sdl_is_done((void *)state) || game_over) { // Once our demo exits...
+    emscripten_free(state); // Free any state variables we've been using
+    state = NULL;
+    return true;
+  }
+  return false;
+}
+
+#ifdef __EMSCRIPTEN__
+void loop() {
+  if (loop_frame()) {
+    // Clean up emscripten environment
     emscripten_cancel_main_loop();
     emscripten_force_exit(0);
+  }
+}
 #else
-    exit(0);
-#endif
-    return;
-  } else if (game_over) {
-    SDL_Quit();
+int game_thread(void *aux) {
+  // returning lets the main thread stop rendering and shut SDL down
+  while (!loop_frame()) {
   }
+  return 0;
 }
+#endif
 
 int main() {
 #ifdef __EMSCRIPTEN__
   // Set loop as the function emscripten calls to request a new frame
   emscripten_set_main_loop_arg(loop, NULL, 0, 1);
 #else
-  while (1) {
-    loop();
-  }
+  // the game runs on its own thread while this one renders
+  sdl_run_threaded(game_thread);
 #endif
 }
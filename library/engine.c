@@ -0,0 +1,95 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_mixer.h>
+#include <SDL2/SDL_ttf.h>
+
+#include "asset_cache.h"
+#include "engine.h"
+#include "sdl_wrapper.h"
+#include "text_cache.h"
+#include "voice.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
+// made by `make pack`
+const char *ENGINE_ASSET_PACK_PATH = "out/assets.pack";
+const int ENGINE_AUDIO_FREQUENCY = 48000;
+const int ENGINE_AUDIO_CHANNELS = 2;
+const int ENGINE_AUDIO_CHUNK_SIZE = 1024;
+
+struct engine {
+  bool headless;
+  // sdl_get_camera() for a windowed engine, owned by the engine otherwise
+  camera_t *camera;
+  // the performance counter when the last frame started, or 0 before the
+  // first; wall time, unlike clock(), which counts every thread's CPU time
+  Uint64 last_counter;
+  double fixed_dt;
+};
+
+engine_t *engine_init(vector_t min, vector_t max) {
+  engine_t *engine = malloc(sizeof(engine_t));
+  assert(engine);
+  asset_cache_init();
+  // optional: without a baked pack every asset is decoded from its file
+  asset_cache_mount_pack(ENGINE_ASSET_PACK_PATH);
+  // also starts SDL_ttf, on the render thread that quits it
+  sdl_init(min, max);
+  if (Mix_OpenAudio(ENGINE_AUDIO_FREQUENCY, MIX_DEFAULT_FORMAT,
+                    ENGINE_AUDIO_CHANNELS, ENGINE_AUDIO_CHUNK_SIZE) < 0) {
+    printf("SDL_mixer could not initialize! SDL_mixer Error: %s\n",
+           Mix_GetError());
+  }
+  voice_init();
+  engine->headless = false;
+  engine->camera = sdl_get_camera();
+  engine->last_counter = 0;
+  engine->fixed_dt = 0;
+  return engine;
+}
+
+engine_t *engine_init_headless(vector_t min, vector_t max, double fixed_dt) {
+  assert(min.x < max.x && min.y < max.y);
+  assert(fixed_dt > 0);
+  engine_t *engine = malloc(sizeof(engine_t));
+  assert(engine);
+  engine->headless = true;
+  engine->camera = camera_init(vec_subtract(max, min));
+  camera_move_to(engine->camera, min);
+  engine->last_counter = 0;
+  engine->fixed_dt = fixed_dt;
+  return engine;
+}
+
+void engine_free(engine_t *engine) {
+  if (engine->headless) {
+    camera_free(engine->camera);
+  } else {
+    text_cache_destroy();
+    // joins the loader threads and unmaps the pack; its sounds are freed
+    // before the audio device is closed
+    asset_cache_destroy();
+    Mix_CloseAudio();
+  }
+  free(engine);
+}
+
+bool engine_is_headless(engine_t *engine) { return engine->headless; }
+
+camera_t *engine_get_camera(engine_t *engine) { return engine->camera; }
+
+double engine_tick(engine_t *engine) {
+  if (engine->headless) {
+    return engine->fixed_dt;
+  }
+  Uint64 now = SDL_GetPerformanceCounter();
+  double difference = engine->last_counter
+                          ? (double)(now - engine->last_counter) /
+                                SDL_GetPerformanceFrequency()
+                          : 0.0;
+  engine->last_counter = now;
+  return difference;
+}
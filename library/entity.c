@@ -0,0 +1,32 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "entity.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
+static const uint32_t ENTITY_KIND_FLAGS[NUM_ENTITY_KINDS] = {
+    [ENTITY_PLAYER_1] = ENTITY_IS_PLAYER,
+    [ENTITY_PLAYER_2] = ENTITY_IS_PLAYER,
+    [ENTITY_INVADER] = 0,
+    [ENTITY_TILE] = ENTITY_IS_TILE,
+    [ENTITY_TILE_BREAK] = ENTITY_IS_TILE | ENTITY_BREAKS,
+    [ENTITY_TILE_SPRING] = ENTITY_IS_TILE,
+    [ENTITY_TILE_ROCKET] = ENTITY_IS_TILE | ENTITY_LAUNCHES,
+    [ENTITY_TILE_SHIELD] = ENTITY_IS_TILE | ENTITY_SHIELDS,
+    [ENTITY_TILE_MOVE] = ENTITY_IS_TILE | ENTITY_WRAPS};
+
+uint32_t entity_kind_flags(entity_kind_t kind) {
+  assert(kind < NUM_ENTITY_KINDS);
+  return ENTITY_KIND_FLAGS[kind];
+}
+
+body_info_t *body_info_init(entity_kind_t kind, size_t index) {
+  body_info_t *body_info = malloc(sizeof(body_info_t));
+  assert(body_info);
+  body_info->kind = kind;
+  body_info->flags = entity_kind_flags(kind);
+  body_info->index = index;
+  return body_info;
+}
@@ -0,0 +1,120 @@
+#include <assert.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "flow_field.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
+const size_t FLOW_NO_GOAL = SIZE_MAX;
+
+struct flow_field {
+  size_t cols;
+  size_t rows;
+  aabb_t area;
+  vector_t cell_size;
+  // per cell: the nearest goal and the unit vector toward it
+  size_t *goals;
+  vector_t *directions;
+  // the cells still to visit while building
+  size_t *queue;
+};
+
+flow_field_t *flow_field_init(size_t cols, size_t rows) {
+  assert(cols > 0 && rows > 0);
+  flow_field_t *field = malloc(sizeof(flow_field_t));
+  assert(field);
+  field->cols = cols;
+  field->rows = rows;
+  field->area = (aabb_t){.min = VEC_ZERO, .max = VEC_ZERO};
+  field->cell_size = VEC_ZERO;
+  size_t num_cells = cols * rows;
+  field->goals = malloc(sizeof(size_t) * num_cells);
+  field->directions = malloc(sizeof(vector_t) * num_cells);
+  field->queue = malloc(sizeof(size_t) * num_cells);
+  assert(field->goals && field->directions && field->queue);
+  return field;
+}
+
+void flow_field_free(flow_field_t *field) {
+  free(field->goals);
+  free(field->directions);
+  free(field->queue);
+  free(field);
+}
+
+/**
+ * Gets the cell a position falls in, clamped to the grid.
+ */
+static size_t flow_field_cell(flow_field_t *field, vector_t position) {
+  double col = floor((position.x - field->area.min.x) / field->cell_size.x);
+  double row = floor((position.y - field->area.min.y) / field->cell_size.y);
+  col = fmin(fmax(col, 0), field->cols - 1);
+  row = fmin(fmax(row, 0), field->rows - 1);
+  return (size_t)row * field->cols + (size_t)col;
+}
+
+void flow_field_build(flow_field_t *field, aabb_t area, const vector_t *goals,
+                      size_t num_goals) {
+  assert(num_goals > 0);
+  assert(area.max.x > area.min.x && area.max.y > area.min.y);
+  field->area = area;
+  field->cell_size = (vector_t){(area.max.x - area.min.x) / field->cols,
+                                (area.max.y - area.min.y) / field->rows};
+  size_t num_cells = field->cols * field->rows;
+  for (size_t c = 0; c < num_cells; c++) {
+    field->goals[c] = FLOW_NO_GOAL;
+  }
+
+  // breadth first from every goal at once, so each cell is labeled by the
+  // goal that reaches it first
+  size_t head = 0;
+  size_t tail = 0;
+  for (size_t g = 0; g < num_goals; g++) {
+    size_t cell = flow_field_cell(field, goals[g]);
+    if (field->goals[cell] == FLOW_NO_GOAL) {
+      field->goals[cell] = g;
+      field->queue[tail++] = cell;
+    }
+  }
+  while (head < tail) {
+    size_t cell = field->queue[head++];
+    long col = cell % field->cols;
+    long row = cell / field->cols;
+    for (long dy = -1; dy <= 1; dy++) {
+      for (long dx = -1; dx <= 1; dx++) {
+        long c = col + dx;
+        long r = row + dy;
+        if (c < 0 || r < 0 || c >= (long)field->cols ||
+            r >= (long)field->rows) {
+          continue;
+        }
+        size_t next = (size_t)r * field->cols + (size_t)c;
+        if (field->goals[next] == FLOW_NO_GOAL) {
+          field->goals[next] = field->goals[cell];
+          field->queue[tail++] = next;
+        }
+      }
+    }
+  }
+
+  for (size_t c = 0; c < num_cells; c++) {
+    vector_t center = {
+        area.min.x + (c % field->cols + 0.5) * field->cell_size.x,
+        area.min.y + (c / field->cols + 0.5) * field->cell_size.y};
+    vector_t to_goal = vec_subtract(goals[field->goals[c]], center);
+    double length = vec_get_length(to_goal);
+    field->directions[c] =
+        length > 0 ? vec_multiply(1 / length, to_goal) : VEC_ZERO;
+  }
+}
+
+vector_t flow_field_direction(flow_field_t *field, vector_t position) {
+  return field->directions[flow_field_cell(field, position)];
+}
+
+size_t flow_field_goal(flow_field_t *field, vector_t position) {
+  return field->goals[flow_field_cell(field, position)];
+}
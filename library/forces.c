@@ -5,7 +5,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
 const double MIN_DIST = 5;
+// the most row bodies one body can touch at once, and can land on per tick
+#define MAX_ROW_CONTACTS 8
+#define MAX_ROW_CANDIDATES 32
 
 typedef struct body_aux {
   double force_const;
@@ -20,6 +26,18 @@ typedef struct collision_aux {
   void *aux; // aux (if allocated in memory) should be free'd by the caller
 } collision_aux_t;
 
+typedef struct row_collision_aux {
+  // laid out like body_aux_t, which frees it
+  double force_const;
+  list_t *bodies;
+  row_index_t *index;
+  collision_handler_t handler;
+  void *aux;
+  // the row bodies touched last tick, which don't collide again until let go
+  body_t *contacts[MAX_ROW_CONTACTS];
+  size_t num_contacts;
+} row_collision_aux_t;
+
 body_aux_t *body_aux_init(double force_const, list_t *bodies) {
   body_aux_t *aux = malloc(sizeof(body_aux_t));
   assert(aux);
@@ -197,6 +215,75 @@ void create_collision(scene_t *scene, body_t *body1, body_t *body2,
                                  bodies);
 }
 
+/**
+ * The force creator for row collisions. Runs the narrowphase only on the
+ * bodies of the rows the falling body's box overlaps, and calls the handler
+ * for the ones it just started touching.
+ *
+ * @param row_aux the row collision aux
+ */
+static void row_collision_force_creator(void *row_aux) {
+  row_collision_aux_t *col_aux = row_aux;
+  body_t *body = list_get(col_aux->bodies, 0);
+  if (body_get_velocity(body).y >= 0) {
+    col_aux->num_contacts = 0;
+    return;
+  }
+
+  aabb_t bounds = body_get_aabb(body);
+  body_t *candidates[MAX_ROW_CANDIDATES];
+  size_t num_candidates =
+      row_index_query(col_aux->index, bounds.min.y, bounds.max.y, candidates,
+                      MAX_ROW_CANDIDATES);
+  body_t *contacts[MAX_ROW_CONTACTS];
+  size_t num_contacts = 0;
+  for (size_t i = 0; i < num_candidates && num_contacts < MAX_ROW_CONTACTS;
+       i++) {
+    body_t *other = candidates[i];
+    if (!aabb_overlaps(bounds, body_get_aabb(other))) {
+      continue;
+    }
+    collision_info_t info = find_collision(body, other);
+    if (!info.collided) {
+      continue;
+    }
+    contacts[num_contacts++] = other;
+    bool prev_collision = false;
+    for (size_t j = 0; j < col_aux->num_contacts; j++) {
+      prev_collision |= col_aux->contacts[j] == other;
+    }
+    if (!prev_collision) {
+      col_aux->handler(body, other, info.axis, col_aux->aux,
+                       col_aux->force_const);
+    }
+  }
+  for (size_t i = 0; i < num_contacts; i++) {
+    col_aux->contacts[i] = contacts[i];
+  }
+  col_aux->num_contacts = num_contacts;
+}
+
+void create_row_collision(scene_t *scene, body_t *body, row_index_t *index,
+                          collision_handler_t handler, void *aux,
+                          double force_const) {
+  list_t *bodies = list_init(1, NULL);
+  list_add(bodies, body);
+  list_t *aux_bodies = list_init(1, NULL);
+  list_add(aux_bodies, body);
+
+  row_collision_aux_t *row_aux = malloc(sizeof(row_collision_aux_t));
+  assert(row_aux);
+  row_aux->force_const = force_const;
+  row_aux->bodies = aux_bodies;
+  row_aux->index = index;
+  row_aux->handler = handler;
+  row_aux->aux = aux;
+  row_aux->num_contacts = 0;
+
+  scene_add_bodies_force_creator(scene, row_collision_force_creator, row_aux,
+                                 bodies);
+}
+
 /**
  * The collision handler for destructive collisions.
  */
@@ -0,0 +1,118 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "generator.h"
+#include "spsc_queue.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
+struct generator {
+  generator_func_t generate;
+  void *aux;
+  spsc_queue_t *queue;
+  // where the background thread makes each item before pushing it
+  void *scratch;
+  // NULL if items are made when asked for
+  SDL_Thread *thread;
+  // a side only locks to sleep, when the queue is full (the thread) or empty
+  // (the caller); they can't both be, so one condition serves both. `idle`
+  // tells the other side it has to take the lock to wake the sleeper. It is
+  // only touched through SDL_AtomicAdd, a full barrier, so a side can't miss
+  // the other going to sleep around its own push or pop.
+  SDL_mutex *lock;
+  SDL_cond *wake;
+  SDL_atomic_t idle;
+  SDL_atomic_t quit;
+};
+
+/**
+ * Wakes the other side if it is asleep, after this side pushed or popped.
+ */
+static void generator_wake(generator_t *gen) {
+  if (SDL_AtomicAdd(&gen->idle, 0) != 0) {
+    SDL_LockMutex(gen->lock);
+    SDL_CondSignal(gen->wake);
+    SDL_UnlockMutex(gen->lock);
+  }
+}
+
+static int generator_worker(void *aux) {
+  generator_t *gen = aux;
+  while (!SDL_AtomicGet(&gen->quit)) {
+    gen->generate(gen->aux, gen->scratch);
+    if (!spsc_queue_push(gen->queue, gen->scratch)) {
+      // full: sleep until the caller takes an item. `idle` is set before the
+      // retry, so a pop after it is sure to see it and signal.
+      SDL_LockMutex(gen->lock);
+      SDL_AtomicAdd(&gen->idle, 1);
+      while (!SDL_AtomicGet(&gen->quit) &&
+             !spsc_queue_push(gen->queue, gen->scratch)) {
+        SDL_CondWait(gen->wake, gen->lock);
+      }
+      SDL_AtomicAdd(&gen->idle, -1);
+      SDL_UnlockMutex(gen->lock);
+    }
+    generator_wake(gen);
+  }
+  return 0;
+}
+
+generator_t *generator_init(size_t item_size, size_t capacity,
+                            generator_func_t generate, void *aux) {
+  generator_t *gen = malloc(sizeof(generator_t));
+  assert(gen);
+  gen->generate = generate;
+  gen->aux = aux;
+  gen->queue = spsc_queue_init(item_size, capacity);
+  gen->scratch = malloc(item_size);
+  assert(gen->scratch);
+  SDL_AtomicSet(&gen->idle, 0);
+  SDL_AtomicSet(&gen->quit, 0);
+  gen->lock = SDL_CreateMutex();
+  gen->wake = SDL_CreateCond();
+  gen->thread = NULL;
+  if (gen->lock != NULL && gen->wake != NULL) {
+    gen->thread = SDL_CreateThread(generator_worker, "generator", gen);
+  }
+  return gen;
+}
+
+void generator_free(generator_t *gen) {
+  if (gen->thread != NULL) {
+    SDL_LockMutex(gen->lock);
+    SDL_AtomicSet(&gen->quit, 1);
+    SDL_CondSignal(gen->wake);
+    SDL_UnlockMutex(gen->lock);
+    SDL_WaitThread(gen->thread, NULL);
+  }
+  if (gen->lock != NULL) {
+    SDL_DestroyMutex(gen->lock);
+  }
+  if (gen->wake != NULL) {
+    SDL_DestroyCond(gen->wake);
+  }
+  spsc_queue_free(gen->queue);
+  free(gen->scratch);
+  free(gen);
+}
+
+void generator_next(generator_t *gen, void *item) {
+  if (gen->thread == NULL) {
+    gen->generate(gen->aux, item);
+    return;
+  }
+  if (!spsc_queue_pop(gen->queue, item)) {
+    // empty: sleep until the thread pushes an item
+    SDL_LockMutex(gen->lock);
+    SDL_AtomicAdd(&gen->idle, 1);
+    while (!spsc_queue_pop(gen->queue, item)) {
+      SDL_CondWait(gen->wake, gen->lock);
+    }
+    SDL_AtomicAdd(&gen->idle, -1);
+    SDL_UnlockMutex(gen->lock);
+  }
+  generator_wake(gen);
+}
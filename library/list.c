@@ -2,6 +2,9 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
 typedef struct list {
   void **data;
   size_t length;
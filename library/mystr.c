@@ -5,6 +5,9 @@
 #include "strarray.h"
 #include "mystr.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
 ssize_t mystr_indexof(const char *str, const char sep, size_t start)
 {
     int size = strlen(str);
@@ -5,14 +5,40 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
 typedef struct polygon {
   list_t *points;
   vector_t velocity;
   double rotation_speed;
   rgb_color_t *color;
   double angle;
+  // kept in sync with `points` by polygon_translate and polygon_rotate
+  aabb_t bounds;
 } polygon_t;
 
+bool aabb_overlaps(aabb_t a, aabb_t b) {
+  return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y &&
+         b.min.y <= a.max.y;
+}
+
+/**
+ * Recomputes the bounding box from the vertices.
+ */
+static void polygon_update_bounds(polygon_t *polygon) {
+  aabb_t bounds = {.min = {.x = INFINITY, .y = INFINITY},
+                   .max = {.x = -INFINITY, .y = -INFINITY}};
+  for (size_t i = 0; i < list_size(polygon->points); i++) {
+    vector_t *point = list_get(polygon->points, i);
+    bounds.min.x = fmin(bounds.min.x, point->x);
+    bounds.min.y = fmin(bounds.min.y, point->y);
+    bounds.max.x = fmax(bounds.max.x, point->x);
+    bounds.max.y = fmax(bounds.max.y, point->y);
+  }
+  polygon->bounds = bounds;
+}
+
 polygon_t *polygon_init(list_t *points, vector_t initial_velocity,
                         double rotation_speed, double red, double green,
                         double blue) {
@@ -23,6 +49,7 @@ polygon_t *polygon_init(list_t *points, vector_t initial_velocity,
   polygon->rotation_speed = rotation_speed;
   polygon->angle = 0.0;
   polygon->color = color_init(red, green, blue);
+  polygon_update_bounds(polygon);
   return polygon;
 }
 
@@ -109,9 +136,15 @@ void polygon_translate(polygon_t *polygon, vector_t translation) {
     point->x += translation.x;
     point->y += translation.y;
   }
+  polygon->bounds.min = vec_add(polygon->bounds.min, translation);
+  polygon->bounds.max = vec_add(polygon->bounds.max, translation);
 }
 
 void polygon_rotate(polygon_t *polygon, double angle, vector_t point) {
+  // polygon_move rotates every tick, usually by nothing
+  if (angle == 0) {
+    return;
+  }
   polygon_translate(polygon, vec_subtract(VEC_ZERO, point));
   for (size_t i = 0; i < list_size(polygon->points); i++) {
     // pointer to modify teh existing value
@@ -120,6 +153,7 @@ void polygon_rotate(polygon_t *polygon, double angle, vector_t point) {
     p->x = rot.x;
     p->y = rot.y;
   }
+  polygon_update_bounds(polygon);
   polygon_translate(polygon, vec_subtract(point, VEC_ZERO));
 }
 
@@ -135,6 +169,18 @@ void polygon_set_center(polygon_t *polygon, vector_t centroid) {
   ;
 }
 
+void polygon_set_points(polygon_t *polygon, const vector_t *points,
+                        size_t num_points) {
+  assert(num_points == list_size(polygon->points));
+  for (size_t i = 0; i < num_points; i++) {
+    *(vector_t *)list_get(polygon->points, i) = points[i];
+  }
+  polygon->angle = 0.0;
+  polygon_update_bounds(polygon);
+}
+
+aabb_t polygon_get_bounds(polygon_t *polygon) { return polygon->bounds; }
+
 vector_t polygon_get_center(polygon_t *polygon) {
   return polygon_centroid(polygon);
 }
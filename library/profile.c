@@ -0,0 +1,129 @@
+#include "profile.h"
+
+#ifdef PROFILE
+
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// zones each thread keeps, a power of two; older ones are overwritten
+#define PROFILE_RING_SIZE (1 << 16)
+const double PROFILE_US_PER_S = 1e6;
+
+typedef struct profile_event {
+  const char *name;
+  uint64_t start;
+  uint64_t end;
+} profile_event_t;
+
+/**
+ * The zones recorded by one thread. Only that thread writes them.
+ */
+typedef struct profile_ring {
+  SDL_threadID thread;
+  // how many zones were ever recorded; the last PROFILE_RING_SIZE of them
+  // are in events
+  SDL_atomic_t count;
+  profile_event_t events[PROFILE_RING_SIZE];
+  struct profile_ring *next;
+} profile_ring_t;
+
+/**
+ * Every thread's ring, pushed onto the front as threads record their first
+ * zone. Rings are never freed, since the trace may be written after their
+ * threads exit.
+ */
+static profile_ring_t *PROFILE_RINGS = NULL;
+static _Thread_local profile_ring_t *THREAD_RING = NULL;
+
+static profile_ring_t *profile_thread_ring(void) {
+  if (THREAD_RING == NULL) {
+    profile_ring_t *ring = malloc(sizeof(profile_ring_t));
+    assert(ring);
+    ring->thread = SDL_ThreadID();
+    SDL_AtomicSet(&ring->count, 0);
+    do {
+      ring->next = SDL_AtomicGetPtr((void **)&PROFILE_RINGS);
+    } while (!SDL_AtomicCASPtr((void **)&PROFILE_RINGS, ring->next, ring));
+    THREAD_RING = ring;
+  }
+  return THREAD_RING;
+}
+
+profile_zone_t profile_zone_begin(const char *name) {
+  return (profile_zone_t){.name = name, .start = SDL_GetPerformanceCounter()};
+}
+
+void profile_zone_end(profile_zone_t *zone) {
+  uint64_t end = SDL_GetPerformanceCounter();
+  profile_ring_t *ring = profile_thread_ring();
+  unsigned count = SDL_AtomicGet(&ring->count);
+  ring->events[count % PROFILE_RING_SIZE] =
+      (profile_event_t){.name = zone->name, .start = zone->start, .end = end};
+  // the zone must be written before a writer of the trace can see it
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&ring->count, count + 1);
+}
+
+/**
+ * Writes the zones of a ring, leaving out any that were overwritten while
+ * they were copied.
+ *
+ * @param copy room for PROFILE_RING_SIZE zones
+ * @param first whether no zone was written yet
+ * @return whether no zone was written yet, including this ring's
+ */
+static bool profile_write_ring(FILE *file, profile_ring_t *ring,
+                               profile_event_t *copy, double us_per_tick,
+                               bool first) {
+  unsigned end = SDL_AtomicGet(&ring->count);
+  SDL_MemoryBarrierAcquire();
+  unsigned start = end > PROFILE_RING_SIZE ? end - PROFILE_RING_SIZE : 0;
+  for (unsigned i = start; i != end; i++) {
+    copy[i % PROFILE_RING_SIZE] = ring->events[i % PROFILE_RING_SIZE];
+  }
+  // zones the thread recorded while copying may have overwritten the
+  // oldest ones copied, and it may be writing zone `now` into the slot of
+  // zone `now - PROFILE_RING_SIZE` already
+  SDL_MemoryBarrierAcquire();
+  unsigned now = SDL_AtomicGet(&ring->count);
+  unsigned lost = now - start >= PROFILE_RING_SIZE
+                      ? now - start - PROFILE_RING_SIZE + 1
+                      : 0;
+  if (lost >= end - start) {
+    return first;
+  }
+  for (unsigned i = start + lost; i != end; i++) {
+    profile_event_t *event = &copy[i % PROFILE_RING_SIZE];
+    fprintf(file,
+            "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%lu,"
+            "\"ts\":%.3f,\"dur\":%.3f}",
+            first ? "" : ",", event->name, (unsigned long)ring->thread,
+            event->start * us_per_tick,
+            (event->end - event->start) * us_per_tick);
+    first = false;
+  }
+  return first;
+}
+
+bool profile_write(const char *path) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return false;
+  }
+  profile_event_t *copy = malloc(sizeof(profile_event_t) * PROFILE_RING_SIZE);
+  assert(copy);
+  double us_per_tick = PROFILE_US_PER_S / SDL_GetPerformanceFrequency();
+  fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool first = true;
+  for (profile_ring_t *ring = SDL_AtomicGetPtr((void **)&PROFILE_RINGS);
+       ring != NULL; ring = ring->next) {
+    first = profile_write_ring(file, ring, copy, us_per_tick, first);
+  }
+  fprintf(file, "\n]}\n");
+  free(copy);
+  return fclose(file) == 0;
+}
+
+#endif // #ifdef PROFILE
@@ -0,0 +1,119 @@
+#include <assert.h>
+#include <stdlib.h>
+
+#include "projectile_pool.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
+struct projectile_pool {
+  size_t size;
+  size_t capacity;
+  double radius;
+  double *x;
+  double *y;
+  double *vx;
+  double *vy;
+  uint32_t *targets;
+};
+
+projectile_pool_t *projectile_pool_init(size_t capacity, double radius) {
+  assert(capacity > 0 && radius > 0);
+  projectile_pool_t *pool = malloc(sizeof(projectile_pool_t));
+  assert(pool);
+  pool->size = 0;
+  pool->capacity = capacity;
+  pool->radius = radius;
+  pool->x = malloc(sizeof(double) * capacity);
+  pool->y = malloc(sizeof(double) * capacity);
+  pool->vx = malloc(sizeof(double) * capacity);
+  pool->vy = malloc(sizeof(double) * capacity);
+  pool->targets = malloc(sizeof(uint32_t) * capacity);
+  assert(pool->x && pool->y && pool->vx && pool->vy && pool->targets);
+  return pool;
+}
+
+void projectile_pool_free(projectile_pool_t *pool) {
+  free(pool->x);
+  free(pool->y);
+  free(pool->vx);
+  free(pool->vy);
+  free(pool->targets);
+  free(pool);
+}
+
+bool projectile_pool_fire(projectile_pool_t *pool, vector_t position,
+                          vector_t velocity, uint32_t targets) {
+  if (pool->size == pool->capacity) {
+    return false;
+  }
+  size_t i = pool->size++;
+  pool->x[i] = position.x;
+  pool->y[i] = position.y;
+  pool->vx[i] = velocity.x;
+  pool->vy[i] = velocity.y;
+  pool->targets[i] = targets;
+  return true;
+}
+
+void projectile_pool_tick(projectile_pool_t *pool, double dt) {
+  size_t size = pool->size;
+  for (size_t i = 0; i < size; i++) {
+    pool->x[i] += pool->vx[i] * dt;
+  }
+  for (size_t i = 0; i < size; i++) {
+    pool->y[i] += pool->vy[i] * dt;
+  }
+}
+
+/**
+ * Moves the last projectile into slot i.
+ */
+static void projectile_pool_swap_remove(projectile_pool_t *pool, size_t i) {
+  size_t last = --pool->size;
+  pool->x[i] = pool->x[last];
+  pool->y[i] = pool->y[last];
+  pool->vx[i] = pool->vx[last];
+  pool->vy[i] = pool->vy[last];
+  pool->targets[i] = pool->targets[last];
+}
+
+size_t projectile_pool_hit(projectile_pool_t *pool, vector_t center,
+                           double radius, uint32_t target) {
+  double reach = radius + pool->radius;
+  double reach_squared = reach * reach;
+  size_t hits = 0;
+  // from the last projectile down, so the one moved into a slot was tested
+  for (size_t i = pool->size; i-- > 0;) {
+    double dx = pool->x[i] - center.x;
+    double dy = pool->y[i] - center.y;
+    if ((pool->targets[i] & target) && dx * dx + dy * dy <= reach_squared) {
+      projectile_pool_swap_remove(pool, i);
+      hits++;
+    }
+  }
+  return hits;
+}
+
+size_t projectile_pool_cull_below(projectile_pool_t *pool, double min_y) {
+  double top_below = min_y - pool->radius;
+  size_t culled = 0;
+  for (size_t i = pool->size; i-- > 0;) {
+    if (pool->y[i] < top_below) {
+      projectile_pool_swap_remove(pool, i);
+      culled++;
+    }
+  }
+  return culled;
+}
+
+void projectile_pool_clear(projectile_pool_t *pool) { pool->size = 0; }
+
+size_t projectile_pool_size(projectile_pool_t *pool) { return pool->size; }
+
+aabb_t projectile_pool_get_bounds(projectile_pool_t *pool, size_t i) {
+  assert(i < pool->size);
+  double r = pool->radius;
+  return (aabb_t){.min = {pool->x[i] - r, pool->y[i] - r},
+                  .max = {pool->x[i] + r, pool->y[i] + r}};
+}
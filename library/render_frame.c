@@ -0,0 +1,321 @@
+#include <SDL2/SDL2_gfxPrimitives.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "profile.h"
+#include "render_frame.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_RENDER);
+
+const size_t INITIAL_BUFFER_CAPACITY = 64;
+#define VERTICES_PER_QUAD 4
+#define INDICES_PER_QUAD 6
+// the two triangles of a quad, as offsets into its four vertices
+const int QUAD_INDICES[INDICES_PER_QUAD] = {0, 1, 2, 2, 3, 0};
+
+/**
+ * A textured quad waiting in the frame until it is drawn.
+ */
+typedef struct queued_sprite {
+  SDL_Texture *texture;
+  render_layer_t layer;
+  // queue position, which keeps sprites of one run in submission order
+  size_t seq;
+  // whether to draw the whole texture instead of `src`
+  bool whole_texture;
+  SDL_Rect src;
+  SDL_FRect dest;
+  SDL_Color color;
+} queued_sprite_t;
+
+/**
+ * The polygons queued in one layer, already converted to colored triangles.
+ */
+typedef struct polygon_batch {
+  SDL_Vertex *vertices;
+  size_t num_vertices;
+  size_t vertex_capacity;
+  int *indices;
+  size_t num_indices;
+  size_t index_capacity;
+} polygon_batch_t;
+
+struct render_frame {
+  queued_sprite_t *sprites;
+  size_t num_sprites;
+  size_t sprite_capacity;
+  polygon_batch_t polygon_batches[NUM_RENDER_LAYERS];
+  bool has_boundary;
+  SDL_Rect boundary;
+  SDL_Texture **dead_textures;
+  size_t num_dead_textures;
+  size_t dead_texture_capacity;
+};
+
+/**
+ * The triangle fan of the largest polygon added so far, as triples of vertex
+ * offsets. The fan of a smaller polygon is a prefix of it. Only touched by
+ * the thread filling frames.
+ */
+static int *FAN = NULL;
+static size_t FAN_TRIANGLES = 0;
+/**
+ * The vertices and indices of the sprite run being drawn. Only touched by
+ * the thread drawing frames.
+ */
+static SDL_Vertex *QUAD_VERTICES = NULL;
+static size_t QUAD_VERTEX_CAPACITY = 0;
+static int *QUAD_INDEX_BUFFER = NULL;
+static size_t QUAD_CAPACITY = 0;
+
+/**
+ * Grows a buffer so it holds at least `needed` elements. The capacity only
+ * ever doubles, so a frame allocates nothing once warmed up.
+ *
+ * @return the buffer, which may have moved
+ */
+static void *buffer_reserve(void *buffer, size_t *capacity, size_t needed,
+                            size_t elem_size) {
+  if (needed <= *capacity) {
+    return buffer;
+  }
+  size_t new_capacity = *capacity == 0 ? INITIAL_BUFFER_CAPACITY : *capacity;
+  while (new_capacity < needed) {
+    new_capacity *= 2;
+  }
+  buffer = realloc(buffer, elem_size * new_capacity);
+  assert(buffer != NULL);
+  *capacity = new_capacity;
+  return buffer;
+}
+
+render_frame_t *render_frame_init(void) {
+  render_frame_t *frame = calloc(1, sizeof(render_frame_t));
+  assert(frame);
+  return frame;
+}
+
+void render_frame_reset(render_frame_t *frame) {
+  frame->num_sprites = 0;
+  for (render_layer_t layer = 0; layer < NUM_RENDER_LAYERS; layer++) {
+    frame->polygon_batches[layer].num_vertices = 0;
+    frame->polygon_batches[layer].num_indices = 0;
+  }
+  frame->has_boundary = false;
+}
+
+void render_frame_add_sprite(render_frame_t *frame, SDL_Texture *texture,
+                             render_layer_t layer, const SDL_Rect *clip,
+                             SDL_FRect dest, SDL_Color color) {
+  if (texture == NULL) {
+    return;
+  }
+  frame->sprites =
+      buffer_reserve(frame->sprites, &frame->sprite_capacity,
+                     frame->num_sprites + 1, sizeof(queued_sprite_t));
+  queued_sprite_t *sprite = &frame->sprites[frame->num_sprites];
+  sprite->texture = texture;
+  sprite->layer = layer;
+  sprite->seq = frame->num_sprites;
+  sprite->whole_texture = clip == NULL;
+  sprite->src = clip == NULL ? (SDL_Rect){0, 0, 0, 0} : *clip;
+  sprite->dest = dest;
+  sprite->color = color;
+  frame->num_sprites++;
+}
+
+/**
+ * Gets the triangle fan of a convex polygon with n vertices: the triangles
+ * (0, i, i + 1) for i from 1 to n - 2, as vertex offsets.
+ */
+static const int *polygon_fan(size_t n) {
+  size_t old_triangles = FAN_TRIANGLES;
+  FAN = buffer_reserve(FAN, &FAN_TRIANGLES, n - 2, sizeof(int) * 3);
+  for (size_t i = old_triangles; i < FAN_TRIANGLES; i++) {
+    FAN[i * 3] = 0;
+    FAN[i * 3 + 1] = i + 1;
+    FAN[i * 3 + 2] = i + 2;
+  }
+  return FAN;
+}
+
+SDL_Vertex *render_frame_add_polygon(render_frame_t *frame,
+                                     render_layer_t layer,
+                                     size_t num_vertices) {
+  assert(num_vertices >= 3);
+  polygon_batch_t *batch = &frame->polygon_batches[layer];
+  size_t num_indices = (num_vertices - 2) * 3;
+  batch->vertices =
+      buffer_reserve(batch->vertices, &batch->vertex_capacity,
+                     batch->num_vertices + num_vertices, sizeof(SDL_Vertex));
+  batch->indices = buffer_reserve(batch->indices, &batch->index_capacity,
+                                  batch->num_indices + num_indices,
+                                  sizeof(int));
+  const int *offsets = polygon_fan(num_vertices);
+  int *index = &batch->indices[batch->num_indices];
+  for (size_t i = 0; i < num_indices; i++) {
+    index[i] = batch->num_vertices + offsets[i];
+  }
+  SDL_Vertex *vertices = &batch->vertices[batch->num_vertices];
+  batch->num_vertices += num_vertices;
+  batch->num_indices += num_indices;
+  return vertices;
+}
+
+void render_frame_set_boundary(render_frame_t *frame, SDL_Rect boundary) {
+  frame->has_boundary = true;
+  frame->boundary = boundary;
+}
+
+void render_frame_destroy_texture(render_frame_t *frame,
+                                  SDL_Texture *texture) {
+  frame->dead_textures = buffer_reserve(
+      frame->dead_textures, &frame->dead_texture_capacity,
+      frame->num_dead_textures + 1, sizeof(SDL_Texture *));
+  frame->dead_textures[frame->num_dead_textures] = texture;
+  frame->num_dead_textures++;
+}
+
+static int sprite_compare(const void *a, const void *b) {
+  const queued_sprite_t *sprite_a = a, *sprite_b = b;
+  if (sprite_a->layer != sprite_b->layer) {
+    return sprite_a->layer < sprite_b->layer ? -1 : 1;
+  }
+  if (sprite_a->texture != sprite_b->texture) {
+    return (uintptr_t)sprite_a->texture < (uintptr_t)sprite_b->texture ? -1 : 1;
+  }
+  return sprite_a->seq < sprite_b->seq ? -1 : sprite_a->seq > sprite_b->seq;
+}
+
+/**
+ * Grows the quad buffers to hold `num_quads` quads. The index pattern only
+ * depends on the quad number, so it is written once per grown slot.
+ */
+static void quad_buffers_reserve(size_t num_quads) {
+  QUAD_VERTICES =
+      buffer_reserve(QUAD_VERTICES, &QUAD_VERTEX_CAPACITY, num_quads,
+                     sizeof(SDL_Vertex) * VERTICES_PER_QUAD);
+  size_t old_capacity = QUAD_CAPACITY;
+  QUAD_INDEX_BUFFER = buffer_reserve(QUAD_INDEX_BUFFER, &QUAD_CAPACITY,
+                                     num_quads, sizeof(int) * INDICES_PER_QUAD);
+  for (size_t i = old_capacity; i < QUAD_CAPACITY; i++) {
+    for (size_t j = 0; j < INDICES_PER_QUAD; j++) {
+      QUAD_INDEX_BUFFER[i * INDICES_PER_QUAD + j] =
+          i * VERTICES_PER_QUAD + QUAD_INDICES[j];
+    }
+  }
+}
+
+/**
+ * Draws the sprites in [start, end), which all share a texture and a layer,
+ * with one SDL_RenderGeometry call.
+ */
+static void sprite_run_draw(render_frame_t *frame, SDL_Renderer *renderer,
+                            size_t start, size_t end) {
+  SDL_Texture *texture = frame->sprites[start].texture;
+  int tex_w, tex_h;
+  if (SDL_QueryTexture(texture, NULL, NULL, &tex_w, &tex_h) != 0) {
+    return;
+  }
+  int num_quads = end - start;
+  quad_buffers_reserve(num_quads);
+  SDL_Vertex *vertex = QUAD_VERTICES;
+  for (size_t i = start; i < end; i++) {
+    queued_sprite_t *sprite = &frame->sprites[i];
+    SDL_Rect src = sprite->whole_texture ? (SDL_Rect){0, 0, tex_w, tex_h}
+                                         : sprite->src;
+    float u0 = (float)src.x / tex_w, v0 = (float)src.y / tex_h;
+    float u1 = (float)(src.x + src.w) / tex_w,
+          v1 = (float)(src.y + src.h) / tex_h;
+    float x0 = sprite->dest.x, y0 = sprite->dest.y;
+    float x1 = x0 + sprite->dest.w, y1 = y0 + sprite->dest.h;
+    // top left, top right, bottom right, bottom left
+    *vertex++ = (SDL_Vertex){{x0, y0}, sprite->color, {u0, v0}};
+    *vertex++ = (SDL_Vertex){{x1, y0}, sprite->color, {u1, v0}};
+    *vertex++ = (SDL_Vertex){{x1, y1}, sprite->color, {u1, v1}};
+    *vertex++ = (SDL_Vertex){{x0, y1}, sprite->color, {u0, v1}};
+  }
+  if (SDL_RenderGeometry(renderer, texture, QUAD_VERTICES,
+                         num_quads * VERTICES_PER_QUAD, QUAD_INDEX_BUFFER,
+                         num_quads * INDICES_PER_QUAD) == 0) {
+    return;
+  }
+  // renderers without geometry support draw the run one quad at a time
+  for (size_t i = start; i < end; i++) {
+    queued_sprite_t *sprite = &frame->sprites[i];
+    SDL_SetTextureColorMod(texture, sprite->color.r, sprite->color.g,
+                           sprite->color.b);
+    SDL_SetTextureAlphaMod(texture, sprite->color.a);
+    SDL_RenderCopyF(renderer, texture,
+                    sprite->whole_texture ? NULL : &sprite->src,
+                    &sprite->dest);
+  }
+  SDL_SetTextureColorMod(texture, UINT8_MAX, UINT8_MAX, UINT8_MAX);
+  SDL_SetTextureAlphaMod(texture, UINT8_MAX);
+}
+
+/**
+ * Draws a layer's polygons with one SDL_RenderGeometry call.
+ */
+static void polygon_batch_draw(polygon_batch_t *batch,
+                               SDL_Renderer *renderer) {
+  if (batch->num_indices == 0) {
+    return;
+  }
+  if (SDL_RenderGeometry(renderer, NULL, batch->vertices, batch->num_vertices,
+                         batch->indices, batch->num_indices) == 0) {
+    return;
+  }
+  // renderers without geometry support fill one triangle at a time
+  for (size_t i = 0; i < batch->num_indices; i += 3) {
+    SDL_Vertex *a = &batch->vertices[batch->indices[i]],
+               *b = &batch->vertices[batch->indices[i + 1]],
+               *c = &batch->vertices[batch->indices[i + 2]];
+    filledTrigonRGBA(renderer, a->position.x, a->position.y, b->position.x,
+                     b->position.y, c->position.x, c->position.y, a->color.r,
+                     a->color.g, a->color.b, a->color.a);
+  }
+}
+
+void render_frame_draw(render_frame_t *frame, SDL_Renderer *renderer) {
+  PROFILE_FUNCTION();
+  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+  SDL_RenderClear(renderer);
+  qsort(frame->sprites, frame->num_sprites, sizeof(queued_sprite_t),
+        sprite_compare);
+  size_t start = 0;
+  for (render_layer_t layer = 0; layer < NUM_RENDER_LAYERS; layer++) {
+    polygon_batch_draw(&frame->polygon_batches[layer], renderer);
+    while (start < frame->num_sprites &&
+           frame->sprites[start].layer == layer) {
+      size_t end = start + 1;
+      while (end < frame->num_sprites && frame->sprites[end].layer == layer &&
+             frame->sprites[end].texture == frame->sprites[start].texture) {
+        end++;
+      }
+      sprite_run_draw(frame, renderer, start, end);
+      start = end;
+    }
+  }
+  if (frame->has_boundary) {
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
+    SDL_RenderDrawRect(renderer, &frame->boundary);
+  }
+
+  for (size_t i = 0; i < frame->num_dead_textures; i++) {
+    SDL_DestroyTexture(frame->dead_textures[i]);
+  }
+  frame->num_dead_textures = 0;
+}
+
+void render_frame_free(render_frame_t *frame) {
+  free(frame->sprites);
+  for (render_layer_t layer = 0; layer < NUM_RENDER_LAYERS; layer++) {
+    free(frame->polygon_batches[layer].vertices);
+    free(frame->polygon_batches[layer].indices);
+  }
+  free(frame->dead_textures);
+  free(frame);
+}
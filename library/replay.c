@@ -0,0 +1,128 @@
+#include <assert.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "replay.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_GAME);
+
+// the longest word at the start of a replay line
+#define REPLAY_WORD_SIZE 8
+const size_t REPLAY_INITIAL_EVENTS = 64;
+
+struct replay_writer {
+  FILE *file;
+};
+
+struct replay {
+  uint64_t seed;
+  list_t *events;
+};
+
+replay_writer_t *replay_writer_init(const char *path, uint64_t seed) {
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    return NULL;
+  }
+  replay_writer_t *writer = malloc(sizeof(replay_writer_t));
+  assert(writer);
+  writer->file = file;
+  fprintf(file, "seed %" PRIu64 "\n", seed);
+  return writer;
+}
+
+void replay_writer_add(replay_writer_t *writer, replay_event_t event) {
+  if (event.type == REPLAY_START) {
+    fprintf(writer->file, "start %zu %d\n", event.tick, event.two_players);
+  } else {
+    fprintf(writer->file, "key %zu %d %d %.6f\n", event.tick, event.key,
+            event.key_type, event.held_time);
+  }
+}
+
+void replay_writer_free(replay_writer_t *writer) {
+  fclose(writer->file);
+  free(writer);
+}
+
+/**
+ * Reads the rest of an event's line, after its first word.
+ *
+ * @return whether the line was a valid event
+ */
+static bool replay_read_event(FILE *file, const char *word,
+                              replay_event_t *event) {
+  if (strcmp(word, "start") == 0) {
+    int two_players;
+    if (fscanf(file, "%zu %d", &event->tick, &two_players) != 2) {
+      return false;
+    }
+    event->type = REPLAY_START;
+    event->two_players = two_players != 0;
+    return true;
+  }
+  if (strcmp(word, "key") == 0) {
+    int key;
+    int key_type;
+    if (fscanf(file, "%zu %d %d %lf", &event->tick, &key, &key_type,
+               &event->held_time) != 4 ||
+        (key_type != KEY_PRESSED && key_type != KEY_RELEASED)) {
+      return false;
+    }
+    event->type = REPLAY_KEY;
+    event->key = key;
+    event->key_type = key_type;
+    return true;
+  }
+  return false;
+}
+
+replay_t *replay_load(const char *path) {
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    return NULL;
+  }
+  replay_t *replay = malloc(sizeof(replay_t));
+  assert(replay);
+  replay->events = list_init(REPLAY_INITIAL_EVENTS, free);
+  char word[REPLAY_WORD_SIZE];
+  bool valid = fscanf(file, "seed %" SCNu64, &replay->seed) == 1;
+  size_t last_tick = 0;
+  while (valid && fscanf(file, "%7s", word) == 1) {
+    replay_event_t *event = malloc(sizeof(replay_event_t));
+    assert(event);
+    *event = (replay_event_t){0};
+    valid = replay_read_event(file, word, event) && event->tick >= last_tick;
+    if (!valid) {
+      free(event);
+      break;
+    }
+    last_tick = event->tick;
+    list_add(replay->events, event);
+  }
+  fclose(file);
+  if (!valid) {
+    replay_free(replay);
+    return NULL;
+  }
+  return replay;
+}
+
+void replay_free(replay_t *replay) {
+  list_free(replay->events);
+  free(replay);
+}
+
+uint64_t replay_get_seed(replay_t *replay) { return replay->seed; }
+
+size_t replay_num_events(replay_t *replay) {
+  return list_size(replay->events);
+}
+
+const replay_event_t *replay_get_event(replay_t *replay, size_t index) {
+  return list_get(replay->events, index);
+}
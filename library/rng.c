@@ -0,0 +1,42 @@
+#include <assert.h>
+
+#include "rng.h"
+
+const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+// 2^-32, to map a 32-bit number into [0, 1)
+const double RNG_DOUBLE_SCALE = 1.0 / 4294967296.0;
+
+void rng_seed(rng_t *rng, uint64_t seed, uint64_t stream) {
+  rng->state = 0;
+  rng->inc = (stream << 1) | 1;
+  rng_next(rng);
+  rng->state += seed;
+  rng_next(rng);
+}
+
+uint32_t rng_next(rng_t *rng) {
+  uint64_t old = rng->state;
+  rng->state = old * PCG_MULTIPLIER + rng->inc;
+  // xorshift the high bits down, then rotate by the top 5 bits
+  uint32_t shifted = ((old >> 18) ^ old) >> 27;
+  uint32_t rotation = old >> 59;
+  return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+}
+
+uint32_t rng_below(rng_t *rng, uint32_t bound) {
+  assert(bound > 0);
+  // multiply-shift maps the number onto [0, bound); retrying the few values
+  // that would land unevenly removes the bias
+  uint64_t product = (uint64_t)rng_next(rng) * bound;
+  uint32_t low = product;
+  if (low < bound) {
+    uint32_t threshold = -bound % bound;
+    while (low < threshold) {
+      product = (uint64_t)rng_next(rng) * bound;
+      low = product;
+    }
+  }
+  return product >> 32;
+}
+
+double rng_double(rng_t *rng) { return rng_next(rng) * RNG_DOUBLE_SCALE; }
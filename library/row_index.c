@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
+
+#include "row_index.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
+const size_t ROW_INDEX_NUM_BUCKETS = 64;
+const size_t ROW_INDEX_INITIAL_ENTRIES = 8;
+
+typedef struct row_entry {
+  body_t *body;
+  double height;
+} row_entry_t;
+
+typedef struct row_bucket {
+  row_entry_t *entries;
+  size_t size;
+  size_t capacity;
+} row_bucket_t;
+
+struct row_index {
+  double bucket_height;
+  double reach;
+  row_bucket_t *buckets;
+};
+
+row_index_t *row_index_init(double bucket_height, double reach) {
+  assert(bucket_height > 0 && reach >= 0);
+  row_index_t *index = malloc(sizeof(row_index_t));
+  assert(index);
+  index->bucket_height = bucket_height;
+  index->reach = reach;
+  index->buckets = calloc(ROW_INDEX_NUM_BUCKETS, sizeof(row_bucket_t));
+  assert(index->buckets);
+  return index;
+}
+
+void row_index_free(row_index_t *index) {
+  for (size_t i = 0; i < ROW_INDEX_NUM_BUCKETS; i++) {
+    free(index->buckets[i].entries);
+  }
+  free(index->buckets);
+  free(index);
+}
+
+/**
+ * Gets the number of the bucket a height falls in, counting from 0 at
+ * height 0; negative below it.
+ */
+static long row_index_key(row_index_t *index, double height) {
+  return (long)floor(height / index->bucket_height);
+}
+
+static row_bucket_t *row_index_bucket(row_index_t *index, long key) {
+  long n = (long)ROW_INDEX_NUM_BUCKETS;
+  return &index->buckets[((key % n) + n) % n];
+}
+
+void row_index_add(row_index_t *index, body_t *body, double height) {
+  row_bucket_t *bucket =
+      row_index_bucket(index, row_index_key(index, height));
+  if (bucket->size == bucket->capacity) {
+    bucket->capacity = bucket->capacity == 0 ? ROW_INDEX_INITIAL_ENTRIES
+                                             : bucket->capacity * 2;
+    bucket->entries =
+        realloc(bucket->entries, sizeof(row_entry_t) * bucket->capacity);
+    assert(bucket->entries);
+  }
+  bucket->entries[bucket->size++] = (row_entry_t){body, height};
+}
+
+void row_index_remove(row_index_t *index, body_t *body, double height) {
+  row_bucket_t *bucket =
+      row_index_bucket(index, row_index_key(index, height));
+  for (size_t i = 0; i < bucket->size; i++) {
+    if (bucket->entries[i].body == body) {
+      bucket->entries[i] = bucket->entries[--bucket->size];
+      return;
+    }
+  }
+  assert(false && "body is not in the index");
+}
+
+size_t row_index_query(row_index_t *index, double min_y, double max_y,
+                       body_t **bodies, size_t max_bodies) {
+  double low = min_y - index->reach;
+  double high = max_y + index->reach;
+  long min_key = row_index_key(index, low);
+  long max_key = row_index_key(index, high);
+  // a range longer than the ring visits each bucket once
+  long num_keys = max_key - min_key + 1;
+  if (num_keys > (long)ROW_INDEX_NUM_BUCKETS) {
+    num_keys = ROW_INDEX_NUM_BUCKETS;
+  }
+  size_t found = 0;
+  for (long key = min_key; key < min_key + num_keys; key++) {
+    row_bucket_t *bucket = row_index_bucket(index, key);
+    for (size_t i = 0; i < bucket->size && found < max_bodies; i++) {
+      // rows a ring apart share the bucket
+      double height = bucket->entries[i].height;
+      if (height >= low && height <= high) {
+        bodies[found++] = bucket->entries[i].body;
+      }
+    }
+  }
+  return found;
+}
@@ -3,8 +3,12 @@
 #include <stdlib.h>
 
 #include "forces.h"
+#include "profile.h"
 #include "scene.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
 const size_t INITIAL_NUM_BODIES = 5;
 const size_t INITIAL_NUM_FORCES = 5;
 
@@ -70,6 +74,7 @@ void scene_free(scene_t *screen) {
 }
 
 void scene_tick(scene_t *scene, double dt) {
+  PROFILE_FUNCTION();
   // calls all force creators in the scene
   for (size_t i = 0; i < list_size(scene->force_creators); i++) {
     force_instance_t *force = list_get(scene->force_creators, i);
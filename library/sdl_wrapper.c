@@ -1,30 +1,41 @@
 #include "sdl_wrapper.h"
+#include "asset_cache.h"
+#include "profile.h"
+#include "text_cache.h"
+#include "voice.h"
 #include <SDL2/SDL.h>
-#include <SDL2/SDL2_gfxPrimitives.h>
 #include <assert.h>
 #include <math.h>
+#include <stdint.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 #include <SDL2/SDL_mixer.h>
 
 const char WINDOW_TITLE[] = "CS 3";
 const int WINDOW_WIDTH = 1000;
 const int WINDOW_HEIGHT = 500;
 const double MS_PER_S = 1e3;
-// length of 1 character
-const size_t CHAR_LEN = 18;
 // height of a character/the text
 const size_t CHAR_HEIGHT = 40;
 const Uint8 BLUE_NUM = 225;
+// texture size to assume when the renderer doesn't report a limit
+const int FALLBACK_MAX_TEXTURE_SIZE = 2048;
+// leaves a texture's own colors unchanged
+const SDL_Color OPAQUE_WHITE = {.r = 255, .g = 255, .b = 255, .a = 255};
+// one frame drawn, one waiting to be drawn and one being filled
+#define NUM_RENDER_FRAMES 3
+// events the render thread holds for the game thread between two frames
+#define MAX_FORWARDED_EVENTS 256
+// how often the idle render thread checks for window events
+const Uint32 EVENT_POLL_MS = 5;
+
+typedef void (*render_job_t)(void *aux);
 
 /**
- * The coordinate at the center of the screen.
+ * The camera mapping the scene to the window. Its transform is refreshed
+ * when the window is resized or the camera moves.
  */
-vector_t center;
-/**
- * The coordinate difference from the center to the top right corner.
- */
-vector_t max_diff;
+camera_t *screen_camera;
 /**
  * The SDL window where the scene is rendered.
  */
@@ -41,6 +52,37 @@ key_handler_t key_handler = NULL;
  * The mousepress handler, or NULL if none configured.
  */
 mouse_handler_t mouse_handler = NULL;
+/**
+ * The frames draw commands are queued in. The game fills `building`; with a
+ * render thread, `sdl_show` hands it over as `submitted` and the render
+ * thread moves it to `drawing` while drawing it.
+ */
+static render_frame_t *frames[NUM_RENDER_FRAMES];
+static render_frame_t *building = NULL;
+/**
+ * Whether a render thread owns the renderer (see sdl_run_threaded). The
+ * fields below are only used when it does and are guarded by render_lock.
+ */
+static bool threaded = false;
+static SDL_threadID render_thread_id;
+static SDL_mutex *render_lock;
+// signalled when the render thread has work: a job or a frame
+static SDL_cond *render_wake;
+// signalled when the render thread finishes a job or takes a frame
+static SDL_cond *render_done;
+static render_frame_t *submitted = NULL;
+static render_frame_t *drawing = NULL;
+static render_job_t pending_job = NULL;
+static void *pending_job_aux;
+// the game run by sdl_run_threaded, and whether it has returned
+static SDL_ThreadFunction game_func;
+static bool game_finished = false;
+static SDL_Event forwarded_events[MAX_FORWARDED_EVENTS];
+static size_t num_forwarded_events = 0;
+/**
+ * The layer images and polygons are queued in, set with sdl_set_layer().
+ */
+static render_layer_t current_layer = LAYER_SPRITES;
 
 
 /**
@@ -48,139 +90,200 @@ mouse_handler_t mouse_handler = NULL;
  * Used to mesasure how long a key has been held.
  */
 uint32_t key_start_timestamp;
+
 /**
- * The value of clock() when time_since_last_tick() was last called.
- * Initially 0.
+ * Runs a job on the thread that owns the renderer and waits for it. Without
+ * a render thread, or on the render thread itself, the job just runs.
  */
-clock_t last_clock = 0;
+static void render_call(render_job_t fn, void *aux) {
+  if (!threaded || SDL_ThreadID() == render_thread_id) {
+    fn(aux);
+    return;
+  }
+  SDL_LockMutex(render_lock);
+  // only the game thread posts jobs, so the slot is free
+  pending_job = fn;
+  pending_job_aux = aux;
+  SDL_CondSignal(render_wake);
+  while (pending_job != NULL) {
+    SDL_CondWait(render_done, render_lock);
+  }
+  SDL_UnlockMutex(render_lock);
+}
 
+typedef struct texture_job {
+  const char *path;
+  SDL_Surface *surface;
+  Uint32 format;
+  int width;
+  int height;
+  const void *pixels;
+  int pitch;
+  SDL_Texture *texture;
+} texture_job_t;
+
+static void load_texture_job(texture_job_t *job) {
+  job->texture = IMG_LoadTexture(renderer, job->path);
+}
 
 SDL_Texture *sdl_display(const char *stringPath) {
-  SDL_Texture *img = IMG_LoadTexture(renderer, stringPath);
-  return (SDL_Texture *)img;
+  texture_job_t job = {.path = stringPath};
+  render_call((render_job_t)load_texture_job, &job);
+  return job.texture;
+}
+
+static void surface_texture_job(texture_job_t *job) {
+  job->texture = SDL_CreateTextureFromSurface(renderer, job->surface);
+}
+
+SDL_Texture *sdl_create_texture(SDL_Surface *surface) {
+  texture_job_t job = {.surface = surface};
+  render_call((render_job_t)surface_texture_job, &job);
+  return job.texture;
+}
+
+static void pixels_texture_job(texture_job_t *job) {
+  job->texture = SDL_CreateTexture(renderer, job->format,
+                                   SDL_TEXTUREACCESS_STATIC, job->width,
+                                   job->height);
+  if (job->texture == NULL) {
+    return;
+  }
+  if (SDL_UpdateTexture(job->texture, NULL, job->pixels, job->pitch) != 0) {
+    SDL_DestroyTexture(job->texture);
+    job->texture = NULL;
+    return;
+  }
+  SDL_SetTextureBlendMode(job->texture, SDL_BLENDMODE_BLEND);
+}
+
+SDL_Texture *sdl_create_texture_from_pixels(Uint32 format, int width,
+                                            int height, const void *pixels,
+                                            int pitch) {
+  texture_job_t job = {.format = format,
+                       .width = width,
+                       .height = height,
+                       .pixels = pixels,
+                       .pitch = pitch};
+  render_call((render_job_t)pixels_texture_job, &job);
+  return job.texture;
+}
+
+void sdl_destroy_texture(SDL_Texture *texture) {
+  render_frame_destroy_texture(building, texture);
+}
+
+static void max_texture_size_job(int *size) {
+  SDL_RendererInfo info;
+  if (SDL_GetRendererInfo(renderer, &info) != 0 ||
+      info.max_texture_width == 0 || info.max_texture_height == 0) {
+    // 0 means "no limit reported"; fall back to a size every GPU handles
+    *size = FALLBACK_MAX_TEXTURE_SIZE;
+    return;
+  }
+  *size = info.max_texture_width < info.max_texture_height
+              ? info.max_texture_width
+              : info.max_texture_height;
+}
+
+int sdl_max_texture_size(void) {
+  int size;
+  render_call((render_job_t)max_texture_size_job, &size);
+  return size;
+}
+
+Mix_Chunk *sdl_get_sound(const char *sound_path) {
+  return asset_cache_obj_get_or_create(ASSET_SOUND, sound_path);
 }
 
 void sdl_play_sound(Mix_Chunk *sound) {
-  Mix_PlayChannel(-1, sound, 0);
+  // sounds that are still being preloaded are NULL, which voice_play skips
+  voice_play(sound, DEFAULT_VOICE_PARAMS);
 }
 
+void sdl_free_sound(Mix_Chunk *sound) { voice_stop(sound); }
+
 
 void sdl_render_image(SDL_Texture *img, size_t img_width, size_t img_height,
                       size_t img_center_x, size_t img_center_y) {
-  SDL_Rect *texr = malloc(sizeof(SDL_Rect));
-  texr->x = img_center_x;
-  texr->y = img_center_y;
-  texr->w = img_width;
-  texr->h = img_height;
-
-  SDL_RenderCopy(renderer, img, NULL, texr);
-  free(texr);
+  sdl_render_image_clip(img, NULL, img_width, img_height, img_center_x,
+                        img_center_y);
 }
 
-void sdl_render_image_with_cam(SDL_Texture *img, size_t img_width, size_t img_height,
-                      size_t img_center_x, size_t img_center_y, double cam_height) {
-  SDL_Rect *texr = malloc(sizeof(SDL_Rect));
-  texr->x = img_center_x;
-  texr->y = img_center_y + cam_height;
-  texr->w = img_width;
-  texr->h = img_height;
+void sdl_set_layer(render_layer_t layer) { current_layer = layer; }
 
-  SDL_RenderCopy(renderer, img, NULL, texr);
-  free(texr);
-}
+render_layer_t sdl_get_layer(void) { return current_layer; }
 
+void sdl_render_image_clip(SDL_Texture *img, const SDL_Rect *clip,
+                           size_t img_width, size_t img_height,
+                           size_t img_center_x, size_t img_center_y) {
+  SDL_FRect texr = {.x = img_center_x,
+                    .y = img_center_y,
+                    .w = img_width,
+                    .h = img_height};
+  render_frame_add_sprite(building, img, current_layer, clip, texr,
+                          OPAQUE_WHITE);
+}
 
-SDL_Rect sdl_get_bounding_box(body_t *body) {
-  // initializes mininum and maximum x and y values
-  double min_x = __DBL_MAX__;
-  double max_x = -__DBL_MAX__;
-  double min_y = __DBL_MAX__;
-  double max_y = -__DBL_MAX__;
-  list_t *polygon_points = body_get_shape(body);
-  for (size_t i = 0; i < list_size(polygon_points); i++) {
-    vector_t *vertex = list_get(polygon_points, i);
-    // finds minimum and maximum x and y values for the polygon
-    if (vertex->x > max_x) {
-      max_x = vertex->x;
-    }
-    if (vertex->x < min_x) {
-      min_x = vertex->x;
-    }
-    if (vertex->y > max_y) {
-      max_y = vertex->y;
-    }
-    if (vertex->y < min_y) {
-      min_y = vertex->y;
-    }
-  }
-  vector_t window = get_window_center();
+SDL_Rect sdl_get_pixel_rect(aabb_t bounds) {
   // converts each coordinate to SDL coordinates
-  vector_t top_l =
-      get_window_position((vector_t){.x = min_x, .y = max_y}, window);
-  vector_t bottom_r =
-      get_window_position((vector_t){.x = max_x, .y = min_y}, window);
+  vector_t top_l = camera_to_pixel(
+      screen_camera, (vector_t){.x = bounds.min.x, .y = bounds.max.y});
+  vector_t bottom_r = camera_to_pixel(
+      screen_camera, (vector_t){.x = bounds.max.x, .y = bounds.min.y});
   SDL_Rect box;
-  box.x = top_l.x;
-  box.y = top_l.y;
-  box.w = bottom_r.x - top_l.x;
-  box.h = bottom_r.y - top_l.y;
-  list_free(polygon_points);
+  box.x = round(top_l.x);
+  box.y = round(top_l.y);
+  box.w = round(bottom_r.x) - box.x;
+  box.h = round(bottom_r.y) - box.y;
   return box;
 }
 
+SDL_Rect sdl_get_bounding_box(body_t *body) {
+  return sdl_get_pixel_rect(body_get_aabb(body));
+}
+
 void sdl_render_text(const char *txt, TTF_Font *font, const vector_t position,
                      SDL_Color color) {
-  SDL_Surface *surfaceMessage = TTF_RenderText_Solid(font, txt, color);
-  SDL_Texture *Message = SDL_CreateTextureFromSurface(renderer, surfaceMessage);
-
-  SDL_Rect *Message_rect = malloc(sizeof(SDL_Rect));
-  Message_rect->x = position.x;
-  Message_rect->y = position.y;
-  // width changes based on text length
-  Message_rect->w = CHAR_LEN * strlen(txt);
-  Message_rect->h = CHAR_HEIGHT;
-  SDL_RenderCopy(renderer, Message, NULL, Message_rect);
-
-  SDL_FreeSurface(surfaceMessage);
-  SDL_DestroyTexture(Message);
-  free(Message_rect);
+  PROFILE_FUNCTION();
+  const glyph_atlas_t *atlas = text_cache_get_glyphs(font);
+  if (atlas == NULL) {
+    return;
+  }
+  // glyphs are stretched so a line is CHAR_HEIGHT pixels tall
+  double scale = (double)CHAR_HEIGHT / atlas->line_height;
+  double pen_x = position.x;
+  for (const char *c = txt; *c != '\0'; c++) {
+    const glyph_t *glyph = text_cache_get_glyph(atlas, *c);
+    if (glyph->src.w > 0) {
+      // the glyphs are white, so the vertex color tints them
+      SDL_FRect dest = {.x = pen_x,
+                        .y = position.y,
+                        .w = glyph->src.w * scale,
+                        .h = glyph->src.h * scale};
+      render_frame_add_sprite(building, atlas->texture, LAYER_TEXT,
+                              &glyph->src, dest, color);
+    }
+    pen_x += glyph->advance * scale;
+  }
 }
 
-vector_t get_window_center(void) {
-  int *width = malloc(sizeof(*width)), *height = malloc(sizeof(*height));
-  assert(width != NULL);
-  assert(height != NULL);
-  SDL_GetWindowSize(window, width, height);
-  vector_t dimensions = {.x = *width, .y = *height};
-  free(width);
-  free(height);
-  return vec_multiply(0.5, dimensions);
+void sdl_render_static_text(const char *txt, TTF_Font *font,
+                            const vector_t position, SDL_Color color) {
+  SDL_Texture *texture = text_cache_get_string(font, txt, color);
+  if (texture == NULL) {
+    return;
+  }
+  int w, h;
+  SDL_QueryTexture(texture, NULL, NULL, &w, &h);
+  double scale = (double)CHAR_HEIGHT / h;
+  SDL_FRect dest = {
+      .x = position.x, .y = position.y, .w = w * scale, .h = CHAR_HEIGHT};
+  render_frame_add_sprite(building, texture, LAYER_TEXT, NULL, dest,
+                          OPAQUE_WHITE);
 }
 
-/**
- * Computes the scaling factor between scene coordinates and pixel coordinates.
- * The scene is scaled by the same factor in the x and y dimensions,
- * chosen to maximize the size of the scene while keeping it in the window.
- */
-double get_scene_scale(vector_t window_center) {
-  // Scale scene so it fits entirely in the window
-  double x_scale = window_center.x / max_diff.x,
-         y_scale = window_center.y / max_diff.y;
-  return x_scale < y_scale ? x_scale : y_scale;
-}
-
-/** Maps a scene coordinate to a window coordinate */
-vector_t get_window_position(vector_t scene_pos, vector_t window_center) {
-  // Scale scene coordinates by the scaling factor
-  // and map the center of the scene to the center of the window
-  vector_t scene_center_offset = vec_subtract(scene_pos, center);
-  double scale = get_scene_scale(window_center);
-  vector_t pixel_center_offset = vec_multiply(scale, scene_center_offset);
-  vector_t pixel = {.x = round(window_center.x + pixel_center_offset.x),
-                    // Flip y axis since positive y is down on the screen
-                    .y = round(window_center.y - pixel_center_offset.y)};
-  return pixel;
-}
+camera_t *sdl_get_camera(void) { return screen_camera; }
 
 /**
  * Converts an SDL key code to a char.
@@ -205,62 +308,107 @@ char get_keycode(SDL_Keycode key) {
   }
 }
 
-void sdl_init(vector_t min, vector_t max) {
-  // Check parameters
-  assert(min.x < max.x);
-  assert(min.y < max.y);
-
-  center = vec_multiply(0.5, vec_add(min, max));
-  max_diff = vec_subtract(max, center);
+static void init_job(vector_t *viewport) {
   SDL_Init(SDL_INIT_EVERYTHING);
   window = SDL_CreateWindow(WINDOW_TITLE, SDL_WINDOWPOS_CENTERED,
                             SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT,
                             SDL_WINDOW_RESIZABLE);
   renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_PRESENTVSYNC);
   TTF_Init();
+  int width, height;
+  SDL_GetWindowSize(window, &width, &height);
+  *viewport = (vector_t){.x = width, .y = height};
 }
 
-bool sdl_is_done(void *state) {
-  SDL_Event *event = malloc(sizeof(*event));
-  assert(event != NULL);
-  while (SDL_PollEvent(event)) {
-    switch (event->type) {
-    case SDL_QUIT:
-      free(event);
-      return true;
-    case SDL_KEYDOWN:
-    case SDL_KEYUP:
-      // Skip the keypress if no handler is configured
-      // or an unrecognized key was pressed
-      if (key_handler == NULL)
-        break;
-      char key = get_keycode(event->key.keysym.sym);
-      if (key == '\0')
-        break;
+void sdl_init(vector_t min, vector_t max) {
+  // Check parameters
+  assert(min.x < max.x);
+  assert(min.y < max.y);
 
-      uint32_t timestamp = event->key.timestamp;
-      if (!event->key.repeat) {
-        key_start_timestamp = timestamp;
-      }
-      key_event_type_t type =
-          event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
-      double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
-      key_handler(key, type, held_time, state);
+  // the window and renderer belong to the render thread, if there is one
+  vector_t viewport;
+  render_call((render_job_t)init_job, &viewport);
+  screen_camera = camera_init(vec_subtract(max, min));
+  camera_move_to(screen_camera, min);
+  camera_set_viewport(screen_camera, viewport);
+  for (size_t i = 0; i < NUM_RENDER_FRAMES; i++) {
+    frames[i] = render_frame_init();
+  }
+  building = frames[0];
+}
+
+/**
+ * Passes one event to the handlers.
+ *
+ * @return whether the window was closed
+ */
+static bool event_handle(SDL_Event *event, void *state) {
+  switch (event->type) {
+  case SDL_QUIT:
+    return true;
+  case SDL_KEYDOWN:
+  case SDL_KEYUP:
+    // Skip the keypress if no handler is configured
+    // or an unrecognized key was pressed
+    if (key_handler == NULL)
       break;
-    case SDL_MOUSEBUTTONDOWN:
-      if (mouse_handler != NULL) {
-        mouse_handler(state, event->motion.x, event->motion.y);
-      }
+    char key = get_keycode(event->key.keysym.sym);
+    if (key == '\0')
       break;
+
+    uint32_t timestamp = event->key.timestamp;
+    if (!event->key.repeat) {
+      key_start_timestamp = timestamp;
+    }
+    key_event_type_t type =
+        event->type == SDL_KEYDOWN ? KEY_PRESSED : KEY_RELEASED;
+    double held_time = (timestamp - key_start_timestamp) / MS_PER_S;
+    key_handler(key, type, held_time, state);
+    break;
+  case SDL_WINDOWEVENT:
+    if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+      camera_set_viewport(screen_camera, (vector_t){.x = event->window.data1,
+                                                    .y = event->window.data2});
+    }
+    break;
+  case SDL_MOUSEBUTTONDOWN:
+    if (mouse_handler != NULL) {
+      mouse_handler(state, event->motion.x, event->motion.y);
+    }
+    break;
+  }
+  return false;
+}
+
+bool sdl_is_done(void *state) {
+  if (!threaded) {
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+      if (event_handle(&event, state)) {
+        return true;
+      }
+    }
+    return false;
+  }
+  // the render thread polls the window and forwards the events here
+  static SDL_Event events[MAX_FORWARDED_EVENTS];
+  SDL_LockMutex(render_lock);
+  size_t num_events = num_forwarded_events;
+  memcpy(events, forwarded_events, sizeof(SDL_Event) * num_events);
+  num_forwarded_events = 0;
+  SDL_UnlockMutex(render_lock);
+  for (size_t i = 0; i < num_events; i++) {
+    if (event_handle(&events[i], state)) {
+      return true;
     }
   }
-  free(event);
   return false;
 }
 
 void sdl_clear(void) {
-  SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-  SDL_RenderClear(renderer);
+  // anything queued before the clear would be hidden by it anyway
+  render_frame_reset(building);
+  current_layer = LAYER_SPRITES;
 }
 
 void sdl_draw_polygon(polygon_t *poly, rgb_color_t color) {
@@ -269,73 +417,54 @@ void sdl_draw_polygon(polygon_t *poly, rgb_color_t color) {
   size_t n = list_size(points);
   assert(n >= 3);
 
-  vector_t window_center = get_window_center();
-
   // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
+  SDL_Color vertex_color = {.r = color.r * 255,
+                            .g = color.g * 255,
+                            .b = color.b * 255,
+                            .a = 255};
+  SDL_Vertex *vertices = render_frame_add_polygon(building, current_layer, n);
   for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y;
+    vector_t *point = list_get(points, i);
+    vector_t pixel = camera_to_pixel(screen_camera, *point);
+    vertices[i] = (SDL_Vertex){{pixel.x, pixel.y}, vertex_color, {0, 0}};
   }
-
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
-                    color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
 }
 
-void sdl_draw_polygon_cam(polygon_t *poly, rgb_color_t color, double cam_height) {
-  list_t *points = polygon_get_points(poly);
-  // Check parameters
-  size_t n = list_size(points);
-  assert(n >= 3);
-
-  vector_t window_center = get_window_center();
-
-  // Convert each vertex to a point on screen
-  int16_t *x_points = malloc(sizeof(*x_points) * n),
-          *y_points = malloc(sizeof(*y_points) * n);
-  assert(x_points != NULL);
-  assert(y_points != NULL);
-  for (size_t i = 0; i < n; i++) {
-    vector_t *vertex = list_get(points, i);
-    vector_t pixel = get_window_position(*vertex, window_center);
-    x_points[i] = pixel.x;
-    y_points[i] = pixel.y - cam_height;
-  }
-
-  // Draw polygon with the given color
-  filledPolygonRGBA(renderer, x_points, y_points, n, color.r * 255,
-                    color.g * 255, color.b * 255, 255);
-  free(x_points);
-  free(y_points);
+/**
+ * Presents the drawn frame, which may wait for the display's vsync.
+ */
+static void render_present(void) {
+  PROFILE_SCOPE("SDL_RenderPresent");
+  SDL_RenderPresent(renderer);
 }
 
-
-
 void sdl_show(void) {
-  // Draw boundary lines
-  vector_t window_center = get_window_center();
-  vector_t max = vec_add(center, max_diff),
-           min = vec_subtract(center, max_diff);
-  vector_t max_pixel = get_window_position(max, window_center),
-           min_pixel = get_window_position(min, window_center);
-  SDL_Rect *boundary = malloc(sizeof(*boundary));
-  boundary->x = min_pixel.x;
-  boundary->y = max_pixel.y;
-  boundary->w = max_pixel.x - min_pixel.x;
-  boundary->h = min_pixel.y - max_pixel.y;
-  SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-  SDL_RenderDrawRect(renderer, boundary);
-  free(boundary);
-
-  SDL_RenderPresent(renderer);
+  PROFILE_FUNCTION();
+  // Draw boundary lines around the part of the window the scene fills
+  render_frame_set_boundary(building,
+                            sdl_get_pixel_rect(camera_get_view(screen_camera)));
+  if (!threaded) {
+    render_frame_draw(building, renderer);
+    render_present();
+  } else {
+    SDL_LockMutex(render_lock);
+    // the game runs at most one frame ahead of the screen
+    while (submitted != NULL) {
+      SDL_CondWait(render_done, render_lock);
+    }
+    submitted = building;
+    SDL_CondSignal(render_wake);
+    for (size_t i = 0; i < NUM_RENDER_FRAMES; i++) {
+      if (frames[i] != submitted && frames[i] != drawing) {
+        building = frames[i];
+        break;
+      }
+    }
+    SDL_UnlockMutex(render_lock);
+  }
+  render_frame_reset(building);
+  // sounds de-duplicate per presented frame
+  voice_end_frame();
 }
 
 void sdl_render_scene(scene_t *scene, void *aux) {
@@ -343,10 +472,7 @@ void sdl_render_scene(scene_t *scene, void *aux) {
   size_t body_count = scene_bodies(scene);
   for (size_t i = 0; i < body_count; i++) {
     body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    polygon_t *poly = polygon_init(shape, (vector_t){0, 0}, 0, 0, 0, 0);
-    sdl_draw_polygon(poly, *body_get_color(body));
-    list_free(shape);
+    sdl_draw_polygon(body_get_polygon(body), *body_get_color(body));
   }
   if (aux != NULL) {
     body_t *body = aux;
@@ -355,33 +481,117 @@ void sdl_render_scene(scene_t *scene, void *aux) {
   sdl_show();
 }
 
-void sdl_render_scene_cam(scene_t *scene, void *aux, double cam_height) {
-  sdl_clear();
-  size_t body_count = scene_bodies(scene);
-  for (size_t i = 0; i < body_count; i++) {
-    body_t *body = scene_get_body(scene, i);
-    list_t *shape = body_get_shape(body);
-    polygon_t *poly = polygon_init(shape, (vector_t){0, 0}, 0, 0, 0, 0);
-    sdl_draw_polygon_cam(poly, *body_get_color(body), cam_height);
-    list_free(shape);
+/**
+ * Moves the window's pending events to the game thread's queue. Events that
+ * don't fit are dropped.
+ */
+static void events_forward(void) {
+  SDL_Event event;
+  while (SDL_PollEvent(&event)) {
+    SDL_LockMutex(render_lock);
+    if (num_forwarded_events < MAX_FORWARDED_EVENTS) {
+      forwarded_events[num_forwarded_events] = event;
+      num_forwarded_events++;
+    }
+    SDL_UnlockMutex(render_lock);
   }
-  if (aux != NULL) {
-    body_t *body = aux;
-    sdl_draw_polygon(body_get_polygon(body), *body_get_color(body));
+}
+
+/**
+ * Runs the job the game thread is waiting on, if any. Called on the render
+ * thread with render_lock held, which it releases while the job runs.
+ */
+static void run_pending_job(void) {
+  if (pending_job == NULL) {
+    return;
   }
-  sdl_show();
+  SDL_UnlockMutex(render_lock);
+  pending_job(pending_job_aux);
+  SDL_LockMutex(render_lock);
+  pending_job = NULL;
+  SDL_CondBroadcast(render_done);
 }
 
+/**
+ * Runs the game, then tells the render thread it returned.
+ */
+static int game_main(void *aux) {
+  int result = game_func(aux);
+  SDL_LockMutex(render_lock);
+  game_finished = true;
+  SDL_CondSignal(render_wake);
+  SDL_UnlockMutex(render_lock);
+  return result;
+}
+
+/**
+ * Destroys the renderer and window and shuts SDL down, on the main thread.
+ */
+static void sdl_quit(void) {
+  if (renderer != NULL) {
+    SDL_DestroyRenderer(renderer);
+    renderer = NULL;
+  }
+  if (window != NULL) {
+    SDL_DestroyWindow(window);
+    window = NULL;
+  }
+  TTF_Quit();
+  SDL_Quit();
+}
+
+void sdl_run_threaded(SDL_ThreadFunction game) {
+  render_lock = SDL_CreateMutex();
+  render_wake = SDL_CreateCond();
+  render_done = SDL_CreateCond();
+  render_thread_id = SDL_ThreadID();
+  game_func = game;
+  threaded = true;
+  SDL_Thread *game_thread = SDL_CreateThread(game_main, "game", NULL);
+  if (game_thread == NULL) {
+    // no threads: simulate and render in series
+    threaded = false;
+    game(NULL);
+    sdl_quit();
+    return;
+  }
+  SDL_LockMutex(render_lock);
+  // after the game returns, nothing is left to draw or to run for it
+  while (!game_finished) {
+    if (pending_job != NULL) {
+      run_pending_job();
+    } else if (submitted != NULL) {
+      drawing = submitted;
+      submitted = NULL;
+      SDL_CondBroadcast(render_done);
+      SDL_UnlockMutex(render_lock);
+      // the game fills the next frame while this one is drawn and presented
+      render_frame_draw(drawing, renderer);
+      SDL_LockMutex(render_lock);
+      // a texture upload posted while drawing shouldn't wait out the vsync
+      run_pending_job();
+      SDL_UnlockMutex(render_lock);
+      render_present();
+      SDL_LockMutex(render_lock);
+      drawing = NULL;
+    } else {
+      SDL_CondWaitTimeout(render_wake, render_lock, EVENT_POLL_MS);
+    }
+    if (window != NULL) {
+      SDL_UnlockMutex(render_lock);
+      events_forward();
+      SDL_LockMutex(render_lock);
+    }
+  }
+  SDL_UnlockMutex(render_lock);
+  SDL_WaitThread(game_thread, NULL);
+  threaded = false;
+  SDL_DestroyCond(render_done);
+  SDL_DestroyCond(render_wake);
+  SDL_DestroyMutex(render_lock);
+  sdl_quit();
+}
 
 void sdl_on_key(key_handler_t handler) { key_handler = handler; }
 
 void sdl_on_mouse(mouse_handler_t handler) { mouse_handler = handler; }
-
-double time_since_last_tick(void) {
-  clock_t now = clock();
-  double difference = last_clock
-                          ? (double)(now - last_clock) / CLOCKS_PER_SEC
-                          : 0.0; // return 0 the first time this is called
-  last_clock = now;
-  return difference;
-}
\ No newline at end of file
@@ -0,0 +1,129 @@
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spatial_hash.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_PHYSICS);
+
+const size_t SPATIAL_HASH_INITIAL_POINTS = 64;
+// with radius <= cell size, a query spans at most 3 cells each way
+#define MAX_QUERY_CELLS 9
+
+struct spatial_hash {
+  double cell_size;
+  size_t num_buckets;
+  // the entries of bucket b are entries[bucket_starts[b]..bucket_starts[b+1])
+  size_t *bucket_starts;
+  // point indices, sorted by bucket
+  size_t *entries;
+  size_t capacity;
+  const vector_t *points;
+  size_t num_points;
+};
+
+spatial_hash_t *spatial_hash_init(double cell_size, size_t num_buckets) {
+  assert(cell_size > 0 && num_buckets > 0);
+  spatial_hash_t *hash = malloc(sizeof(spatial_hash_t));
+  assert(hash);
+  hash->cell_size = cell_size;
+  hash->num_buckets = num_buckets;
+  hash->bucket_starts = calloc(num_buckets + 1, sizeof(size_t));
+  hash->capacity = SPATIAL_HASH_INITIAL_POINTS;
+  hash->entries = malloc(sizeof(size_t) * hash->capacity);
+  assert(hash->bucket_starts && hash->entries);
+  hash->points = NULL;
+  hash->num_points = 0;
+  return hash;
+}
+
+void spatial_hash_free(spatial_hash_t *hash) {
+  free(hash->bucket_starts);
+  free(hash->entries);
+  free(hash);
+}
+
+static long spatial_hash_coord(spatial_hash_t *hash, double x) {
+  return (long)floor(x / hash->cell_size);
+}
+
+static size_t spatial_hash_bucket(spatial_hash_t *hash, long col, long row) {
+  uint32_t h = (uint32_t)col * 73856093u ^ (uint32_t)row * 19349663u;
+  return h % hash->num_buckets;
+}
+
+static size_t spatial_hash_point_bucket(spatial_hash_t *hash, vector_t point) {
+  return spatial_hash_bucket(hash, spatial_hash_coord(hash, point.x),
+                             spatial_hash_coord(hash, point.y));
+}
+
+void spatial_hash_build(spatial_hash_t *hash, const vector_t *points,
+                        size_t num_points) {
+  if (num_points > hash->capacity) {
+    while (hash->capacity < num_points) {
+      hash->capacity *= 2;
+    }
+    hash->entries = realloc(hash->entries, sizeof(size_t) * hash->capacity);
+    assert(hash->entries);
+  }
+  hash->points = points;
+  hash->num_points = num_points;
+
+  // counting sort: count each bucket, turn the counts into the ends of the
+  // buckets, then fill every bucket from its end down to its start
+  size_t *starts = hash->bucket_starts;
+  memset(starts, 0, sizeof(size_t) * (hash->num_buckets + 1));
+  for (size_t i = 0; i < num_points; i++) {
+    starts[spatial_hash_point_bucket(hash, points[i])]++;
+  }
+  size_t end = 0;
+  for (size_t b = 0; b <= hash->num_buckets; b++) {
+    end += starts[b];
+    starts[b] = end;
+  }
+  for (size_t i = num_points; i-- > 0;) {
+    hash->entries[--starts[spatial_hash_point_bucket(hash, points[i])]] = i;
+  }
+}
+
+size_t spatial_hash_query(spatial_hash_t *hash, vector_t center, double radius,
+                          size_t *indices, size_t max_indices) {
+  assert(radius <= hash->cell_size);
+  double radius_squared = radius * radius;
+  long min_col = spatial_hash_coord(hash, center.x - radius);
+  long max_col = spatial_hash_coord(hash, center.x + radius);
+  long min_row = spatial_hash_coord(hash, center.y - radius);
+  long max_row = spatial_hash_coord(hash, center.y + radius);
+  // cells that share a bucket are only visited once
+  size_t visited[MAX_QUERY_CELLS];
+  size_t num_visited = 0;
+  size_t found = 0;
+  for (long row = min_row; row <= max_row; row++) {
+    for (long col = min_col; col <= max_col; col++) {
+      size_t bucket = spatial_hash_bucket(hash, col, row);
+      bool seen = false;
+      for (size_t v = 0; v < num_visited; v++) {
+        seen |= visited[v] == bucket;
+      }
+      if (seen) {
+        continue;
+      }
+      visited[num_visited++] = bucket;
+      size_t stop = hash->bucket_starts[bucket + 1];
+      for (size_t e = hash->bucket_starts[bucket];
+           e < stop && found < max_indices; e++) {
+        size_t i = hash->entries[e];
+        double dx = hash->points[i].x - center.x;
+        double dy = hash->points[i].y - center.y;
+        if (dx * dx + dy * dy <= radius_squared) {
+          indices[found++] = i;
+        }
+      }
+    }
+  }
+  return found;
+}
@@ -0,0 +1,78 @@
+#include <SDL2/SDL.h>
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spsc_queue.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
+struct spsc_queue {
+  size_t item_size;
+  // capacity - 1, since the capacity is a power of two
+  size_t mask;
+  char *items;
+  // how many items were ever popped, written only by the consumer
+  SDL_atomic_t head;
+  // how many items were ever pushed, written only by the producer
+  SDL_atomic_t tail;
+};
+
+spsc_queue_t *spsc_queue_init(size_t item_size, size_t capacity) {
+  assert(item_size > 0);
+  assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+  spsc_queue_t *queue = malloc(sizeof(spsc_queue_t));
+  assert(queue);
+  queue->item_size = item_size;
+  queue->mask = capacity - 1;
+  queue->items = malloc(item_size * capacity);
+  assert(queue->items);
+  SDL_AtomicSet(&queue->head, 0);
+  SDL_AtomicSet(&queue->tail, 0);
+  return queue;
+}
+
+void spsc_queue_free(spsc_queue_t *queue) {
+  free(queue->items);
+  free(queue);
+}
+
+bool spsc_queue_push(spsc_queue_t *queue, const void *item) {
+  // the counts wrap around together, so their difference is still the size
+  unsigned tail = SDL_AtomicGet(&queue->tail);
+  unsigned head = SDL_AtomicGet(&queue->head);
+  if (tail - head > queue->mask) {
+    return false;
+  }
+  // don't overwrite the slot before seeing that the consumer is done with it
+  SDL_MemoryBarrierAcquire();
+  memcpy(queue->items + (tail & queue->mask) * queue->item_size, item,
+         queue->item_size);
+  // the item must be written before the consumer can see it
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&queue->tail, tail + 1);
+  return true;
+}
+
+bool spsc_queue_pop(spsc_queue_t *queue, void *item) {
+  unsigned head = SDL_AtomicGet(&queue->head);
+  unsigned tail = SDL_AtomicGet(&queue->tail);
+  if (head == tail) {
+    return false;
+  }
+  // don't read the item before seeing that it was published
+  SDL_MemoryBarrierAcquire();
+  memcpy(item, queue->items + (head & queue->mask) * queue->item_size,
+         queue->item_size);
+  // the item must be read before the producer can reuse its slot
+  SDL_MemoryBarrierRelease();
+  SDL_AtomicSet(&queue->head, head + 1);
+  return true;
+}
+
+size_t spsc_queue_size(spsc_queue_t *queue) {
+  unsigned head = SDL_AtomicGet(&queue->head);
+  unsigned tail = SDL_AtomicGet(&queue->tail);
+  return tail - head;
+}
@@ -4,6 +4,9 @@
 #include <stdbool.h>
 #include "strarray.h"
 
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_CORE);
+
 /**
  * initializes the strarray object with a given length
  */
@@ -0,0 +1,244 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "atlas.h"
+#include "list.h"
+#include "sdl_wrapper.h"
+#include "text_cache.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_RENDER);
+
+// first page size tried for a glyph atlas; doubled until every glyph fits
+const int GLYPH_PAGE_SIZE = 256;
+// string textures kept before the least recently used one is dropped
+const size_t MAX_STRING_TEXTURES = 32;
+const size_t TEXT_CACHE_CAPACITY = 4;
+const char FALLBACK_GLYPH = '?';
+
+typedef struct font_glyphs {
+  TTF_Font *font;
+  glyph_atlas_t atlas;
+} font_glyphs_t;
+
+typedef struct string_texture {
+  TTF_Font *font;
+  char *text;
+  SDL_Color color;
+  SDL_Texture *texture;
+  // STRING_CLOCK when the string was last drawn
+  size_t last_used;
+} string_texture_t;
+
+static list_t *FONT_GLYPHS;
+static list_t *STRING_TEXTURES;
+static size_t STRING_CLOCK;
+
+static void font_glyphs_free(font_glyphs_t *glyphs) {
+  if (glyphs->atlas.texture != NULL) {
+    sdl_destroy_texture(glyphs->atlas.texture);
+  }
+  free(glyphs);
+}
+
+static void string_texture_free(string_texture_t *str) {
+  if (str->texture != NULL) {
+    sdl_destroy_texture(str->texture);
+  }
+  free(str->text);
+  free(str);
+}
+
+/**
+ * Creates the caches the first time any text is drawn.
+ */
+static void text_cache_init(void) {
+  if (FONT_GLYPHS != NULL) {
+    return;
+  }
+  FONT_GLYPHS =
+      list_init(TEXT_CACHE_CAPACITY, (free_func_t)font_glyphs_free);
+  STRING_TEXTURES =
+      list_init(MAX_STRING_TEXTURES, (free_func_t)string_texture_free);
+  STRING_CLOCK = 0;
+}
+
+/**
+ * Shelf-packs the rendered glyphs onto one page of the given size.
+ *
+ * @return the page, or NULL if the glyphs don't fit
+ */
+static SDL_Surface *glyph_page_pack(SDL_Surface **rendered,
+                                    glyph_atlas_t *atlas, int page_size) {
+  SDL_Surface *page = SDL_CreateRGBSurfaceWithFormat(0, page_size, page_size,
+                                                     32, SDL_PIXELFORMAT_RGBA32);
+  assert(page);
+  atlas_shelf_t shelf;
+  atlas_shelf_init(&shelf, page_size);
+  for (size_t i = 0; i < NUM_GLYPHS; i++) {
+    if (rendered[i] == NULL) {
+      atlas->glyphs[i].src = (SDL_Rect){0, 0, 0, 0};
+      continue;
+    }
+    if (!atlas_shelf_place(&shelf, rendered[i]->w, rendered[i]->h,
+                           &atlas->glyphs[i].src)) {
+      SDL_FreeSurface(page);
+      return NULL;
+    }
+    SDL_SetSurfaceBlendMode(rendered[i], SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(rendered[i], NULL, page, &atlas->glyphs[i].src);
+  }
+  return page;
+}
+
+/**
+ * Rasterizes every printable character of the font in white and uploads
+ * them as one texture.
+ */
+static bool glyph_atlas_build(glyph_atlas_t *atlas, TTF_Font *font) {
+  const SDL_Color white = {.r = 255, .g = 255, .b = 255, .a = 255};
+  SDL_Surface *rendered[NUM_GLYPHS];
+  atlas->line_height = TTF_FontHeight(font);
+  for (size_t i = 0; i < NUM_GLYPHS; i++) {
+    Uint16 c = FIRST_GLYPH + i;
+    int advance = 0;
+    if (TTF_GlyphMetrics(font, c, NULL, NULL, NULL, NULL, &advance) != 0) {
+      advance = 0;
+    }
+    atlas->glyphs[i].advance = advance;
+    // a space has nothing to draw, but still advances the pen
+    rendered[i] = c == ' ' ? NULL : TTF_RenderGlyph_Blended(font, c, white);
+  }
+
+  SDL_Surface *page = NULL;
+  int max_size = sdl_max_texture_size();
+  for (int size = GLYPH_PAGE_SIZE; page == NULL && size <= max_size;
+       size *= 2) {
+    page = glyph_page_pack(rendered, atlas, size);
+  }
+  for (size_t i = 0; i < NUM_GLYPHS; i++) {
+    if (rendered[i] != NULL) {
+      SDL_FreeSurface(rendered[i]);
+    }
+  }
+  if (page == NULL) {
+    return false;
+  }
+  atlas->texture = sdl_create_texture(page);
+  SDL_FreeSurface(page);
+  return atlas->texture != NULL;
+}
+
+const glyph_atlas_t *text_cache_get_glyphs(TTF_Font *font) {
+  if (font == NULL) {
+    return NULL;
+  }
+  text_cache_init();
+  for (size_t i = 0; i < list_size(FONT_GLYPHS); i++) {
+    font_glyphs_t *glyphs = list_get(FONT_GLYPHS, i);
+    if (glyphs->font == font) {
+      return glyphs->atlas.texture != NULL ? &glyphs->atlas : NULL;
+    }
+  }
+  font_glyphs_t *glyphs = malloc(sizeof(font_glyphs_t));
+  assert(glyphs);
+  glyphs->font = font;
+  glyphs->atlas.texture = NULL;
+  // kept even on failure, so a broken font isn't rasterized every frame
+  list_add(FONT_GLYPHS, glyphs);
+  if (!glyph_atlas_build(&glyphs->atlas, font)) {
+    return NULL;
+  }
+  return &glyphs->atlas;
+}
+
+const glyph_t *text_cache_get_glyph(const glyph_atlas_t *atlas, char c) {
+  if (c < FIRST_GLYPH || c > LAST_GLYPH) {
+    c = FALLBACK_GLYPH;
+  }
+  return &atlas->glyphs[c - FIRST_GLYPH];
+}
+
+static bool string_texture_matches(string_texture_t *str, TTF_Font *font,
+                                   const char *text, SDL_Color color) {
+  return str->font == font && str->color.r == color.r &&
+         str->color.g == color.g && str->color.b == color.b &&
+         str->color.a == color.a && strcmp(str->text, text) == 0;
+}
+
+/**
+ * Drops the least recently drawn string texture.
+ */
+static void string_textures_evict(void) {
+  size_t oldest = 0;
+  for (size_t i = 1; i < list_size(STRING_TEXTURES); i++) {
+    string_texture_t *str = list_get(STRING_TEXTURES, i);
+    string_texture_t *oldest_str = list_get(STRING_TEXTURES, oldest);
+    if (str->last_used < oldest_str->last_used) {
+      oldest = i;
+    }
+  }
+  string_texture_free(list_remove(STRING_TEXTURES, oldest));
+}
+
+SDL_Texture *text_cache_get_string(TTF_Font *font, const char *text,
+                                   SDL_Color color) {
+  if (font == NULL || text[0] == '\0') {
+    return NULL;
+  }
+  text_cache_init();
+  STRING_CLOCK++;
+  for (size_t i = 0; i < list_size(STRING_TEXTURES); i++) {
+    string_texture_t *str = list_get(STRING_TEXTURES, i);
+    if (string_texture_matches(str, font, text, color)) {
+      str->last_used = STRING_CLOCK;
+      return str->texture;
+    }
+  }
+  if (list_size(STRING_TEXTURES) >= MAX_STRING_TEXTURES) {
+    string_textures_evict();
+  }
+  SDL_Surface *surface = TTF_RenderText_Blended(font, text, color);
+  if (surface == NULL) {
+    return NULL;
+  }
+  string_texture_t *str = malloc(sizeof(string_texture_t));
+  assert(str);
+  str->font = font;
+  str->text = strdup(text);
+  str->color = color;
+  str->texture = sdl_create_texture(surface);
+  str->last_used = STRING_CLOCK;
+  SDL_FreeSurface(surface);
+  list_add(STRING_TEXTURES, str);
+  return str->texture;
+}
+
+void text_cache_forget_font(TTF_Font *font) {
+  if (FONT_GLYPHS == NULL) {
+    return;
+  }
+  for (size_t i = list_size(FONT_GLYPHS); i-- > 0;) {
+    font_glyphs_t *glyphs = list_get(FONT_GLYPHS, i);
+    if (glyphs->font == font) {
+      font_glyphs_free(list_remove(FONT_GLYPHS, i));
+    }
+  }
+  for (size_t i = list_size(STRING_TEXTURES); i-- > 0;) {
+    string_texture_t *str = list_get(STRING_TEXTURES, i);
+    if (str->font == font) {
+      string_texture_free(list_remove(STRING_TEXTURES, i));
+    }
+  }
+}
+
+void text_cache_destroy(void) {
+  if (FONT_GLYPHS == NULL) {
+    return;
+  }
+  list_free(FONT_GLYPHS);
+  list_free(STRING_TEXTURES);
+  FONT_GLYPHS = NULL;
+  STRING_TEXTURES = NULL;
+}
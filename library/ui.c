@@ -0,0 +1,111 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "list.h"
+#include "ui.h"
+
+#include "alloc_track.h"
+ALLOC_SUBSYSTEM(ALLOC_RENDER);
+
+const size_t UI_INITIAL_CHILDREN = 4;
+
+typedef enum { UI_GROUP, UI_ASSET, UI_LABEL } ui_node_type_t;
+
+struct ui_node {
+  ui_node_type_t type;
+  bool visible;
+  // children of a group
+  list_t *children;
+  // the asset drawn by an asset or label node
+  asset_t *asset;
+  bool owns_asset;
+  // the layer an asset node's images are queued in
+  render_layer_t layer;
+  // the text a label's text asset points at
+  char text[UI_LABEL_LEN];
+};
+
+static ui_node_t *ui_node_init(ui_node_type_t type) {
+  ui_node_t *node = malloc(sizeof(ui_node_t));
+  assert(node);
+  node->type = type;
+  node->visible = true;
+  node->children = NULL;
+  node->asset = NULL;
+  node->owns_asset = false;
+  node->layer = LAYER_SPRITES;
+  node->text[0] = '\0';
+  return node;
+}
+
+ui_node_t *ui_group_init(void) {
+  ui_node_t *group = ui_node_init(UI_GROUP);
+  group->children = list_init(UI_INITIAL_CHILDREN, (free_func_t)ui_free);
+  return group;
+}
+
+ui_node_t *ui_asset_init(asset_t *asset, bool owns_asset) {
+  assert(asset);
+  ui_node_t *node = ui_node_init(UI_ASSET);
+  node->asset = asset;
+  node->owns_asset = owns_asset;
+  return node;
+}
+
+ui_node_t *ui_label_init(const char *font_path, SDL_Rect box,
+                         rgb_color_t color, bool is_static) {
+  ui_node_t *label = ui_node_init(UI_LABEL);
+  label->asset = is_static
+                     ? asset_make_static_text(font_path, box, label->text, color)
+                     : asset_make_text(font_path, box, label->text, color);
+  label->owns_asset = true;
+  return label;
+}
+
+void ui_add_child(ui_node_t *group, ui_node_t *child) {
+  assert(group->type == UI_GROUP);
+  list_add(group->children, child);
+}
+
+void ui_set_visible(ui_node_t *node, bool visible) { node->visible = visible; }
+
+void ui_label_set_text(ui_node_t *label, const char *text) {
+  assert(label->type == UI_LABEL);
+  if (strncmp(label->text, text, UI_LABEL_LEN - 1) == 0) {
+    return;
+  }
+  strncpy(label->text, text, UI_LABEL_LEN - 1);
+  label->text[UI_LABEL_LEN - 1] = '\0';
+}
+
+void ui_set_layer(ui_node_t *node, render_layer_t layer) {
+  node->layer = layer;
+}
+
+void ui_render(ui_node_t *node) {
+  if (!node->visible) {
+    return;
+  }
+  if (node->type == UI_GROUP) {
+    for (size_t i = 0; i < list_size(node->children); i++) {
+      ui_render(list_get(node->children, i));
+    }
+  } else {
+    // leave the caller's layer as it was
+    render_layer_t layer = sdl_get_layer();
+    sdl_set_layer(node->layer);
+    asset_render(node->asset);
+    sdl_set_layer(layer);
+  }
+}
+
+void ui_free(ui_node_t *node) {
+  if (node->children != NULL) {
+    list_free(node->children);
+  }
+  if (node->owns_asset) {
+    asset_destroy(node->asset);
+  }
+  free(node);
+}
@@ -0,0 +1,115 @@
+#include "voice.h"
+
+const voice_params_t DEFAULT_VOICE_PARAMS = {.priority = 0,
+                                             .max_instances = 2};
+
+typedef struct voice {
+  Mix_Chunk *sound;
+  int priority;
+  // VOICE_CLOCK when the voice started, to find the oldest one
+  size_t started;
+} voice_t;
+
+static voice_t VOICES[NUM_VOICES];
+static size_t VOICE_CLOCK;
+// sounds started this frame; at most one start per voice per frame
+static Mix_Chunk *FRAME_SOUNDS[NUM_VOICES];
+static size_t NUM_FRAME_SOUNDS;
+
+void voice_init(void) {
+  Mix_AllocateChannels(NUM_VOICES);
+  for (size_t i = 0; i < NUM_VOICES; i++) {
+    VOICES[i] = (voice_t){.sound = NULL, .priority = 0, .started = 0};
+  }
+  VOICE_CLOCK = 0;
+  NUM_FRAME_SOUNDS = 0;
+}
+
+static bool voice_is_busy(int channel) {
+  return VOICES[channel].sound != NULL && Mix_Playing(channel);
+}
+
+static bool played_this_frame(Mix_Chunk *sound) {
+  for (size_t i = 0; i < NUM_FRAME_SOUNDS; i++) {
+    if (FRAME_SOUNDS[i] == sound) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Picks the channel a new sound should play on.
+ *
+ * @return the channel, or -1 if the sound should be dropped
+ */
+static int voice_pick(Mix_Chunk *sound, voice_params_t params) {
+  size_t instances = 0;
+  int oldest_instance = -1;
+  int free_channel = -1;
+  int victim = -1;
+  for (int i = 0; i < NUM_VOICES; i++) {
+    if (!voice_is_busy(i)) {
+      if (free_channel == -1) {
+        free_channel = i;
+      }
+      continue;
+    }
+    voice_t *voice = &VOICES[i];
+    if (voice->sound == sound) {
+      instances++;
+      if (oldest_instance == -1 ||
+          voice->started < VOICES[oldest_instance].started) {
+        oldest_instance = i;
+      }
+    }
+    if (voice->priority > params.priority) {
+      continue;
+    }
+    if (victim == -1 || voice->priority < VOICES[victim].priority ||
+        (voice->priority == VOICES[victim].priority &&
+         voice->started < VOICES[victim].started)) {
+      victim = i;
+    }
+  }
+  if (instances >= params.max_instances) {
+    return oldest_instance;
+  }
+  return free_channel != -1 ? free_channel : victim;
+}
+
+bool voice_play(Mix_Chunk *sound, voice_params_t params) {
+  if (sound == NULL || params.max_instances == 0) {
+    return false;
+  }
+  if (played_this_frame(sound) || NUM_FRAME_SOUNDS == NUM_VOICES) {
+    return false;
+  }
+  int channel = voice_pick(sound, params);
+  if (channel == -1) {
+    return false;
+  }
+  if (Mix_Playing(channel)) {
+    Mix_HaltChannel(channel);
+  }
+  if (Mix_PlayChannel(channel, sound, 0) == -1) {
+    VOICES[channel].sound = NULL;
+    return false;
+  }
+  VOICES[channel] = (voice_t){
+      .sound = sound, .priority = params.priority, .started = ++VOICE_CLOCK};
+  FRAME_SOUNDS[NUM_FRAME_SOUNDS] = sound;
+  NUM_FRAME_SOUNDS++;
+  return true;
+}
+
+void voice_stop(Mix_Chunk *sound) {
+  for (int i = 0; i < NUM_VOICES; i++) {
+    if (VOICES[i].sound == sound) {
+      Mix_HaltChannel(i);
+      VOICES[i].sound = NULL;
+    }
+  }
+}
+
+void voice_end_frame(void) { NUM_FRAME_SOUNDS = 0; }